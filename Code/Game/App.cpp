@@ -89,9 +89,18 @@ void App::Startup()
     g_theAudio = new AudioSystem(audioConfig);
 
     ResourceSystemConfig resourceConfig;
-    g_theResourceSubsystem = new ResourceSubsystem(resourceConfig);
-
-    g_thePlayerSaveSubsystem = new PlayerSaveSubsystem();
+    resourceConfig.m_numAssetWorkers                   = g_gameConfigBlackboard.GetValue("assetWorkerThreads", resourceConfig.m_numAssetWorkers);
+    resourceConfig.m_voiceConfig.m_maxVoices         = g_gameConfigBlackboard.GetValue("audioMaxVoices", resourceConfig.m_voiceConfig.m_maxVoices);
+    resourceConfig.m_voiceConfig.m_maxVoicesPerSound = g_gameConfigBlackboard.GetValue("audioMaxVoicesPerSound", resourceConfig.m_voiceConfig.m_maxVoicesPerSound);
+    resourceConfig.m_voiceConfig.m_cullDistance      = g_gameConfigBlackboard.GetValue("audioCullDistance", resourceConfig.m_voiceConfig.m_cullDistance);
+    resourceConfig.m_soundReapSeconds                  = g_gameConfigBlackboard.GetValue("soundReapSeconds", resourceConfig.m_soundReapSeconds);
+    resourceConfig.m_bCheckPlaybackCache               = g_gameConfigBlackboard.GetValue("soundPlaybackCacheCheck", resourceConfig.m_bCheckPlaybackCache);
+    g_theResourceSubsystem                             = new ResourceSubsystem(resourceConfig);
+
+    PlayerSaveSystemConfig playerSaveConfig;
+    playerSaveConfig.m_logFilePath          = g_gameConfigBlackboard.GetValue("playerSaveFile", playerSaveConfig.m_logFilePath);
+    playerSaveConfig.m_flushIntervalSeconds = g_gameConfigBlackboard.GetValue("playerSaveFlushSeconds", playerSaveConfig.m_flushIntervalSeconds);
+    g_thePlayerSaveSubsystem                = new PlayerSaveSubsystem(playerSaveConfig);
 
     g_theEventSystem->Startup();
     g_theDevConsole->Startup();
@@ -102,9 +111,12 @@ void App::Startup()
     DebugRenderSystemStartup(debugRenderConfig);
     g_theAudio->Startup();
     g_theResourceSubsystem->Startup();
+    g_thePlayerSaveSubsystem->Startup();
 
+    g_rng     = new RandomNumberGenerator(); // Before the game, its constructor already spawns the map
     g_theGame = new Game();
-    g_rng     = new RandomNumberGenerator();
+    if (g_gameConfigBlackboard.GetValue("widgetRebuildCheck", false))
+        g_theGame->RunWidgetRebuildCheck();
 }
 
 void App::Shutdown()
@@ -126,6 +138,7 @@ void App::Shutdown()
     g_theInput->Shutdown();
     g_theEventSystem->Shutdown();
     g_theResourceSubsystem->Shutdown();
+    g_thePlayerSaveSubsystem->Shutdown();
     // Destroy all Engine Subsystem
     delete g_theAudio;
     g_theAudio = nullptr;
@@ -145,6 +158,9 @@ void App::Shutdown()
     delete g_theResourceSubsystem;
     g_theResourceSubsystem = nullptr;
 
+    delete g_thePlayerSaveSubsystem;
+    g_thePlayerSaveSubsystem = nullptr;
+
     delete g_theInput;
     g_theInput = nullptr;
 
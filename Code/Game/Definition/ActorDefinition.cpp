@@ -1,15 +1,28 @@
 ﻿#include "ActorDefinition.hpp"
 
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/ZCylinder.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 
 std::vector<ActorDefinition> ActorDefinition::s_definitions = {};
 
 void ActorDefinition::LoadDefinitions(const char* path)
 {
     printf("ActorDefinition::LoadDefinitions    %s", "Start Loading ActorDefinition\n");
+    double startTime = GetCurrentTimeSeconds();
+    if (LoadCookedDefinitions(path, "ActorDefinition", s_definitions))
+    {
+        DefinitionCache::RecordLoad(path, true, GetCurrentTimeSeconds() - startTime);
+        return;
+    }
+    size_t      firstDefinition = s_definitions.size();
     XmlDocument mapDefinitions;
     XmlResult   result = mapDefinitions.LoadFile(path);
     if (result == XmlResult::XML_SUCCESS)
@@ -25,6 +38,8 @@ void ActorDefinition::LoadDefinitions(const char* path)
                 s_definitions.push_back(mapDef);
                 element = element->NextSiblingElement();
             }
+            SaveCookedDefinitions(path, "ActorDefinition", s_definitions, firstDefinition);
+            DefinitionCache::RecordLoad(path, false, GetCurrentTimeSeconds() - startTime);
         }
         else
         {
@@ -39,10 +54,11 @@ void ActorDefinition::LoadDefinitions(const char* path)
 
 void ActorDefinition::ClearDefinitions()
 {
-    for (ActorDefinition definition : s_definitions)
+    for (ActorDefinition& definition : s_definitions)
     {
-        POINTER_SAFE_DELETE(definition.m_shader)
+        definition.ReleaseAssets();
     }
+    s_definitions.clear();
 }
 
 ActorDefinition* ActorDefinition::GetByName(const std::string& name)
@@ -108,21 +124,23 @@ ActorDefinition::ActorDefinition(const XmlElement& actorDefElement)
     if (visualsElement)
     {
         printf("                                    ‖ Loading Visuals Information\n");
-        m_cellCount     = ParseXmlAttribute(*visualsElement, "cellCount", m_cellCount);
-        m_size          = ParseXmlAttribute(*visualsElement, "size", m_size);
-        m_pivot         = ParseXmlAttribute(*visualsElement, "pivot", m_pivot);
-        m_billboardType = ParseXmlAttribute(*visualsElement, "billboardType", m_billboardType);
-        m_renderLit     = ParseXmlAttribute(*visualsElement, "renderLit", m_renderLit);
-        m_renderRounded = ParseXmlAttribute(*visualsElement, "renderRounded", m_renderRounded);
-        m_shader        = g_theRenderer->CreateShaderFromFile(ParseXmlAttribute(*visualsElement, "shader", m_name).c_str(), VertexType::Vertex_PCUTBN);
-        m_spriteSheet   = new SpriteSheet(*g_theRenderer->CreateOrGetTextureFromFile(ParseXmlAttribute(*visualsElement, "spriteSheet", m_name).c_str()), m_cellCount);
+        m_cellCount        = ParseXmlAttribute(*visualsElement, "cellCount", m_cellCount);
+        m_size             = ParseXmlAttribute(*visualsElement, "size", m_size);
+        m_pivot            = ParseXmlAttribute(*visualsElement, "pivot", m_pivot);
+        m_billboardType    = ParseXmlAttribute(*visualsElement, "billboardType", m_billboardType);
+        m_renderLit        = ParseXmlAttribute(*visualsElement, "renderLit", m_renderLit);
+        m_renderRounded    = ParseXmlAttribute(*visualsElement, "renderRounded", m_renderRounded);
+        m_shaderPath       = ParseXmlAttribute(*visualsElement, "shader", m_name);
+        m_spriteSheetPath  = ParseXmlAttribute(*visualsElement, "spriteSheet", m_name);
+        m_spriteSheetAsset = g_theResourceSubsystem->RequestTexture(m_spriteSheetPath);
+        m_shader           = g_theResourceSubsystem->AcquireShader(m_shaderPath, VertexType::Vertex_PCUTBN);
         if (visualsElement->ChildElementCount() > 0)
         {
             /// Handle Animation
             const XmlElement* element = visualsElement->FirstChildElement();
             while (element != nullptr)
             {
-                auto animation_group = AnimationGroup(*element, *m_spriteSheet);
+                auto animation_group = AnimationGroup(*element);
                 m_animationGroups.push_back(animation_group);
                 printf("                                 — Add AnimationGroup: %s\n", animation_group.m_name.c_str());
                 element = element->NextSiblingElement();
@@ -156,9 +174,257 @@ ActorDefinition::ActorDefinition(const XmlElement& actorDefElement)
             weapon = weapon->NextSiblingElement();
         }
     }
+    ResolveAnimationStates();
+    ResolveSoundCues();
     printf("ActorDefinition::ActorDefinition    — Create Definition \"%s\" \n", m_name.c_str());
 }
 
+ActorDefinition::ActorDefinition(ByteBufferReader& reader)
+{
+    /// Base
+    m_name           = reader.ReadString();
+    m_faction        = reader.ReadString();
+    m_health         = reader.Read<float>();
+    m_canBePossessed = reader.Read<bool>();
+    m_corpseLifetime = reader.Read<float>();
+    m_visible        = reader.Read<bool>();
+    m_dieOnSpawn     = reader.Read<bool>();
+    /// Collision
+    m_physicsRadius      = reader.Read<float>();
+    m_physicsHeight      = reader.Read<float>();
+    m_collidesWithWorld  = reader.Read<bool>();
+    m_collidesWithActors = reader.Read<bool>();
+    m_dieOnCollide       = reader.Read<bool>();
+    m_damageOnCollide    = ReadFloatRange(reader);
+    m_impulseOnCollied   = reader.Read<float>();
+    /// Physics
+    m_simulated = reader.Read<bool>();
+    m_flying    = reader.Read<bool>();
+    m_walkSpeed = reader.Read<float>();
+    m_runSpeed  = reader.Read<float>();
+    m_turnSpeed = reader.Read<float>();
+    m_drag      = reader.Read<float>();
+    /// Camera
+    m_eyeHeight = reader.Read<float>();
+    m_cameraFOV = reader.Read<float>();
+    /// AI
+    m_aiEnabled   = reader.Read<bool>();
+    m_sightRadius = reader.Read<float>();
+    m_sightAngle  = reader.Read<float>();
+    /// Visual
+    m_size            = ReadVec2(reader);
+    m_pivot           = ReadVec2(reader);
+    m_billboardType   = reader.ReadString();
+    m_renderLit       = reader.Read<bool>();
+    m_renderRounded   = reader.Read<bool>();
+    m_cellCount       = ReadIntVec2(reader);
+    m_shaderPath      = reader.ReadString();
+    m_spriteSheetPath = reader.ReadString();
+    if (!m_shaderPath.empty() && reader.IsValid())
+    {
+        m_spriteSheetAsset = g_theResourceSubsystem->RequestTexture(m_spriteSheetPath);
+        m_shader           = g_theResourceSubsystem->AcquireShader(m_shaderPath, VertexType::Vertex_PCUTBN);
+        unsigned int numAnimationGroups = reader.Read<unsigned int>();
+        for (unsigned int i = 0; i < numAnimationGroups && reader.IsValid(); i++)
+        {
+            m_animationGroups.push_back(AnimationGroup(reader));
+        }
+    }
+    /// Sounds
+    unsigned int numSounds = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numSounds && reader.IsValid(); i++)
+    {
+        m_sounds.push_back(Sound(reader));
+    }
+    /// Inventory
+    unsigned int numWeapons = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numWeapons && reader.IsValid(); i++)
+    {
+        m_inventory.push_back(reader.ReadString());
+    }
+    ResolveAnimationStates();
+    ResolveSoundCues();
+}
+
+void ActorDefinition::Cook(ByteBufferWriter& writer) const
+{
+    /// Base
+    writer.WriteString(m_name);
+    writer.WriteString(m_faction);
+    writer.Write(m_health);
+    writer.Write(m_canBePossessed);
+    writer.Write(m_corpseLifetime);
+    writer.Write(m_visible);
+    writer.Write(m_dieOnSpawn);
+    /// Collision
+    writer.Write(m_physicsRadius);
+    writer.Write(m_physicsHeight);
+    writer.Write(m_collidesWithWorld);
+    writer.Write(m_collidesWithActors);
+    writer.Write(m_dieOnCollide);
+    WriteFloatRange(writer, m_damageOnCollide);
+    writer.Write(m_impulseOnCollied);
+    /// Physics
+    writer.Write(m_simulated);
+    writer.Write(m_flying);
+    writer.Write(m_walkSpeed);
+    writer.Write(m_runSpeed);
+    writer.Write(m_turnSpeed);
+    writer.Write(m_drag);
+    /// Camera
+    writer.Write(m_eyeHeight);
+    writer.Write(m_cameraFOV);
+    /// AI
+    writer.Write(m_aiEnabled);
+    writer.Write(m_sightRadius);
+    writer.Write(m_sightAngle);
+    /// Visual
+    WriteVec2(writer, m_size);
+    WriteVec2(writer, m_pivot);
+    writer.WriteString(m_billboardType);
+    writer.Write(m_renderLit);
+    writer.Write(m_renderRounded);
+    WriteIntVec2(writer, m_cellCount);
+    writer.WriteString(m_shaderPath);
+    writer.WriteString(m_spriteSheetPath);
+    if (!m_shaderPath.empty())
+    {
+        writer.Write(static_cast<unsigned int>(m_animationGroups.size()));
+        for (const AnimationGroup& animationGroup : m_animationGroups)
+        {
+            animationGroup.Cook(writer);
+        }
+    }
+    /// Sounds
+    writer.Write(static_cast<unsigned int>(m_sounds.size()));
+    for (const Sound& sound : m_sounds)
+    {
+        sound.Cook(writer);
+    }
+    /// Inventory
+    writer.Write(static_cast<unsigned int>(m_inventory.size()));
+    for (const std::string& weaponName : m_inventory)
+    {
+        writer.WriteString(weaponName);
+    }
+}
+
+void ActorDefinition::ReloadDefinitions(const XmlElement& rootElement, const char* path)
+{
+    std::vector<ActorDefinition> reloaded;
+    const XmlElement*            element = rootElement.FirstChildElement();
+    while (element != nullptr)
+    {
+        reloaded.push_back(ActorDefinition(*element));
+        element = element->NextSiblingElement();
+    }
+    g_theResourceSubsystem->WaitForAssets();
+    int numReplaced = 0;
+    for (ActorDefinition& definition : reloaded)
+    {
+        definition.ResolveAssets();
+        ActorDefinition* existing = GetByName(definition.m_name);
+        if (existing)
+        {
+            existing->ReleaseAssets(); // The reloaded definition already acquired what both share.
+            *existing = definition;
+            numReplaced++;
+        }
+        else
+        {
+            s_definitions.push_back(definition);
+        }
+    }
+    printf("ActorDefinition::ReloadDefinitions    Reloaded \"%s\", %d replaced, %d added\n", path, numReplaced, static_cast<int>(reloaded.size()) - numReplaced);
+}
+
+void ActorDefinition::ResolveAllAssets()
+{
+    for (ActorDefinition& definition : s_definitions)
+    {
+        definition.ResolveAssets();
+    }
+}
+
+void ActorDefinition::ResolveAssets()
+{
+    if (m_visible && m_debugMeshBuffers[0] == nullptr && g_gameConfigBlackboard.GetValue("drawActorColliders", false))
+        BuildDebugMeshes(); // Only uploaded when the map draws actor colliders.
+    if (m_spriteSheet || !m_spriteSheetAsset.IsReady())
+        return;
+    m_spriteSheet = g_theResourceSubsystem->AcquireSpriteSheet(m_spriteSheetAsset, m_cellCount);
+    for (AnimationGroup& animationGroup : m_animationGroups)
+    {
+        animationGroup.CreateAnimations(*m_spriteSheet);
+    }
+}
+
+void ActorDefinition::ReleaseAssets()
+{
+    g_theResourceSubsystem->ReleaseShader(m_shader);
+    g_theResourceSubsystem->ReleaseSpriteSheet(m_spriteSheet);
+    g_theResourceSubsystem->ReleaseAsset(m_spriteSheetAsset);
+    m_shader           = nullptr;
+    m_spriteSheet      = nullptr;
+    m_spriteSheetAsset = AssetHandle();
+    m_animationGroups.clear();
+    m_animationStates.Clear();
+    for (int mesh = 0; mesh < static_cast<int>(ActorDebugMesh::COUNT); mesh++)
+    {
+        POINTER_SAFE_DELETE(m_debugMeshBuffers[mesh])
+        m_numDebugMeshVertexes[mesh] = 0;
+    }
+}
+
+void ActorDefinition::BuildDebugMeshes()
+{
+    if (m_physicsHeight <= 0.001f || m_physicsRadius <= 0.001f)
+        return;
+    /// The solid shapes are half as bright as their wireframe, the actor color and the death darkening come from the
+    /// model color at draw time
+    const Rgba8 solidColor = Rgba8::WHITE * 0.5f;
+    auto        cylinder   = ZCylinder(Vec3(0, 0, m_physicsHeight / 2.0f), m_physicsRadius, m_physicsHeight, true);
+    auto        coneStart  = Vec3(m_physicsRadius - 0.05f, 0, m_eyeHeight * 0.85f);
+    Vec3        coneEnd    = coneStart + Vec3(m_physicsRadius / 2.f, 0, 0);
+    float       coneRadius = m_physicsHeight / 5.0f;
+
+    std::vector<Vertex_PCU> vertexes;
+    for (int mesh = 0; mesh < static_cast<int>(ActorDebugMesh::COUNT); mesh++)
+    {
+        vertexes.clear();
+        switch (static_cast<ActorDebugMesh>(mesh))
+        {
+        case ActorDebugMesh::CYLINDER:
+            AddVertsForCylinderZ3D(vertexes, cylinder, solidColor, AABB2::ZERO_TO_ONE);
+            break;
+        case ActorDebugMesh::CYLINDER_WIREFRAME:
+            AddVertsForCylinderZ3D(vertexes, cylinder, Rgba8::WHITE, AABB2::ZERO_TO_ONE);
+            break;
+        case ActorDebugMesh::CONE:
+            AddVertsForCone3D(vertexes, coneEnd, coneStart, coneRadius, solidColor);
+            break;
+        case ActorDebugMesh::CONE_WIREFRAME:
+            AddVertsForCone3D(vertexes, coneEnd, coneStart, coneRadius, Rgba8::WHITE);
+            break;
+        default:
+            break;
+        }
+        m_numDebugMeshVertexes[mesh] = static_cast<int>(vertexes.size());
+        if (vertexes.empty())
+            continue;
+        m_debugMeshBuffers[mesh] = g_theRenderer->CreateVertexBuffer(vertexes.size() * sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+        g_theRenderer->CopyCPUToGPU(vertexes.data(), vertexes.size() * sizeof(Vertex_PCU), m_debugMeshBuffers[mesh]);
+    }
+}
+
+void ActorDefinition::DrawDebugMesh(ActorDebugMesh mesh) const
+{
+    int meshIndex = static_cast<int>(mesh);
+    if (m_numDebugMeshVertexes[meshIndex] == 0)
+        return;
+    g_theRenderer->DrawVertexBuffer(m_debugMeshBuffers[meshIndex], m_numDebugMeshVertexes[meshIndex]);
+}
+
 AnimationGroup* ActorDefinition::GetAnimationGroupByName(std::string& name)
 {
     for (AnimationGroup& animGroup : m_animationGroups)
@@ -169,12 +435,34 @@ AnimationGroup* ActorDefinition::GetAnimationGroupByName(std::string& name)
     return nullptr;
 }
 
-Sound* ActorDefinition::GetSoundByName(std::string name)
+AnimationGroup* ActorDefinition::GetAnimationGroup(int animationId)
+{
+    if (animationId < 0 || animationId >= static_cast<int>(m_animationGroups.size()))
+        return nullptr;
+    return &m_animationGroups[animationId];
+}
+
+void ActorDefinition::ResolveAnimationStates()
 {
-    for (Sound& sound : m_sounds)
+    m_animationStates.Clear();
+    for (int animationId = 0; animationId < static_cast<int>(m_animationGroups.size()); animationId++)
     {
-        if (sound.m_name == name)
-            return &sound;
+        const AnimationGroup& animationGroup = m_animationGroups[animationId];
+        m_animationStates.SetAnimation(GetAnimationStateByName(animationGroup.m_name), animationId, animationGroup.m_priority);
     }
-    return nullptr;
+}
+
+void ActorDefinition::ResolveSoundCues()
+{
+    m_soundCues.Resolve(m_sounds, m_name);
+    if (m_canBePossessed)
+    {
+        m_soundCues.ReportIfMissing(SoundCue::HURT, m_name);
+        m_soundCues.ReportIfMissing(SoundCue::DEATH, m_name);
+    }
+}
+
+SoundID ActorDefinition::GetSoundCue(SoundCue cue) const
+{
+    return m_soundCues.GetSoundID(cue);
 }
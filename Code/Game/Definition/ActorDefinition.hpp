@@ -8,22 +8,52 @@
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 #include "Game/Framework/AnimationGroup.hpp"
+#include "Game/Framework/AnimationState.hpp"
+#include "Game/Framework/AssetLoader.hpp"
 #include "Game/Framework/Sound.hpp"
+#include "Game/Framework/SoundCue.hpp"
 
 class SpriteSheet;
 class Shader;
+class VertexBuffer;
+class ByteBufferWriter;
+class ByteBufferReader;
+
+/// Debug shapes of the collision volume, shared by every actor of a definition.
+enum class ActorDebugMesh : unsigned char
+{
+    CYLINDER,
+    CYLINDER_WIREFRAME,
+    CONE, // Facing cone at the eyes, skipped for projectiles.
+    CONE_WIREFRAME,
+    COUNT,
+};
 
 class ActorDefinition
 {
 public:
     static std::vector<ActorDefinition> s_definitions;
     static void                         LoadDefinitions(const char* path);
-    static void                         ClearDefinitions();
+    static void                         ClearDefinitions(); // Release the shared resources of every definition and forget them.
     static ActorDefinition*             GetByName(const std::string& name);
+    static void                         ResolveAllAssets();
+    /// Hot reload, replace the definitions of the same name in place and append the new ones. Definitions missing from
+    /// the file are kept since live actors may still use them.
+    static void                         ReloadDefinitions(const XmlElement& rootElement, const char* path);
 
     ActorDefinition(const XmlElement& actorDefElement);
+    explicit ActorDefinition(ByteBufferReader& reader);
+    void            Cook(ByteBufferWriter& writer) const;
+    void            ResolveAssets(); // Build the sprite sheet and animations once the sprite sheet texture is ready.
+    void            ReleaseAssets();
     AnimationGroup* GetAnimationGroupByName(std::string& name);
-    Sound*          GetSoundByName(std::string name);
+    AnimationGroup* GetAnimationGroup(int animationId); // Null for ANIMATION_ID_NONE.
+    SoundID         GetSoundCue(SoundCue cue) const; // MISSING_SOUND_ID if the definition has no sound for the cue.
+    void            ResolveAnimationStates(); // Look up the animation group of every state by its name, once per load.
+    void            ResolveSoundCues(); // Look up the sound of every cue by its name, once per load.
+    void            BuildDebugMeshes(); // Upload the collision debug shapes once, in white so every actor can tint them.
+    /// Draw a debug mesh with the model constants already bound, the actor tints it through the model color.
+    void            DrawDebugMesh(ActorDebugMesh mesh) const;
 
     /// Base
     std::string m_name           = "Default";
@@ -58,15 +88,22 @@ public:
     /// Visual
     Vec2                        m_size;
     Vec2                        m_pivot;
-    std::string                 m_billboardType = "None";
-    bool                        m_renderLit     = false;
-    bool                        m_renderRounded = false;
-    Shader*                     m_shader        = nullptr;
-    SpriteSheet*                m_spriteSheet   = nullptr;
-    IntVec2                     m_cellCount     = IntVec2(8, 9);
+    std::string                 m_billboardType   = "None";
+    bool                        m_renderLit       = false;
+    bool                        m_renderRounded   = false;
+    std::string                 m_shaderPath      = ""; // Empty when the definition has no visuals.
+    std::string                 m_spriteSheetPath = "";
+    Shader*                     m_shader          = nullptr;
+    AssetHandle                 m_spriteSheetAsset;
+    SpriteSheet*                m_spriteSheet     = nullptr;
+    IntVec2                     m_cellCount       = IntVec2(8, 9);
     std::vector<AnimationGroup> m_animationGroups;
-    std::vector<Sound>          m_sounds;
+    AnimationStateMachine       m_animationStates; // Animation group of every state, resolved by name at load.
+    VertexBuffer*               m_debugMeshBuffers[static_cast<int>(ActorDebugMesh::COUNT)]     = {};
+    int                         m_numDebugMeshVertexes[static_cast<int>(ActorDebugMesh::COUNT)] = {};
     /// Sounds
+    std::vector<Sound> m_sounds;
+    SoundCueTable      m_soundCues; // Sound of every cue, resolved by name at load.
 
     /// Inventory
     std::vector<std::string> m_inventory = {};
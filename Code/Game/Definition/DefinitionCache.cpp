@@ -0,0 +1,118 @@
+﻿#include "DefinitionCache.hpp"
+
+#include <filesystem>
+
+bool   DefinitionCache::s_bEnabled       = true;
+int    DefinitionCache::s_numCookedLoads = 0;
+int    DefinitionCache::s_numXmlLoads    = 0;
+double DefinitionCache::s_loadSeconds    = 0.0;
+
+bool DefinitionCache::LoadCooked(const char* sourcePath, const char* kind, std::vector<unsigned char>& outBuffer, size_t& outBodyOffset)
+{
+    if (!s_bEnabled || !ReadBinaryFileToBuffer(outBuffer, GetCookedPath(sourcePath)))
+        return false;
+    ByteBufferReader   reader(outBuffer);
+    unsigned int       magic      = reader.Read<unsigned int>();
+    unsigned int       version    = reader.Read<unsigned int>();
+    std::string        cookedKind = reader.ReadString();
+    unsigned long long cookedSize = reader.Read<unsigned long long>();
+    long long          cookedTime = reader.Read<long long>();
+    unsigned long long cookedHash = reader.Read<unsigned long long>();
+    if (!reader.IsValid() || magic != DEFINITION_CACHE_MAGIC || version != DEFINITION_CACHE_VERSION || cookedKind != kind)
+    {
+        printf("DefinitionCache::LoadCooked    Cooked file of \"%s\" has another format or version, falling back to XML\n", sourcePath);
+        return false;
+    }
+    unsigned long long sourceSize = 0;
+    long long          sourceTime = 0;
+    if (!GetSourceFileStamp(sourcePath, sourceSize, sourceTime))
+    {
+        printf("DefinitionCache::LoadCooked    Source \"%s\" is missing, using its cooked file\n", sourcePath);
+    }
+    else if (sourceSize != cookedSize)
+    {
+        printf("DefinitionCache::LoadCooked    Source \"%s\" changed, falling back to XML\n", sourcePath);
+        return false;
+    }
+    else if (sourceTime != cookedTime)
+    {
+        std::vector<unsigned char> source;
+        if (!ReadBinaryFileToBuffer(source, sourcePath) || HashBytes(source.data(), source.size()) != cookedHash)
+        {
+            printf("DefinitionCache::LoadCooked    Source \"%s\" is newer than its cooked file, falling back to XML\n", sourcePath);
+            return false;
+        }
+    }
+    outBodyOffset = reader.GetOffset();
+    return true;
+}
+
+bool DefinitionCache::SaveCooked(const char* sourcePath, const char* kind, const ByteBufferWriter& body)
+{
+    if (!s_bEnabled)
+        return false;
+    std::vector<unsigned char> source;
+    unsigned long long         sourceSize = 0;
+    long long                  sourceTime = 0;
+    if (!GetSourceFileStamp(sourcePath, sourceSize, sourceTime) || !ReadBinaryFileToBuffer(source, sourcePath))
+        return false;
+    ByteBufferWriter writer;
+    writer.Write(DEFINITION_CACHE_MAGIC);
+    writer.Write(DEFINITION_CACHE_VERSION);
+    writer.WriteString(kind);
+    writer.Write(sourceSize);
+    writer.Write(sourceTime);
+    writer.Write(HashBytes(source.data(), source.size()));
+    writer.WriteBytes(body.GetBuffer().data(), body.GetSize());
+    std::string cookedPath = GetCookedPath(sourcePath);
+    if (!WriteBufferToBinaryFile(writer.GetBuffer(), cookedPath))
+    {
+        printf("DefinitionCache::SaveCooked    Failed to write \"%s\"\n", cookedPath.c_str());
+        return false;
+    }
+    printf("DefinitionCache::SaveCooked    Cooked %d bytes to \"%s\"\n", static_cast<int>(writer.GetSize()), cookedPath.c_str());
+    return true;
+}
+
+std::string DefinitionCache::GetCookedPath(const char* sourcePath)
+{
+    return std::string(sourcePath) + ".cooked";
+}
+
+bool DefinitionCache::GetSourceFileStamp(const char* sourcePath, unsigned long long& outSize, long long& outWriteTime)
+{
+    std::error_code error;
+    outSize = static_cast<unsigned long long>(std::filesystem::file_size(sourcePath, error));
+    if (error)
+        return false;
+    outWriteTime = static_cast<long long>(std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count());
+    return !error;
+}
+
+unsigned long long DefinitionCache::HashBytes(const unsigned char* data, size_t size)
+{
+    unsigned long long hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void DefinitionCache::ResetStatistics()
+{
+    s_numCookedLoads = 0;
+    s_numXmlLoads    = 0;
+    s_loadSeconds    = 0.0;
+}
+
+void DefinitionCache::RecordLoad(const char* sourcePath, bool bFromCooked, double seconds)
+{
+    if (bFromCooked)
+        s_numCookedLoads++;
+    else
+        s_numXmlLoads++;
+    s_loadSeconds += seconds;
+    printf("DefinitionCache::RecordLoad    Loaded \"%s\" from %s in %.3f ms\n", sourcePath, bFromCooked ? "cooked file" : "XML", seconds * 1000.0);
+}
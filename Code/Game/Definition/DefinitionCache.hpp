@@ -0,0 +1,75 @@
+﻿#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Game/Framework/ByteBuffer.hpp"
+
+/// Cooked binary copy of a definition XML file, written next to it as "<file>.cooked" the first time the XML is parsed
+/// so the following startups skip the XML parse. Layout: magic, version, definition kind, source size, source write
+/// time, FNV-1a hash of the source bytes, then the definition count and every definition written by its Cook method.
+/// A cooked file is only used when its version and kind match and the source is unchanged, either by size and write
+/// time or, when the source was only touched, by content hash. Anything else falls back to the XML and re-cooks it.
+static constexpr unsigned int DEFINITION_CACHE_MAGIC   = 0x4B4F4344u; // "DCOK"
+static constexpr unsigned int DEFINITION_CACHE_VERSION = 3; // Bump whenever a Cook method or a cooked constructor changes.
+
+class DefinitionCache
+{
+public:
+    /// Read the cooked file of the source with a single read and validate its header against the source. On success
+    /// outBuffer holds the whole file and outBodyOffset points at the definition count.
+    static bool LoadCooked(const char* sourcePath, const char* kind, std::vector<unsigned char>& outBuffer, size_t& outBodyOffset);
+    /// Write the cooked definitions of the source, a failure only costs the next startup an XML parse.
+    static bool               SaveCooked(const char* sourcePath, const char* kind, const ByteBufferWriter& body);
+    static std::string        GetCookedPath(const char* sourcePath);
+    static unsigned long long HashBytes(const unsigned char* data, size_t size); // 64 bit FNV-1a.
+    static bool               GetSourceFileStamp(const char* sourcePath, unsigned long long& outSize, long long& outWriteTime); // False if missing.
+
+    /// Startup statistics
+    static void ResetStatistics();
+    static void RecordLoad(const char* sourcePath, bool bFromCooked, double seconds);
+
+    static bool   s_bEnabled; // Read and write cooked files, false always parses the XML.
+    static int    s_numCookedLoads;
+    static int    s_numXmlLoads;
+    static double s_loadSeconds;
+};
+
+/// Append the definitions cooked in the source file to definitions, return false and leave definitions untouched if
+/// there is no valid cooked file. T needs an explicit constructor from a ByteBufferReader.
+template <typename T>
+bool LoadCookedDefinitions(const char* sourcePath, const char* kind, std::vector<T>& definitions)
+{
+    std::vector<unsigned char> buffer;
+    size_t                     bodyOffset = 0;
+    if (!DefinitionCache::LoadCooked(sourcePath, kind, buffer, bodyOffset))
+        return false;
+    ByteBufferReader reader(buffer.data() + bodyOffset, buffer.size() - bodyOffset);
+    size_t           firstDefinition = definitions.size();
+    unsigned int     numDefinitions  = reader.Read<unsigned int>();
+    definitions.reserve(firstDefinition + std::min(static_cast<size_t>(numDefinitions), reader.GetRemainingSize()));
+    for (unsigned int i = 0; i < numDefinitions && reader.IsValid(); i++)
+    {
+        definitions.emplace_back(reader);
+    }
+    if (!reader.IsValid() || !reader.IsAtEnd())
+    {
+        printf("DefinitionCache::LoadCookedDefinitions    Cooked file of \"%s\" is corrupted, falling back to XML\n", sourcePath);
+        definitions.erase(definitions.begin() + firstDefinition, definitions.end());
+        return false;
+    }
+    return true;
+}
+
+/// Cook the definitions from firstDefinition to the end, which are the ones the source file just added.
+template <typename T>
+void SaveCookedDefinitions(const char* sourcePath, const char* kind, const std::vector<T>& definitions, size_t firstDefinition)
+{
+    ByteBufferWriter writer;
+    writer.Write(static_cast<unsigned int>(definitions.size() - firstDefinition));
+    for (size_t i = firstDefinition; i < definitions.size(); i++)
+    {
+        definitions[i].Cook(writer);
+    }
+    DefinitionCache::SaveCooked(sourcePath, kind, writer);
+}
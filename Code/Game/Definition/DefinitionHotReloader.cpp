@@ -0,0 +1,118 @@
+﻿#include "DefinitionHotReloader.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+
+/// Write time of the file, 0 if it can not be read right now.
+static long long GetDefinitionFileWriteTime(const std::string& path)
+{
+    std::error_code error;
+    long long       writeTime = static_cast<long long>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    return error ? 0 : writeTime;
+}
+
+void DefinitionHotReloader::WatchFile(const std::string& path, DefinitionReloadFunction reload)
+{
+    WatchedDefinitionFile file;
+    file.m_path      = path;
+    file.m_reload    = reload;
+    file.m_writeTime = GetDefinitionFileWriteTime(path);
+    m_files.push_back(file);
+}
+
+void DefinitionHotReloader::Startup(float pollIntervalSeconds)
+{
+    m_pollIntervalSeconds = pollIntervalSeconds;
+    m_bIsStopping         = false;
+    m_watchThread         = std::thread(&DefinitionHotReloader::WatchThreadMain, this);
+    printf("DefinitionHotReloader::Startup    Watching %d definition files every %.2f seconds\n", static_cast<int>(m_files.size()), m_pollIntervalSeconds);
+}
+
+void DefinitionHotReloader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bIsStopping = true;
+    }
+    m_condition.notify_all();
+    if (m_watchThread.joinable())
+        m_watchThread.join();
+    for (ParsedDefinitionFile& parsedFile : m_parsedFiles)
+    {
+        POINTER_SAFE_DELETE(parsedFile.m_document)
+    }
+    m_parsedFiles.clear();
+}
+
+bool DefinitionHotReloader::HasPendingReloads()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_parsedFiles.empty();
+}
+
+int DefinitionHotReloader::ApplyPendingReloads()
+{
+    std::vector<ParsedDefinitionFile> parsedFiles;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        parsedFiles.swap(m_parsedFiles);
+    }
+    for (ParsedDefinitionFile& parsedFile : parsedFiles)
+    {
+        const WatchedDefinitionFile& file      = m_files[parsedFile.m_fileIndex];
+        double                       startTime = GetCurrentTimeSeconds();
+        file.m_reload(*parsedFile.m_document->RootElement(), file.m_path.c_str());
+        printf("DefinitionHotReloader::ApplyPendingReloads    Reloaded \"%s\", parsed in %.3f ms on the watch thread, swapped in %.3f ms\n", file.m_path.c_str(),
+               parsedFile.m_parseSeconds * 1000.0, (GetCurrentTimeSeconds() - startTime) * 1000.0);
+        POINTER_SAFE_DELETE(parsedFile.m_document)
+    }
+    return static_cast<int>(parsedFiles.size());
+}
+
+void DefinitionHotReloader::WatchThreadMain()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, std::chrono::duration<float>(m_pollIntervalSeconds), [this]() { return m_bIsStopping; });
+            if (m_bIsStopping)
+                return;
+        }
+
+        for (int fileIndex = 0; fileIndex < static_cast<int>(m_files.size()); fileIndex++)
+        {
+            WatchedDefinitionFile& file      = m_files[fileIndex];
+            long long              writeTime = GetDefinitionFileWriteTime(file.m_path);
+            if (writeTime == 0)
+                continue;
+            if (writeTime != file.m_writeTime)
+            {
+                file.m_writeTime = writeTime;
+                file.m_bChanged  = true;
+                continue;
+            }
+            if (!file.m_bChanged)
+                continue;
+            file.m_bChanged = false;
+
+            double       startTime = GetCurrentTimeSeconds();
+            XmlDocument* document  = new XmlDocument();
+            if (document->LoadFile(file.m_path.c_str()) != XmlResult::XML_SUCCESS || !document->RootElement())
+            {
+                printf("DefinitionHotReloader::WatchThreadMain    \"%s\" is not valid XML, keeping the loaded definitions\n", file.m_path.c_str());
+                delete document;
+                continue;
+            }
+            ParsedDefinitionFile parsedFile;
+            parsedFile.m_fileIndex    = fileIndex;
+            parsedFile.m_document     = document;
+            parsedFile.m_parseSeconds = GetCurrentTimeSeconds() - startTime;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_parsedFiles.push_back(parsedFile);
+        }
+    }
+}
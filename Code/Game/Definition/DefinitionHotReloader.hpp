@@ -0,0 +1,55 @@
+﻿#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Engine/Core/XmlUtils.hpp"
+
+/// Swap the definitions of a parsed file into a registry, main thread only.
+typedef void (*DefinitionReloadFunction)(const XmlElement& rootElement, const char* path);
+
+struct WatchedDefinitionFile
+{
+    std::string              m_path;
+    DefinitionReloadFunction m_reload    = nullptr;
+    long long                m_writeTime = 0; // Watch thread only once started.
+    bool                     m_bChanged  = false; // Watch thread only, a change waits one poll for the write to settle.
+};
+
+struct ParsedDefinitionFile
+{
+    int          m_fileIndex    = -1;
+    XmlDocument* m_document     = nullptr;
+    double       m_parseSeconds = 0.0;
+};
+
+/// Hot reload of definition files. A watch thread polls the write time of every watched file and parses the changed
+/// ones into a document off the main thread. The main thread swaps the parsed files in at a frame boundary through
+/// the reload function of their registry, which replaces definitions by name and keeps the ones the file no longer
+/// lists, so every live pointer can be re-pointed by name afterwards.
+class DefinitionHotReloader
+{
+public:
+    void WatchFile(const std::string& path, DefinitionReloadFunction reload); // Before Startup.
+    void Startup(float pollIntervalSeconds);
+    void Shutdown();
+
+    bool HasPendingReloads();
+    int  ApplyPendingReloads(); // Return the number of files swapped in.
+
+private:
+    void WatchThreadMain();
+
+    std::vector<WatchedDefinitionFile> m_files;
+    float                              m_pollIntervalSeconds = 0.5f;
+
+    /// Shared with the watch thread, guarded by m_mutex
+    std::mutex                        m_mutex;
+    std::condition_variable           m_condition;
+    std::vector<ParsedDefinitionFile> m_parsedFiles;
+    bool                              m_bIsStopping = false;
+
+    std::thread m_watchThread;
+};
@@ -1,9 +1,13 @@
 ﻿#include "MapDefinition.hpp"
 
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 
 /// Definitions
 std::vector<MapDefinition> MapDefinition::s_definitions = {};
@@ -12,6 +16,13 @@ std::vector<MapDefinition> MapDefinition::s_definitions = {};
 void MapDefinition::LoadDefinitions(const char* path)
 {
     printf("MapDefinition::LoadDefinitions    %s", "Start Loading MapDefinitions\n");
+    double startTime = GetCurrentTimeSeconds();
+    if (LoadCookedDefinitions(path, "MapDefinition", s_definitions))
+    {
+        DefinitionCache::RecordLoad(path, true, GetCurrentTimeSeconds() - startTime);
+        return;
+    }
+    size_t      firstDefinition = s_definitions.size();
     XmlDocument mapDefinitions;
     XmlResult   result = mapDefinitions.LoadFile(path);
     if (result == XmlResult::XML_SUCCESS)
@@ -27,6 +38,8 @@ void MapDefinition::LoadDefinitions(const char* path)
                 s_definitions.push_back(mapDef);
                 element = element->NextSiblingElement();
             }
+            SaveCookedDefinitions(path, "MapDefinition", s_definitions, firstDefinition);
+            DefinitionCache::RecordLoad(path, false, GetCurrentTimeSeconds() - startTime);
         }
         else
         {
@@ -43,8 +56,7 @@ void MapDefinition::ClearDefinitions()
 {
     for (MapDefinition& definition : s_definitions)
     {
-        delete definition.m_shader;
-        definition.m_shader = nullptr;
+        definition.ReleaseAssets();
     }
     s_definitions.clear();
 }
@@ -61,13 +73,24 @@ const MapDefinition* MapDefinition::GetByName(const std::string& name)
     return nullptr;
 }
 
+void MapDefinition::ResolveAllAssets()
+{
+    for (MapDefinition& definition : s_definitions)
+    {
+        definition.ResolveAssets();
+    }
+}
+
 MapDefinition::MapDefinition(const XmlElement& mapDefElement)
 {
     m_name                 = ParseXmlAttribute(mapDefElement, "name", m_name);
-    m_mapImage             = g_theRenderer->CreateImageFromFile(ParseXmlAttribute(mapDefElement, "image", m_name).c_str());
+    m_imagePath            = ParseXmlAttribute(mapDefElement, "image", m_name);
     m_spriteSheetCellCount = ParseXmlAttribute(mapDefElement, "spriteSheetCellCount", m_spriteSheetCellCount);
-    m_spriteSheet          = new SpriteSheet(*g_theRenderer->CreateOrGetTextureFromFile(ParseXmlAttribute(mapDefElement, "spriteSheetTexture", m_name).c_str()), m_spriteSheetCellCount);
-    m_shader               = g_theRenderer->CreateShaderFromFile(ParseXmlAttribute(mapDefElement, "shader", m_name).c_str(), VertexType::Vertex_PCUTBN);
+    m_spriteSheetPath      = ParseXmlAttribute(mapDefElement, "spriteSheetTexture", m_name);
+    m_shaderPath           = ParseXmlAttribute(mapDefElement, "shader", m_name);
+    m_generatedDimensions  = ParseXmlAttribute(mapDefElement, "generatedDimensions", m_generatedDimensions);
+    m_bIsStreamed          = ParseXmlAttribute(mapDefElement, "streamed", IsGenerated()); // A generated map is too large to be resident.
+    RequestAssets();
 
     const XmlElement* spawnInfosElement = FindChildElementByName(mapDefElement, "SpawnInfos");
     if (spawnInfosElement)
@@ -88,5 +111,92 @@ MapDefinition::MapDefinition(const XmlElement& mapDefElement)
 
     printf("MapDefinition::MapDefinition    — Create Definition \"%s\" \n", m_name.c_str());
     printf("                                ‖ Map SpriteSheet Dimension: %d x %d \n", m_spriteSheetCellCount.x, m_spriteSheetCellCount.y);
-    printf("                                ‖ Map Dimension: %d x %d \n", m_mapImage->GetDimensions().x, m_mapImage->GetDimensions().y);
+}
+
+MapDefinition::MapDefinition(ByteBufferReader& reader)
+{
+    m_name                 = reader.ReadString();
+    m_imagePath            = reader.ReadString();
+    m_spriteSheetCellCount = ReadIntVec2(reader);
+    m_spriteSheetPath      = reader.ReadString();
+    m_shaderPath           = reader.ReadString();
+    m_generatedDimensions  = ReadIntVec2(reader);
+    m_bIsStreamed          = reader.Read<bool>();
+    unsigned int numSpawns = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numSpawns && reader.IsValid(); i++)
+    {
+        SpawnInfo spawnInfo;
+        spawnInfo.m_actorName   = reader.ReadString();
+        spawnInfo.m_faction     = reader.ReadString();
+        spawnInfo.m_position    = ReadVec3(reader);
+        spawnInfo.m_orientation = ReadVec3(reader);
+        spawnInfo.m_velocity    = ReadVec3(reader);
+        m_spawnInfos.push_back(spawnInfo);
+    }
+    if (reader.IsValid())
+    {
+        RequestAssets();
+    }
+}
+
+void MapDefinition::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_name);
+    writer.WriteString(m_imagePath);
+    WriteIntVec2(writer, m_spriteSheetCellCount);
+    writer.WriteString(m_spriteSheetPath);
+    writer.WriteString(m_shaderPath);
+    WriteIntVec2(writer, m_generatedDimensions);
+    writer.Write(m_bIsStreamed);
+    writer.Write(static_cast<unsigned int>(m_spawnInfos.size()));
+    for (const SpawnInfo& spawnInfo : m_spawnInfos)
+    {
+        writer.WriteString(spawnInfo.m_actorName);
+        writer.WriteString(spawnInfo.m_faction);
+        WriteVec3(writer, spawnInfo.m_position);
+        WriteVec3(writer, spawnInfo.m_orientation);
+        WriteVec3(writer, spawnInfo.m_velocity);
+    }
+}
+
+void MapDefinition::ResolveAssets()
+{
+    if (m_spriteSheet || (!IsGenerated() && !m_mapImageAsset.IsReady()) || !m_spriteSheetAsset.IsReady())
+        return;
+    m_mapImage    = m_mapImageAsset.GetImage();
+    m_spriteSheet = g_theResourceSubsystem->AcquireSpriteSheet(m_spriteSheetAsset, m_spriteSheetCellCount);
+    printf("MapDefinition::ResolveAssets    Map \"%s\" Dimension: %d x %d%s\n", m_name.c_str(), GetDimensions().x, GetDimensions().y, m_bIsStreamed ? " (streamed)" : "");
+}
+
+IntVec2 MapDefinition::GetDimensions() const
+{
+    if (IsGenerated())
+        return m_generatedDimensions;
+    return m_mapImage ? m_mapImage->GetDimensions() : IntVec2::ZERO;
+}
+
+bool MapDefinition::IsGenerated() const
+{
+    return m_generatedDimensions != IntVec2::ZERO;
+}
+
+void MapDefinition::RequestAssets()
+{
+    if (!IsGenerated())
+        m_mapImageAsset = g_theResourceSubsystem->RequestImage(m_imagePath);
+    m_spriteSheetAsset = g_theResourceSubsystem->RequestTexture(m_spriteSheetPath);
+    m_shader           = g_theResourceSubsystem->AcquireShader(m_shaderPath, VertexType::Vertex_PCUTBN);
+}
+
+void MapDefinition::ReleaseAssets()
+{
+    g_theResourceSubsystem->ReleaseShader(m_shader);
+    g_theResourceSubsystem->ReleaseSpriteSheet(m_spriteSheet);
+    g_theResourceSubsystem->ReleaseAsset(m_spriteSheetAsset);
+    g_theResourceSubsystem->ReleaseAsset(m_mapImageAsset);
+    m_shader           = nullptr;
+    m_spriteSheet      = nullptr;
+    m_mapImage         = nullptr;
+    m_spriteSheetAsset = AssetHandle();
+    m_mapImageAsset    = AssetHandle();
 }
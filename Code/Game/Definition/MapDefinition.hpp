@@ -6,11 +6,14 @@
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/Vec3.hpp"
+#include "Game/Framework/AssetLoader.hpp"
 
 class Texture;
 class Shader;
 class SpriteSheet;
 class Image;
+class ByteBufferWriter;
+class ByteBufferReader;
 
 /// Map definitions have a new SpawnInfo child element.When a map is created,
 /// it spawns actors at for each spawn info. This class, in addition to being
@@ -39,13 +42,30 @@ public:
     static void                       LoadDefinitions(const char* path);
     static void                       ClearDefinitions();
     static const MapDefinition*       GetByName(const std::string& name);
+    static void                       ResolveAllAssets();
 
     MapDefinition(const XmlElement& mapDefElement);
+    explicit MapDefinition(ByteBufferReader& reader);
+    void Cook(ByteBufferWriter& writer) const;
+    void ResolveAssets(); // Pick the map image and build the sprite sheet once both are loaded.
+    void ReleaseAssets();
+    IntVec2 GetDimensions() const; // Size of the generated map, or of the map image once it is resolved.
+    bool    IsGenerated() const;
 
     std::string            m_name                 = "Default";
+    std::string            m_imagePath            = "";
+    std::string            m_spriteSheetPath      = "";
+    std::string            m_shaderPath           = "";
+    AssetHandle            m_mapImageAsset;
+    AssetHandle            m_spriteSheetAsset;
     Image*                 m_mapImage             = nullptr;
     SpriteSheet*           m_spriteSheet          = nullptr;
     Shader*                m_shader               = nullptr;
     IntVec2                m_spriteSheetCellCount = IntVec2::ZERO;
+    IntVec2                m_generatedDimensions  = IntVec2::ZERO; // Non zero generates the tiles instead of reading an image.
+    bool                   m_bIsStreamed          = false; // Load tiles and geometry in regions around the players.
     std::vector<SpawnInfo> m_spawnInfos;
+
+private:
+    void RequestAssets(); // Queue the map image and sprite sheet texture and create the shader from the parsed paths.
 };
@@ -1,5 +1,9 @@
 ﻿#include "TileDefinition.hpp"
 
+#include "Engine/Core/Time.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+
 /// Definitions
 std::vector<TileDefinition> TileDefinition::s_definitions = {};
 /// 
@@ -7,6 +11,13 @@ std::vector<TileDefinition> TileDefinition::s_definitions = {};
 void TileDefinition::LoadDefinitions(const char* path)
 {
     printf("TileDefinition::LoadDefinitions    %s", "Start Loading TileDefinition\n");
+    double startTime = GetCurrentTimeSeconds();
+    if (LoadCookedDefinitions(path, "TileDefinition", s_definitions))
+    {
+        DefinitionCache::RecordLoad(path, true, GetCurrentTimeSeconds() - startTime);
+        return;
+    }
+    size_t      firstDefinition = s_definitions.size();
     XmlDocument mapDefinitions;
     XmlResult   result = mapDefinitions.LoadFile(path);
     if (result == XmlResult::XML_SUCCESS)
@@ -22,6 +33,8 @@ void TileDefinition::LoadDefinitions(const char* path)
                 s_definitions.push_back(tileDef);
                 element = element->NextSiblingElement();
             }
+            SaveCookedDefinitions(path, "TileDefinition", s_definitions, firstDefinition);
+            DefinitionCache::RecordLoad(path, false, GetCurrentTimeSeconds() - startTime);
         }
         else
         {
@@ -73,3 +86,23 @@ TileDefinition::TileDefinition(const XmlElement& tileDefElement)
     m_wallSpriteCoords    = ParseXmlAttribute(tileDefElement, "wallSpriteCoords", m_wallSpriteCoords);
     printf("TileDefinition::MapDefinition    — Create Definition \"%s\" \n", m_name.c_str());
 }
+
+TileDefinition::TileDefinition(ByteBufferReader& reader)
+{
+    m_name                = reader.ReadString();
+    m_isSolid             = reader.Read<bool>();
+    m_mapImagePixelColor  = ReadRgba8(reader);
+    m_floorSpriteCoords   = ReadIntVec2(reader);
+    m_ceilingSpriteCoords = ReadIntVec2(reader);
+    m_wallSpriteCoords    = ReadIntVec2(reader);
+}
+
+void TileDefinition::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_name);
+    writer.Write(m_isSolid);
+    WriteRgba8(writer, m_mapImagePixelColor);
+    WriteIntVec2(writer, m_floorSpriteCoords);
+    WriteIntVec2(writer, m_ceilingSpriteCoords);
+    WriteIntVec2(writer, m_wallSpriteCoords);
+}
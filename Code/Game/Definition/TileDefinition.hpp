@@ -7,6 +7,9 @@
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 
+class ByteBufferWriter;
+class ByteBufferReader;
+
 class TileDefinition
 {
     friend class Map;
@@ -19,6 +22,8 @@ public:
     static TileDefinition*             GetByTexelColor(const Rgba8& color);
 
     TileDefinition(const XmlElement& tileDefElement);
+    explicit TileDefinition(ByteBufferReader& reader);
+    void Cook(ByteBufferWriter& writer) const;
 
     std::string m_name    = "Unknown";
     bool        m_isSolid = false;
@@ -1,9 +1,24 @@
 ﻿#include "WeaponDefinition.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
+#include "Game/GameCommon.hpp"
+
 std::vector<WeaponDefinition> WeaponDefinition::s_definitions = {};
 
 void WeaponDefinition::LoadDefinitions(const char* path)
 {
     printf("MapDefinition::LoadDefinitions    %s", "Start Loading WeaponDefinition\n");
+    double startTime = GetCurrentTimeSeconds();
+    if (LoadCookedDefinitions(path, "WeaponDefinition", s_definitions))
+    {
+        DefinitionCache::RecordLoad(path, true, GetCurrentTimeSeconds() - startTime);
+        return;
+    }
+    size_t      firstDefinition = s_definitions.size();
     XmlDocument mapDefinitions;
     XmlResult   result = mapDefinitions.LoadFile(path);
     if (result == XmlResult::XML_SUCCESS)
@@ -19,6 +34,8 @@ void WeaponDefinition::LoadDefinitions(const char* path)
                 s_definitions.push_back(mapDef);
                 element = element->NextSiblingElement();
             }
+            SaveCookedDefinitions(path, "WeaponDefinition", s_definitions, firstDefinition);
+            DefinitionCache::RecordLoad(path, false, GetCurrentTimeSeconds() - startTime);
         }
         else
         {
@@ -33,6 +50,12 @@ void WeaponDefinition::LoadDefinitions(const char* path)
 
 void WeaponDefinition::ClearDefinitions()
 {
+    for (WeaponDefinition& definition : s_definitions)
+    {
+        if (definition.m_hud)
+            definition.m_hud->ReleaseAssets();
+        POINTER_SAFE_DELETE(definition.m_hud)
+    }
     s_definitions.clear();
 }
 
@@ -48,6 +71,47 @@ WeaponDefinition* WeaponDefinition::GetByName(const std::string& name)
     return nullptr;
 }
 
+void WeaponDefinition::ReloadDefinitions(const XmlElement& rootElement, const char* path)
+{
+    std::vector<WeaponDefinition> reloaded;
+    const XmlElement*             element = rootElement.FirstChildElement();
+    while (element != nullptr)
+    {
+        reloaded.push_back(WeaponDefinition(*element));
+        element = element->NextSiblingElement();
+    }
+    g_theResourceSubsystem->WaitForAssets();
+    int numReplaced = 0;
+    for (WeaponDefinition& definition : reloaded)
+    {
+        if (definition.m_hud)
+            definition.m_hud->ResolveAssets();
+        WeaponDefinition* existing = GetByName(definition.m_name);
+        if (existing)
+        {
+            if (existing->m_hud)
+                existing->m_hud->ReleaseAssets(); // The reloaded hud already acquired what both share.
+            POINTER_SAFE_DELETE(existing->m_hud)
+            *existing = definition;
+            numReplaced++;
+        }
+        else
+        {
+            s_definitions.push_back(definition);
+        }
+    }
+    printf("WeaponDefinition::ReloadDefinitions    Reloaded \"%s\", %d replaced, %d added\n", path, numReplaced, static_cast<int>(reloaded.size()) - numReplaced);
+}
+
+void WeaponDefinition::ResolveAllAssets()
+{
+    for (WeaponDefinition& definition : s_definitions)
+    {
+        if (definition.m_hud)
+            definition.m_hud->ResolveAssets();
+    }
+}
+
 WeaponDefinition::WeaponDefinition(const XmlElement& weaponDefElement)
 {
     m_name                       = ParseXmlAttribute(weaponDefElement, "name", m_name);
@@ -87,16 +151,79 @@ WeaponDefinition::WeaponDefinition(const XmlElement& weaponDefElement)
             }
         }
     }
+    ResolveSoundCues();
 
     printf("WeaponDefinition::WeaponDefinition    — Create Definition \"%s\" \n", m_name.c_str());
 }
 
-Sound* WeaponDefinition::GetSoundByName(const std::string soundName)
+WeaponDefinition::WeaponDefinition(ByteBufferReader& reader)
 {
-    for (Sound& sound : m_sounds)
+    m_name            = reader.ReadString();
+    m_refireTime      = reader.Read<float>();
+    m_rayCount        = reader.Read<int>();
+    m_rayCone         = reader.Read<float>();
+    m_rayRange        = reader.Read<float>();
+    m_rayDamage       = ReadFloatRange(reader);
+    m_rayImpulse      = reader.Read<float>();
+    m_projectileCount = reader.Read<int>();
+    m_projectileCone  = reader.Read<float>();
+    m_projectileSpeed = reader.Read<float>();
+    m_projectileActor = reader.ReadString();
+    m_meleeCount      = reader.Read<int>();
+    m_meleeArc        = reader.Read<float>();
+    m_meleeRange      = reader.Read<float>();
+    m_meleeDamage     = ReadFloatRange(reader);
+    m_meleeImpulse    = reader.Read<float>();
+    bool bHasHud      = reader.Read<bool>();
+    if (bHasHud && reader.IsValid())
     {
-        if (sound.m_name == soundName)
-            return &sound;
+        m_hud = new Hud(reader);
     }
-    return nullptr;
+    unsigned int numSounds = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numSounds && reader.IsValid(); i++)
+    {
+        m_sounds.push_back(Sound(reader));
+    }
+    ResolveSoundCues();
+}
+
+void WeaponDefinition::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_name);
+    writer.Write(m_refireTime);
+    writer.Write(m_rayCount);
+    writer.Write(m_rayCone);
+    writer.Write(m_rayRange);
+    WriteFloatRange(writer, m_rayDamage);
+    writer.Write(m_rayImpulse);
+    writer.Write(m_projectileCount);
+    writer.Write(m_projectileCone);
+    writer.Write(m_projectileSpeed);
+    writer.WriteString(m_projectileActor);
+    writer.Write(m_meleeCount);
+    writer.Write(m_meleeArc);
+    writer.Write(m_meleeRange);
+    WriteFloatRange(writer, m_meleeDamage);
+    writer.Write(m_meleeImpulse);
+    writer.Write(m_hud != nullptr);
+    if (m_hud)
+    {
+        m_hud->Cook(writer);
+    }
+    writer.Write(static_cast<unsigned int>(m_sounds.size()));
+    for (const Sound& sound : m_sounds)
+    {
+        sound.Cook(writer);
+    }
+}
+
+SoundID WeaponDefinition::GetSoundCue(SoundCue cue) const
+{
+    return m_soundCues.GetSoundID(cue);
+}
+
+void WeaponDefinition::ResolveSoundCues()
+{
+    m_soundCues.Resolve(m_sounds, m_name);
+    m_soundCues.ReportIfMissing(SoundCue::FIRE, m_name);
 }
@@ -3,7 +3,10 @@
 #include "Engine/Math/FloatRange.hpp"
 #include "Game/Framework/Hud.hpp"
 #include "Game/Framework/Sound.hpp"
+#include "Game/Framework/SoundCue.hpp"
 
+class ByteBufferWriter;
+class ByteBufferReader;
 
 class WeaponDefinition
 {
@@ -12,9 +15,16 @@ public:
     static void                          LoadDefinitions(const char* path);
     static void                          ClearDefinitions();
     static WeaponDefinition*             GetByName(const std::string& name);
+    static void                          ResolveAllAssets();
+    /// Hot reload, replace the definitions of the same name in place and append the new ones. Definitions missing from
+    /// the file are kept since live weapons may still use them.
+    static void                          ReloadDefinitions(const XmlElement& rootElement, const char* path);
 
     WeaponDefinition(const XmlElement& mapDefElement);
-    Sound* GetSoundByName(std::string soundName);
+    explicit WeaponDefinition(ByteBufferReader& reader);
+    void    Cook(ByteBufferWriter& writer) const;
+    SoundID GetSoundCue(SoundCue cue) const; // MISSING_SOUND_ID if the weapon has no sound for the cue.
+    void    ResolveSoundCues(); // Look up the sound of every cue by its name, once per load.
 
     // Definition name of the weapon to add to this actor when it is spawned.
     std::string m_name = "Default";
@@ -52,4 +62,6 @@ public:
     Hud* m_hud = nullptr;
     // Sound list of weapon
     std::vector<Sound> m_sounds;
+    // Sound of every cue, resolved by name at load.
+    SoundCueTable m_soundCues;
 };
@@ -14,7 +14,6 @@ AIController::AIController(Map* map): Controller(map)
 void AIController::Update(float deltaTime)
 {
     Controller::Update(deltaTime);
-    m_state                = "None";
     Actor* controlledActor = m_map->GetActorByHandle(m_actorHandle);
     if (!controlledActor || controlledActor->m_bIsDead)
     {
@@ -52,7 +51,7 @@ void AIController::Update(float deltaTime)
         Vec3  forward, left, up;
         controlledActor->m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, up);
         controlledActor->MoveInDirection(forward, moveSpeed);
-        controlledActor->PlayAnimationByName("Walk");
+        controlledActor->PlayAnimation(AnimationState::WALK);
     }
     /// Hanlde melee weapon based on melee weapon range
     if (controlledActor->m_currentWeapon && controlledActor->m_currentWeapon->m_definition->m_meleeCount > 0)
@@ -60,8 +59,8 @@ void AIController::Update(float deltaTime)
         /// 0.2f ensure that AI try attack out side of meel range give player more opportunity.
         if (distanceToTarget < controlledActor->m_currentWeapon->m_definition->m_meleeRange + targetActor->m_physicalRadius + 0.2f)
         {
-            controlledActor->m_currentWeapon->Fire();
-            controlledActor->PlayAnimationByName(m_state, true);
+            if (controlledActor->m_currentWeapon->Fire())
+                controlledActor->PlayAnimation(AnimationState::ATTACK, true);
         }
     }
     /*else
@@ -86,3 +85,13 @@ void AIController::DamagedBy(ActorHandle& attacker)
     m_targetActorHandle = attacker;
     printf("AIController::DamagedBy    > Target actor changed to %s\n", m_map->GetActorByHandle(attacker)->m_definition->m_name.c_str());
 }
+
+ActorHandle AIController::GetTargetActorHandle() const
+{
+    return m_targetActorHandle;
+}
+
+void AIController::SetTargetActorHandle(const ActorHandle& targetHandle)
+{
+    m_targetActorHandle = targetHandle;
+}
@@ -13,6 +13,9 @@ public:
 
     void DamagedBy(ActorHandle& attacker); // Notification that the AI actor was damaged so this AI can target them.
 
+    ActorHandle GetTargetActorHandle() const;
+    void        SetTargetActorHandle(const ActorHandle& targetHandle); // Used by snapshot restore to relink the target.
+
 private:
     ActorHandle m_targetActorHandle; // Handle for our current target actor, if any.
 };
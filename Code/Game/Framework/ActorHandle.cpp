@@ -53,7 +53,7 @@ unsigned int ActorHandle::GetIndex() const
     return m_data & 0xFFFF;
 }
 
-unsigned int ActorHandle::GetData()
+unsigned int ActorHandle::GetData() const
 {
     return m_data;
 }
@@ -10,7 +10,7 @@ struct ActorHandle
 
     bool         IsValid() const;
     unsigned int GetIndex() const;
-    unsigned int GetData();
+    unsigned int GetData() const;
     std::string  ToString() const;
     bool         operator==(const ActorHandle& other) const;
     bool         operator!=(const ActorHandle& other) const;
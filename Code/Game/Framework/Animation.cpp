@@ -4,23 +4,69 @@
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 
 Animation::Animation(const XmlElement& animationElement)
 {
     m_name            = ParseXmlAttribute(animationElement, "name", m_name);
     m_cellCount       = ParseXmlAttribute(animationElement, "cellCount", m_cellCount);
-    m_shader          = g_theRenderer->CreateShaderFromFile(ParseXmlAttribute(animationElement, "shader", m_name).c_str(), VertexType::Vertex_PCU);
-    m_spriteSheet     = new SpriteSheet(*g_theRenderer->CreateOrGetTextureFromFile(ParseXmlAttribute(animationElement, "spriteSheet", m_name).c_str()), m_cellCount);
+    m_shaderPath      = ParseXmlAttribute(animationElement, "shader", m_name);
+    m_spriteSheetPath = ParseXmlAttribute(animationElement, "spriteSheet", m_name);
     m_startFrame      = ParseXmlAttribute(animationElement, "startFrame", 0);
     m_endFrame        = ParseXmlAttribute(animationElement, "endFrame", 0);
     m_secondsPerFrame = ParseXmlAttribute(animationElement, "secondsPerFrame", m_secondsPerFrame);
-    m_spriteAnim      = new SpriteAnimDefinition(*m_spriteSheet, m_startFrame, m_endFrame, 1.0f / m_secondsPerFrame, m_playbackType);
+    RequestAssets();
     printf("Animation::Animation    Create Animation: %s \n", m_name.c_str());
 }
 
-Animation::~Animation()
+Animation::Animation(ByteBufferReader& reader)
 {
-    POINTER_SAFE_DELETE(m_shader)
+    m_name            = reader.ReadString();
+    m_cellCount       = ReadIntVec2(reader);
+    m_shaderPath      = reader.ReadString();
+    m_spriteSheetPath = reader.ReadString();
+    m_startFrame      = reader.Read<int>();
+    m_endFrame        = reader.Read<int>();
+    m_secondsPerFrame = reader.Read<float>();
+    RequestAssets();
+}
+
+void Animation::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_name);
+    WriteIntVec2(writer, m_cellCount);
+    writer.WriteString(m_shaderPath);
+    writer.WriteString(m_spriteSheetPath);
+    writer.Write(m_startFrame);
+    writer.Write(m_endFrame);
+    writer.Write(m_secondsPerFrame);
+}
+
+void Animation::ResolveAssets()
+{
+    if (m_spriteSheet || !m_spriteSheetAsset.IsReady())
+        return;
+    m_spriteSheet = g_theResourceSubsystem->AcquireSpriteSheet(m_spriteSheetAsset, m_cellCount);
+    m_spriteAnim  = new SpriteAnimDefinition(*m_spriteSheet, m_startFrame, m_endFrame, 1.0f / m_secondsPerFrame, m_playbackType);
+}
+
+void Animation::ReleaseAssets()
+{
+    POINTER_SAFE_DELETE(m_spriteAnim)
+    g_theResourceSubsystem->ReleaseShader(m_shader);
+    g_theResourceSubsystem->ReleaseSpriteSheet(m_spriteSheet);
+    g_theResourceSubsystem->ReleaseAsset(m_spriteSheetAsset);
+    m_shader           = nullptr;
+    m_spriteSheet      = nullptr;
+    m_spriteSheetAsset = AssetHandle();
+}
+
+void Animation::RequestAssets()
+{
+    m_spriteSheetAsset = g_theResourceSubsystem->RequestTexture(m_spriteSheetPath);
+    m_shader           = g_theResourceSubsystem->AcquireShader(m_shaderPath, VertexType::Vertex_PCU);
 }
 
 float Animation::GetAnimationLength()
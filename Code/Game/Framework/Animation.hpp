@@ -4,14 +4,20 @@
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/SpriteAnimDefinition.hpp"
+#include "Game/Framework/AssetLoader.hpp"
 
 class SpriteSheet;
+class ByteBufferWriter;
+class ByteBufferReader;
 
 class Animation
 {
 public:
     Animation(const XmlElement& animationElement);
-    ~Animation();
+    explicit Animation(ByteBufferReader& reader);
+    void  Cook(ByteBufferWriter& writer) const;
+    void  ResolveAssets(); // Build the sprite sheet and sprite animation once the sprite sheet texture is ready.
+    void  ReleaseAssets();
     float GetAnimationLength();
 
     const SpriteAnimDefinition* GetAnimationDefinition();
@@ -19,11 +25,16 @@ public:
     std::string m_name;
 
 private:
-    IntVec2 m_cellCount;
-    float   m_secondsPerFrame = 0.f;
-    int     m_startFrame      = 0;
-    int     m_endFrame        = 0;
+    void RequestAssets(); // Queue the sprite sheet texture and create the shader from the parsed paths.
 
+    std::string m_shaderPath;
+    std::string m_spriteSheetPath;
+    IntVec2     m_cellCount;
+    float       m_secondsPerFrame = 0.f;
+    int         m_startFrame      = 0;
+    int         m_endFrame        = 0;
+
+    AssetHandle            m_spriteSheetAsset;
     Shader*                m_shader       = nullptr;
     const SpriteSheet*     m_spriteSheet  = nullptr;
     SpriteAnimDefinition*  m_spriteAnim   = nullptr;
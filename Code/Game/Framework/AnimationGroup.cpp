@@ -1,15 +1,19 @@
 ﻿#include "AnimationGroup.hpp"
 
+#include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
 
 
-AnimationGroup::AnimationGroup(const XmlElement& animationGroupElement, const SpriteSheet& spriteSheet): m_spriteSheet(spriteSheet)
+AnimationGroup::AnimationGroup(const XmlElement& animationGroupElement)
 {
     printf("AnimationGroup::AnimationGroup    %s", "Start Loading AnimationGroup\n");
     //                                 ‖ 
     m_name                   = ParseXmlAttribute(animationGroupElement, "name", m_name);
     m_scaleBySpeed           = ParseXmlAttribute(animationGroupElement, "scaleBySpeed", m_scaleBySpeed);
     m_secondsPerFrame        = ParseXmlAttribute(animationGroupElement, "secondsPerFrame", m_secondsPerFrame);
+    m_priority               = ParseXmlAttribute(animationGroupElement, "priority", m_priority);
     std::string playbackMode = "Loop";
     playbackMode             = ParseXmlAttribute(animationGroupElement, "playbackMode", playbackMode);
     if (playbackMode == "Loop")
@@ -33,8 +37,7 @@ AnimationGroup::AnimationGroup(const XmlElement& animationGroupElement, const Sp
             const XmlElement* animationElement = element->FirstChildElement();
             int               startFrame       = ParseXmlAttribute(*animationElement, "startFrame", 0);
             int               endFrame         = ParseXmlAttribute(*animationElement, "endFrame", 0);
-            auto              animation        = SpriteAnimDefinition(spriteSheet, startFrame, endFrame, 1.0f / m_secondsPerFrame, m_playbackType);
-            m_animations.insert(std::make_pair(directionVector.GetNormalized(), animation)); // Be-careful that 
+            m_directions.push_back({directionVector, startFrame, endFrame});
             element = element->NextSiblingElement();
             printf("                                 ‖ Add Direction (%d, %d, %d) to Animation Group\n", static_cast<int>(directionVector.x), static_cast<int>(directionVector.y),
                    static_cast<int>(directionVector.z));
@@ -42,42 +45,141 @@ AnimationGroup::AnimationGroup(const XmlElement& animationGroupElement, const Sp
     }
 }
 
-const SpriteAnimDefinition& AnimationGroup::GetSpriteAnimation(Vec3 direction)
+AnimationGroup::AnimationGroup(ByteBufferReader& reader)
 {
-    Vec3  leastOffset     = direction;
-    float directionScalar = -FLT_MAX;
-    for (std::pair<const Vec3, SpriteAnimDefinition>& animation : m_animations)
+    m_name                     = reader.ReadString();
+    m_scaleBySpeed             = reader.Read<float>();
+    m_secondsPerFrame          = reader.Read<float>();
+    m_priority                 = reader.Read<int>();
+    m_playbackType             = static_cast<SpriteAnimPlaybackType>(reader.Read<unsigned char>());
+    unsigned int numDirections = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numDirections && reader.IsValid(); i++)
     {
-        float scalar = DotProduct3D(direction, animation.first);
-        if (scalar > directionScalar)
-        {
-            directionScalar = scalar;
-            leastOffset     = animation.first;
-        }
+        Vec3 directionVector = ReadVec3(reader);
+        int  startFrame      = reader.Read<int>();
+        int  endFrame        = reader.Read<int>();
+        m_directions.push_back({directionVector, startFrame, endFrame});
     }
-    return m_animations.at(leastOffset);
 }
 
-float AnimationGroup::GetAnimationLength()
+void AnimationGroup::Cook(ByteBufferWriter& writer) const
 {
-    float totalLength = -1;
-    for (std::pair<const Vec3, SpriteAnimDefinition>& animation : m_animations)
+    writer.WriteString(m_name);
+    writer.Write(m_scaleBySpeed);
+    writer.Write(m_secondsPerFrame);
+    writer.Write(m_priority);
+    writer.Write(static_cast<unsigned char>(m_playbackType));
+    writer.Write(static_cast<unsigned int>(m_directions.size()));
+    for (const AnimationDirection& direction : m_directions)
     {
-        totalLength = animation.second.GetDuration();
-        if (totalLength > 0.f)
-            return totalLength;
+        WriteVec3(writer, direction.m_direction);
+        writer.Write(direction.m_startFrame);
+        writer.Write(direction.m_endFrame);
     }
-    return -1;
 }
 
-int AnimationGroup::GetAnimationTotalFrame()
+void AnimationGroup::CreateAnimations(const SpriteSheet& spriteSheet)
 {
-    int totalFrame = -1;
-    for (std::pair<const Vec3, SpriteAnimDefinition>& animation : m_animations)
+    if (m_directions.size() > 0xffu)
+        ERROR_AND_DIE(Stringf("AnimationGroup::CreateAnimations    \"%s\" has more directions than the sector table can index", m_name.c_str()))
+
+    m_spriteSheet = &spriteSheet;
+    m_animations.clear();
+    m_directionNormals.clear();
+    m_animations.reserve(m_directions.size());
+    m_directionNormals.reserve(m_directions.size());
+    for (const AnimationDirection& direction : m_directions)
     {
-        totalFrame = animation.second.GetTotalFrameInCycle();
-        if (totalFrame > 0)
-            return totalFrame;
+        m_animations.emplace_back(spriteSheet, direction.m_startFrame, direction.m_endFrame, 1.0f / m_secondsPerFrame, m_playbackType);
+        m_directionNormals.push_back(direction.m_direction.GetNormalized());
     }
-    return -1;
+
+    /// Length and frame count never change once the animations exist
+    m_animationLength     = -1.f;
+    m_animationTotalFrame = -1;
+    for (const SpriteAnimDefinition& animation : m_animations)
+    {
+        if (m_animationLength <= 0.f && animation.GetDuration() > 0.f)
+            m_animationLength = animation.GetDuration();
+        if (m_animationTotalFrame <= 0 && animation.GetTotalFrameInCycle() > 0)
+            m_animationTotalFrame = animation.GetTotalFrameInCycle();
+    }
+    BuildSectorTable();
+}
+
+const SpriteAnimDefinition& AnimationGroup::GetSpriteAnimation(const Vec3& direction) const
+{
+    if (m_animations.empty())
+        ERROR_AND_DIE(Stringf("AnimationGroup::GetSpriteAnimation    \"%s\" has no animations", m_name.c_str()))
+    if (m_sectorAnimations.empty())
+        return m_animations[GetClosestDirectionIndex(direction)];
+    if (direction.x == 0.f && direction.y == 0.f)
+        return m_animations[0];
+    int sector = static_cast<int>(GetDiamondAngle(direction.x, direction.y) * (static_cast<float>(ANIMATION_SECTOR_COUNT) * 0.25f));
+    return m_animations[m_sectorAnimations[sector < ANIMATION_SECTOR_COUNT ? sector : 0]];
+}
+
+float AnimationGroup::GetAnimationLength() const
+{
+    return m_animationLength;
+}
+
+int AnimationGroup::GetAnimationTotalFrame() const
+{
+    return m_animationTotalFrame;
+}
+
+void AnimationGroup::BuildSectorTable()
+{
+    m_sectorAnimations.clear();
+    for (const Vec3& directionNormal : m_directionNormals)
+    {
+        if (directionNormal.z != 0.f)
+            return; // The yaw alone can not pick between directions that differ in pitch, keep the dot products.
+    }
+
+    /// Every sector takes the animation closest to the direction at its center
+    m_sectorAnimations.resize(ANIMATION_SECTOR_COUNT);
+    for (int sector = 0; sector < ANIMATION_SECTOR_COUNT; sector++)
+    {
+        float diamondAngle = (static_cast<float>(sector) + 0.5f) * (4.f / static_cast<float>(ANIMATION_SECTOR_COUNT));
+        int   quadrant     = static_cast<int>(diamondAngle);
+        float fraction     = diamondAngle - static_cast<float>(quadrant);
+        Vec3  sectorDirection;
+        switch (quadrant)
+        {
+        case 0: sectorDirection = Vec3(1.f - fraction, fraction, 0.f);
+            break;
+        case 1: sectorDirection = Vec3(-fraction, 1.f - fraction, 0.f);
+            break;
+        case 2: sectorDirection = Vec3(fraction - 1.f, -fraction, 0.f);
+            break;
+        default: sectorDirection = Vec3(fraction, fraction - 1.f, 0.f);
+            break;
+        }
+        m_sectorAnimations[sector] = static_cast<unsigned char>(GetClosestDirectionIndex(sectorDirection));
+    }
+}
+
+int AnimationGroup::GetClosestDirectionIndex(const Vec3& direction) const
+{
+    int   closestIndex  = 0;
+    float closestScalar = -FLT_MAX;
+    for (int index = 0; index < static_cast<int>(m_directionNormals.size()); index++)
+    {
+        float scalar = DotProduct3D(direction, m_directionNormals[index]);
+        if (scalar > closestScalar)
+        {
+            closestScalar = scalar;
+            closestIndex  = index;
+        }
+    }
+    return closestIndex;
+}
+
+float AnimationGroup::GetDiamondAngle(float x, float y)
+{
+    if (y >= 0.f)
+        return x >= 0.f ? y / (x + y) : 1.f - x / (-x + y);
+    return x < 0.f ? 2.f - y / (-x - y) : 3.f + x / (x - y);
 }
@@ -1,25 +1,55 @@
 ﻿#pragma once
-#include <map>
 #include <string>
+#include <vector>
 
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Renderer/SpriteAnimDefinition.hpp"
 
+class ByteBufferWriter;
+class ByteBufferReader;
+
+static constexpr int ANIMATION_SECTOR_COUNT = 256; // Yaw sectors of the direction lookup, in diamond angle steps.
+
+/// Direction of an animation group as authored, the sprite animations are built from it once the sprite sheet is loaded.
+struct AnimationDirection
+{
+    Vec3 m_direction;
+    int  m_startFrame = 0;
+    int  m_endFrame   = 0;
+};
+
 class AnimationGroup
 {
 public:
-    AnimationGroup(const XmlElement& animationGroupElement, const SpriteSheet& spriteSheet);
+    explicit AnimationGroup(const XmlElement& animationGroupElement);
+    explicit AnimationGroup(ByteBufferReader& reader);
+    void Cook(ByteBufferWriter& writer) const;
+    void CreateAnimations(const SpriteSheet& spriteSheet); // Build the sprite animations once the sprite sheet texture is loaded.
 
     /// Getter
-    const SpriteAnimDefinition& GetSpriteAnimation(Vec3 direction);
-    float                       GetAnimationLength();
-    int                         GetAnimationTotalFrame();
-
-    std::string                          m_name            = "Default";
-    float                                m_scaleBySpeed    = true;
-    float                                m_secondsPerFrame = 0.25f;
-    SpriteAnimPlaybackType               m_playbackType    = SpriteAnimPlaybackType::LOOP;
-    const SpriteSheet&                   m_spriteSheet;
-    std::map<Vec3, SpriteAnimDefinition> m_animations;
+    /// Animation whose authored direction is closest to the direction, looked up by yaw sector without any trigonometry.
+    const SpriteAnimDefinition& GetSpriteAnimation(const Vec3& direction) const;
+    float                       GetAnimationLength() const; // Duration of the first animation that has one, -1 before CreateAnimations.
+    int                         GetAnimationTotalFrame() const;
+
+    std::string                       m_name            = "Default";
+    float                             m_scaleBySpeed    = true;
+    float                             m_secondsPerFrame = 0.25f;
+    int                               m_priority        = -1; // State machine priority, negative keeps the default of the state.
+    SpriteAnimPlaybackType            m_playbackType    = SpriteAnimPlaybackType::LOOP;
+    const SpriteSheet*                m_spriteSheet     = nullptr;
+    std::vector<SpriteAnimDefinition> m_animations; // Same order as m_directions.
+    std::vector<AnimationDirection>   m_directions;
+
+private:
+    void BuildSectorTable();
+    int  GetClosestDirectionIndex(const Vec3& direction) const; // Dot product over every direction, for the sector table and 3D directions.
+    /// Monotonic stand-in for the yaw of an XY direction in [0, 4), one unit per quadrant.
+    static float GetDiamondAngle(float x, float y);
+
+    std::vector<Vec3>          m_directionNormals; // Normalized m_directions.
+    std::vector<unsigned char> m_sectorAnimations; // Animation index per yaw sector, empty if a direction leaves the XY plane.
+    float                      m_animationLength     = -1.f;
+    int                        m_animationTotalFrame = -1;
 };
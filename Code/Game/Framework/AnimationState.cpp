@@ -0,0 +1,82 @@
+﻿#include "AnimationState.hpp"
+
+static const char* ANIMATION_STATE_NAMES[ANIMATION_STATE_COUNT] = {"Idle", "Walk", "Attack", "Hurt", "Death"};
+
+const char* GetAnimationStateName(AnimationState state)
+{
+    if (state >= AnimationState::COUNT)
+        return "";
+    return ANIMATION_STATE_NAMES[static_cast<int>(state)];
+}
+
+AnimationState GetAnimationStateByName(const std::string& name)
+{
+    for (int state = 0; state < ANIMATION_STATE_COUNT; state++)
+    {
+        if (name == ANIMATION_STATE_NAMES[state])
+            return static_cast<AnimationState>(state);
+    }
+    return AnimationState::COUNT;
+}
+
+AnimationStateMachine::AnimationStateMachine()
+{
+    for (int state = 0; state < ANIMATION_STATE_COUNT; state++)
+    {
+        m_animationIds[state] = ANIMATION_ID_NONE;
+        m_priorities[state]   = state; // Idle < Walk < Attack < Hurt < Death
+        m_bIsFinal[state]     = false;
+    }
+    m_bIsFinal[static_cast<int>(AnimationState::DEATH)] = true;
+}
+
+void AnimationStateMachine::Clear()
+{
+    for (int& animationId : m_animationIds)
+    {
+        animationId = ANIMATION_ID_NONE;
+    }
+}
+
+void AnimationStateMachine::SetAnimation(AnimationState state, int animationId, int priority)
+{
+    if (state >= AnimationState::COUNT)
+        return;
+    m_animationIds[static_cast<int>(state)] = animationId;
+    if (priority >= 0)
+        m_priorities[static_cast<int>(state)] = priority;
+}
+
+int AnimationStateMachine::GetAnimationId(AnimationState state) const
+{
+    if (state >= AnimationState::COUNT)
+        return ANIMATION_ID_NONE;
+    return m_animationIds[static_cast<int>(state)];
+}
+
+int AnimationStateMachine::GetPriority(AnimationState state) const
+{
+    if (state >= AnimationState::COUNT)
+        return -1;
+    return m_priorities[static_cast<int>(state)];
+}
+
+bool AnimationStateMachine::IsFinal(AnimationState state) const
+{
+    return state < AnimationState::COUNT && m_bIsFinal[static_cast<int>(state)];
+}
+
+bool AnimationStateMachine::CanTransition(AnimationState current, bool bIsCurrentPlaying, AnimationState requested, bool bForce) const
+{
+    if (GetAnimationId(requested) == ANIMATION_ID_NONE)
+        return false;
+    if (bIsCurrentPlaying && requested == current)
+        return false;
+    if (bForce)
+        return true;
+    if (IsFinal(current))
+        return false;
+    if (!bIsCurrentPlaying)
+        return true;
+    return GetPriority(requested) > GetPriority(current);
+}
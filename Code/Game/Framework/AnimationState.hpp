@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <string>
+
+enum class AnimationState : unsigned char
+{
+    IDLE,
+    WALK,
+    ATTACK,
+    HURT,
+    DEATH,
+    COUNT
+};
+
+static constexpr int ANIMATION_STATE_COUNT = static_cast<int>(AnimationState::COUNT);
+static constexpr int ANIMATION_ID_NONE     = -1;
+
+const char*    GetAnimationStateName(AnimationState state); // Animation name authored for the state, e.g. "Walk".
+AnimationState GetAnimationStateByName(const std::string& name); // COUNT if the name is not a state.
+
+/// Animation of every state of a definition plus the rules deciding whether a requested state may replace the playing
+/// one. The IDs are indexes into the animations of the definition, resolved once by name at load, so per frame
+/// requests are integer compares. A state replaces a playing state of lower priority, otherwise it waits until the
+/// playing animation finished. A final state is never left without force.
+class AnimationStateMachine
+{
+public:
+    AnimationStateMachine();
+
+    void Clear(); // Forget the animations, the priorities stay.
+    /// @param priority Priority of the state, negative keeps the default.
+    void SetAnimation(AnimationState state, int animationId, int priority = -1);
+    int  GetAnimationId(AnimationState state) const;
+    int  GetPriority(AnimationState state) const;
+    bool IsFinal(AnimationState state) const;
+    /// Decide whether the requested state starts playing. Requesting the playing state again never restarts it.
+    bool CanTransition(AnimationState current, bool bIsCurrentPlaying, AnimationState requested, bool bForce) const;
+
+private:
+    int  m_animationIds[ANIMATION_STATE_COUNT];
+    int  m_priorities[ANIMATION_STATE_COUNT];
+    bool m_bIsFinal[ANIMATION_STATE_COUNT];
+};
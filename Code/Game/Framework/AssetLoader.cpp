@@ -0,0 +1,244 @@
+﻿#include "AssetLoader.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Game/GameCommon.hpp"
+
+AssetHandle::AssetHandle(const AssetRecord* record): m_record(record)
+{
+}
+
+bool AssetHandle::IsValid() const
+{
+    return m_record != nullptr;
+}
+
+bool AssetHandle::IsReady() const
+{
+    return m_record && m_record->m_state == AssetState::READY;
+}
+
+Texture* AssetHandle::GetTexture() const
+{
+    return IsReady() ? m_record->m_texture : nullptr;
+}
+
+Image* AssetHandle::GetImage() const
+{
+    return IsReady() ? m_record->m_image : nullptr;
+}
+
+const std::string& AssetHandle::GetPath() const
+{
+    static const std::string s_emptyPath;
+    return m_record ? m_record->m_path : s_emptyPath;
+}
+
+void AssetLoader::Startup(int numWorkers)
+{
+    if (numWorkers <= 0)
+        numWorkers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    m_bIsStopping = false;
+    for (int i = 0; i < numWorkers; i++)
+    {
+        m_workers.emplace_back(&AssetLoader::WorkerThreadMain, this);
+    }
+    printf("AssetLoader::Startup    Started %d asset worker threads\n", numWorkers);
+}
+
+void AssetLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bIsStopping = true;
+    }
+    m_workCondition.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    for (std::pair<const std::string, AssetRecord*>& record : m_records)
+    {
+        POINTER_SAFE_DELETE(record.second->m_image)
+        POINTER_SAFE_DELETE(record.second)
+    }
+    m_records.clear();
+    m_workQueue.clear();
+    m_decodedQueue.clear();
+    m_nextWork         = 0;
+    m_numPendingAssets = 0;
+    m_numRequests[0]   = 0;
+    m_numRequests[1]   = 0;
+}
+
+AssetHandle AssetLoader::RequestImage(const std::string& path)
+{
+    return RequestAsset(path, AssetType::IMAGE);
+}
+
+AssetHandle AssetLoader::RequestTexture(const std::string& path)
+{
+    return RequestAsset(path, AssetType::TEXTURE);
+}
+
+AssetHandle AssetLoader::RequestAsset(const std::string& path, AssetType type)
+{
+    std::string key = (type == AssetType::TEXTURE ? "Texture|" : "Image|") + path;
+    auto        it  = m_records.find(key);
+    m_numRequests[static_cast<int>(type)]++;
+    if (it != m_records.end())
+    {
+        AssetRecord* record = it->second;
+        record->m_refCount++;
+        if (record->m_state == AssetState::UNLOADED)
+            QueueAsset(record);
+        return AssetHandle(record);
+    }
+
+    AssetRecord* record = new AssetRecord();
+    record->m_path      = path;
+    record->m_type      = type;
+    record->m_refCount  = 1;
+    m_records.emplace(key, record);
+    QueueAsset(record);
+    return AssetHandle(record);
+}
+
+void AssetLoader::ReleaseAsset(const AssetHandle& handle)
+{
+    AssetRecord* record = const_cast<AssetRecord*>(handle.m_record);
+    if (!record || record->m_refCount <= 0)
+        return;
+    record->m_refCount--;
+    if (record->m_refCount == 0 && record->m_type == AssetType::IMAGE && record->m_state == AssetState::READY)
+    {
+        POINTER_SAFE_DELETE(record->m_image)
+        record->m_state = AssetState::UNLOADED;
+    }
+}
+
+void AssetLoader::QueueAsset(AssetRecord* record)
+{
+    record->m_state       = AssetState::LOADING;
+    record->m_requestTime = GetCurrentTimeSeconds();
+    m_numPendingAssets++;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workQueue.push_back(record);
+    }
+    m_workCondition.notify_one();
+}
+
+void AssetLoader::ProcessDecodedAssets()
+{
+    std::vector<AssetRecord*> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        decoded.swap(m_decodedQueue);
+    }
+    for (AssetRecord* record : decoded)
+    {
+        FinalizeAsset(record);
+    }
+}
+
+void AssetLoader::WaitForAssets()
+{
+    if (m_numPendingAssets == 0)
+        return;
+    double startTime = GetCurrentTimeSeconds();
+    while (m_numPendingAssets > 0)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_decodedCondition.wait(lock, [this]() { return !m_decodedQueue.empty(); });
+        }
+        ProcessDecodedAssets();
+    }
+    printf("AssetLoader::WaitForAssets    %d assets ready, waited %.3f ms for %.3f ms of decoding on %d workers and %.3f ms of uploads\n", m_numLoadedAssets,
+           (GetCurrentTimeSeconds() - startTime) * 1000.0, m_totalDecodeSeconds * 1000.0, static_cast<int>(m_workers.size()), m_totalUploadSeconds * 1000.0);
+}
+
+int AssetLoader::GetNumPendingAssets() const
+{
+    return m_numPendingAssets;
+}
+
+int AssetLoader::GetNumUniqueAssets(AssetType type) const
+{
+    int numUniqueAssets = 0;
+    for (const std::pair<const std::string, AssetRecord*>& record : m_records)
+    {
+        if (record.second->m_type == type)
+            numUniqueAssets++;
+    }
+    return numUniqueAssets;
+}
+
+int AssetLoader::GetNumRequestedAssets(AssetType type) const
+{
+    return m_numRequests[static_cast<int>(type)];
+}
+
+void AssetLoader::FinalizeAsset(AssetRecord* record)
+{
+    m_numPendingAssets--;
+    if (!record->m_image)
+    {
+        record->m_state = AssetState::FAILED;
+        ERROR_AND_DIE(Stringf("AssetLoader::FinalizeAsset    Failed to load \"%s\"", record->m_path.c_str()))
+    }
+    if (record->m_type == AssetType::TEXTURE)
+    {
+        double uploadStartTime  = GetCurrentTimeSeconds();
+        record->m_texture       = g_theRenderer->CreateTextureFromImage(*record->m_image);
+        record->m_uploadSeconds = GetCurrentTimeSeconds() - uploadStartTime;
+        POINTER_SAFE_DELETE(record->m_image)
+    }
+    record->m_state = AssetState::READY;
+    m_numLoadedAssets++;
+    m_totalDecodeSeconds += record->m_decodeSeconds;
+    m_totalUploadSeconds += record->m_uploadSeconds;
+    printf("AssetLoader::FinalizeAsset    Loaded %s \"%s\", decode %.3f ms, upload %.3f ms, ready %.3f ms after request\n", record->m_type == AssetType::TEXTURE ? "texture" : "image",
+           record->m_path.c_str(), record->m_decodeSeconds * 1000.0, record->m_uploadSeconds * 1000.0, (GetCurrentTimeSeconds() - record->m_requestTime) * 1000.0);
+}
+
+void AssetLoader::WorkerThreadMain()
+{
+    while (true)
+    {
+        AssetRecord* record = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCondition.wait(lock, [this]() { return m_bIsStopping || m_nextWork < m_workQueue.size(); });
+            if (m_bIsStopping)
+                return;
+            record = m_workQueue[m_nextWork++];
+            if (m_nextWork == m_workQueue.size())
+            {
+                m_workQueue.clear();
+                m_nextWork = 0;
+            }
+        }
+
+        double          startTime = GetCurrentTimeSeconds();
+        std::error_code error;
+        if (std::filesystem::is_regular_file(record->m_path, error))
+        {
+            record->m_image = new Image(record->m_path.c_str());
+        }
+        record->m_decodeSeconds = GetCurrentTimeSeconds() - startTime;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decodedQueue.push_back(record);
+        }
+        m_decodedCondition.notify_one();
+    }
+}
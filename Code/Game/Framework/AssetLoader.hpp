@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Image;
+class Texture;
+
+enum class AssetType : unsigned char
+{
+    IMAGE, // CPU side image, ready as soon as it is decoded.
+    TEXTURE, // Decoded on a worker, then uploaded to the GPU by the main thread.
+};
+
+enum class AssetState : unsigned char
+{
+    LOADING,
+    READY,
+    FAILED,
+    UNLOADED, // Released by every user, an image frees its pixels and reloads on the next request.
+};
+
+/// One requested file. Workers only write the decode results and hand the record back through the decoded queue,
+/// every other field is owned by the main thread.
+struct AssetRecord
+{
+    std::string m_path;
+    AssetType   m_type          = AssetType::IMAGE;
+    AssetState  m_state         = AssetState::LOADING;
+    Image*      m_image         = nullptr;
+    Texture*    m_texture       = nullptr;
+    double      m_requestTime   = 0.0;
+    double      m_decodeSeconds = 0.0;
+    double      m_uploadSeconds = 0.0;
+    int         m_refCount      = 0; // Number of requests not released yet.
+};
+
+/// Reference to a requested asset that resolves once the asset is ready. Handles are cheap to copy and stay valid
+/// until the loader shuts down.
+class AssetHandle
+{
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(const AssetRecord* record);
+
+    bool               IsValid() const; // Whether or not an asset was requested through this handle.
+    bool               IsReady() const;
+    Texture*           GetTexture() const; // Null until the texture is uploaded.
+    Image*             GetImage() const; // Null until the image is decoded.
+    const std::string& GetPath() const;
+
+private:
+    friend class AssetLoader;
+    const AssetRecord* m_record = nullptr;
+};
+
+/// Loads images and textures on a pool of worker threads. Workers read and decode the files, the main thread only
+/// uploads decoded textures to the GPU since the renderer is not thread safe. Repeated requests of the same file share
+/// one record, and every asset reports how long it spent decoding, uploading and waiting.
+class AssetLoader
+{
+public:
+    void Startup(int numWorkers);
+    void Shutdown(); // Join the workers and free the images, textures belong to the renderer.
+
+    AssetHandle RequestImage(const std::string& path);
+    AssetHandle RequestTexture(const std::string& path);
+    void        ReleaseAsset(const AssetHandle& handle); // Textures stay resident since the renderer owns them.
+    void        ProcessDecodedAssets(); // Upload the decoded textures and resolve their handles, main thread only.
+    void        WaitForAssets(); // Block the main thread until every requested asset is ready.
+    int         GetNumPendingAssets() const;
+    int         GetNumUniqueAssets(AssetType type) const;
+    int         GetNumRequestedAssets(AssetType type) const;
+
+private:
+    AssetHandle RequestAsset(const std::string& path, AssetType type);
+    void        QueueAsset(AssetRecord* record);
+    void        FinalizeAsset(AssetRecord* record);
+    void        WorkerThreadMain();
+
+    std::unordered_map<std::string, AssetRecord*> m_records; // Keyed by type and path, main thread only.
+    int                                           m_numPendingAssets   = 0;
+    int                                           m_numLoadedAssets    = 0;
+    double                                        m_totalDecodeSeconds = 0.0;
+    double                                        m_totalUploadSeconds = 0.0;
+    int                                           m_numRequests[2]     = {0, 0}; // Per asset type, including the shared ones.
+
+    /// Shared with the workers, guarded by m_mutex
+    std::mutex                m_mutex;
+    std::condition_variable   m_workCondition;
+    std::condition_variable   m_decodedCondition;
+    std::vector<AssetRecord*> m_workQueue;
+    std::vector<AssetRecord*> m_decodedQueue;
+    size_t                    m_nextWork    = 0;
+    bool                      m_bIsStopping = false;
+
+    std::vector<std::thread> m_workers;
+};
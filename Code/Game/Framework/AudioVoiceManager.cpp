@@ -0,0 +1,235 @@
+﻿#include "AudioVoiceManager.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "Game/GameCommon.hpp"
+
+void AudioVoiceManager::Startup(const AudioVoiceConfig& config)
+{
+    m_config = config;
+    m_voices.reserve(static_cast<size_t>(m_config.m_maxVoices));
+    printf("AudioVoiceManager::Startup    %d voices, %d per sound, culled beyond %.1f\n", m_config.m_maxVoices, m_config.m_maxVoicesPerSound, m_config.m_cullDistance);
+}
+
+void AudioVoiceManager::Shutdown()
+{
+    printf("AudioVoiceManager::Shutdown    %d requested, %d coalesced, %d culled, %d stolen, %d dropped\n", m_numRequested, m_numCoalesced, m_numCulled, m_numStolen,
+           m_numDropped);
+    m_voices.clear();
+    m_requests.clear();
+    m_listenerPositions.clear();
+}
+
+void AudioVoiceManager::RequestSoundAt(SoundID soundID, const Vec3& position, SoundPriority priority, unsigned int emitterID, float volume)
+{
+    if (soundID == MISSING_SOUND_ID)
+        return;
+    VoiceRequest request;
+    request.m_soundID   = soundID;
+    request.m_position  = position;
+    request.m_priority  = priority;
+    request.m_emitterID = emitterID;
+    request.m_volume    = volume;
+    m_requests.push_back(request);
+}
+
+void AudioVoiceManager::SetNumListeners(int numListeners)
+{
+    m_listenerPositions.resize(static_cast<size_t>(numListeners));
+}
+
+void AudioVoiceManager::SetListenerPosition(int listenerIndex, const Vec3& position)
+{
+    if (listenerIndex < 0)
+        return;
+    if (listenerIndex >= static_cast<int>(m_listenerPositions.size()))
+        m_listenerPositions.resize(static_cast<size_t>(listenerIndex) + 1);
+    m_listenerPositions[listenerIndex] = position;
+}
+
+void AudioVoiceManager::Update()
+{
+    ReapFinishedVoices();
+
+    m_numRequested += static_cast<int>(m_requests.size());
+    if (m_requests.empty())
+        return;
+
+    CoalesceRequests();
+
+    /// Cull against every listener, a sound only one split screen player hears still plays
+    float cullDistanceSquared = m_config.m_cullDistance * m_config.m_cullDistance;
+    for (int i = static_cast<int>(m_requests.size()) - 1; i >= 0; i--)
+    {
+        VoiceRequest& request     = m_requests[i];
+        request.m_distanceSquared = GetNearestListenerDistanceSquared(request.m_position);
+        if (request.m_distanceSquared > cullDistanceSquared)
+        {
+            m_requests[i] = m_requests.back();
+            m_requests.pop_back();
+            m_numCulled++;
+        }
+    }
+
+    std::sort(m_requests.begin(), m_requests.end(), [](const VoiceRequest& a, const VoiceRequest& b)
+    {
+        if (a.m_priority != b.m_priority)
+            return a.m_priority > b.m_priority;
+        return a.m_distanceSquared < b.m_distanceSquared;
+    });
+
+    for (const VoiceRequest& request : m_requests)
+    {
+        if (request.m_emitterID != 0 && IsEmitterPlaying(request.m_soundID, request.m_emitterID))
+        {
+            m_numDropped++;
+            continue;
+        }
+
+        int stealIndex = -1;
+        if (CountVoices(request.m_soundID) >= m_config.m_maxVoicesPerSound)
+        {
+            stealIndex = FindVoiceToSteal(request, true);
+            if (stealIndex < 0)
+            {
+                m_numDropped++;
+                continue;
+            }
+        }
+        else if (static_cast<int>(m_voices.size()) >= m_config.m_maxVoices)
+        {
+            stealIndex = FindVoiceToSteal(request, false);
+            if (stealIndex < 0)
+            {
+                m_numDropped++;
+                continue;
+            }
+        }
+        if (stealIndex >= 0)
+        {
+            StopVoice(stealIndex);
+            m_numStolen++;
+        }
+
+        Voice voice;
+        voice.m_playbackID      = g_theAudio->StartSoundAt(request.m_soundID, request.m_position, false, request.m_volume);
+        voice.m_soundID         = request.m_soundID;
+        voice.m_priority        = request.m_priority;
+        voice.m_emitterID       = request.m_emitterID;
+        voice.m_distanceSquared = request.m_distanceSquared;
+        m_voices.push_back(voice);
+    }
+    m_requests.clear();
+}
+
+int AudioVoiceManager::GetNumVoices() const
+{
+    return static_cast<int>(m_voices.size());
+}
+
+void AudioVoiceManager::ReapFinishedVoices()
+{
+    for (int i = static_cast<int>(m_voices.size()) - 1; i >= 0; i--)
+    {
+        if (!g_theAudio->IsPlaying(m_voices[i].m_playbackID))
+        {
+            m_voices[i] = m_voices.back();
+            m_voices.pop_back();
+        }
+    }
+}
+
+void AudioVoiceManager::CoalesceRequests()
+{
+    /// A shotgun volley or a splash hitting a crowd asks for the same sound many times on the same spot, one voice is
+    /// enough. The merged request keeps the highest priority and the loudest volume
+    float coalesceDistanceSquared = m_config.m_coalesceDistance * m_config.m_coalesceDistance;
+    for (int i = 0; i < static_cast<int>(m_requests.size()); i++)
+    {
+        for (int j = static_cast<int>(m_requests.size()) - 1; j > i; j--)
+        {
+            VoiceRequest& kept   = m_requests[i];
+            VoiceRequest& merged = m_requests[j];
+            if (merged.m_soundID != kept.m_soundID || GetDistanceSquared3D(merged.m_position, kept.m_position) > coalesceDistanceSquared)
+                continue;
+            if (merged.m_priority > kept.m_priority)
+                kept.m_priority = merged.m_priority;
+            if (merged.m_volume > kept.m_volume)
+                kept.m_volume = merged.m_volume;
+            if (kept.m_emitterID != merged.m_emitterID)
+                kept.m_emitterID = 0; // Several emitters, none of them owns the voice.
+            m_requests[j] = m_requests.back();
+            m_requests.pop_back();
+            m_numCoalesced++;
+        }
+    }
+}
+
+float AudioVoiceManager::GetNearestListenerDistanceSquared(const Vec3& position) const
+{
+    if (m_listenerPositions.empty())
+        return 0.f; // Nobody listens in 3D yet, never cull.
+    float nearestDistanceSquared = FLT_MAX;
+    for (const Vec3& listenerPosition : m_listenerPositions)
+    {
+        float distanceSquared = GetDistanceSquared3D(position, listenerPosition);
+        if (distanceSquared < nearestDistanceSquared)
+            nearestDistanceSquared = distanceSquared;
+    }
+    return nearestDistanceSquared;
+}
+
+int AudioVoiceManager::FindVoiceToSteal(const VoiceRequest& request, bool bSameSoundOnly) const
+{
+    /// The victim is the least important voice, the farthest among equals. It must not outrank the request, and at
+    /// equal priority it must be farther away than the request
+    int victimIndex = -1;
+    for (int i = 0; i < static_cast<int>(m_voices.size()); i++)
+    {
+        const Voice& voice = m_voices[i];
+        if (bSameSoundOnly && voice.m_soundID != request.m_soundID)
+            continue;
+        if (voice.m_priority > request.m_priority)
+            continue;
+        if (voice.m_priority == request.m_priority && voice.m_distanceSquared <= request.m_distanceSquared)
+            continue;
+        if (victimIndex < 0)
+        {
+            victimIndex = i;
+            continue;
+        }
+        const Voice& victim = m_voices[victimIndex];
+        if (voice.m_priority < victim.m_priority || (voice.m_priority == victim.m_priority && voice.m_distanceSquared > victim.m_distanceSquared))
+            victimIndex = i;
+    }
+    return victimIndex;
+}
+
+int AudioVoiceManager::CountVoices(SoundID soundID) const
+{
+    int count = 0;
+    for (const Voice& voice : m_voices)
+    {
+        if (voice.m_soundID == soundID)
+            count++;
+    }
+    return count;
+}
+
+bool AudioVoiceManager::IsEmitterPlaying(SoundID soundID, unsigned int emitterID) const
+{
+    for (const Voice& voice : m_voices)
+    {
+        if (voice.m_soundID == soundID && voice.m_emitterID == emitterID)
+            return true;
+    }
+    return false;
+}
+
+void AudioVoiceManager::StopVoice(int voiceIndex)
+{
+    g_theAudio->StopSound(m_voices[voiceIndex].m_playbackID);
+    m_voices[voiceIndex] = m_voices.back();
+    m_voices.pop_back();
+}
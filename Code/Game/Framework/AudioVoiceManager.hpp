@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <vector>
+
+#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+enum class SoundPriority : unsigned char
+{
+    LOW,
+    NORMAL,
+    HIGH, // Never stolen by a lower priority, e.g. deaths and the local player weapons.
+};
+
+struct AudioVoiceConfig
+{
+    int   m_maxVoices         = 32; // 3D voices playing at once over every sound.
+    int   m_maxVoicesPerSound = 4; // Voices of the same SoundID playing at once.
+    float m_cullDistance      = 40.f; // Requests farther than this from every listener are dropped, in world units.
+    float m_coalesceDistance  = 1.f; // Requests of the same sound closer than this within one frame start one voice.
+};
+
+/// Every 3D sound start of the game goes through here instead of AudioSystem::StartSoundAt. Requests are only queued,
+/// the whole frame is resolved at once in Update: requests of the same sound close together are merged, the ones out
+/// of range of every split screen listener are culled, then the rest start nearest and most important first under the
+/// per sound and total voice caps, stealing a playing voice of lower priority when a cap is full.
+class AudioVoiceManager
+{
+public:
+    void Startup(const AudioVoiceConfig& config);
+    void Shutdown(); // Forget every voice, the audio system shuts down first and stops them.
+
+    /// Queue a 3D sound for this frame.
+    /// @param emitterID Id of the emitter, usually the actor handle data, 0 for none. An emitter never plays the same
+    /// sound twice at once, a request while its voice is still playing is dropped.
+    void RequestSoundAt(SoundID soundID, const Vec3& position, SoundPriority priority = SoundPriority::NORMAL, unsigned int emitterID = 0, float volume = 10.f);
+    void SetNumListeners(int numListeners);
+    void SetListenerPosition(int listenerIndex, const Vec3& position);
+    void Update(); // Reap the finished voices and resolve the requests of the frame.
+
+    int GetNumVoices() const;
+
+private:
+    struct VoiceRequest
+    {
+        SoundID       m_soundID = 0;
+        Vec3          m_position;
+        SoundPriority m_priority        = SoundPriority::NORMAL;
+        unsigned int  m_emitterID       = 0;
+        float         m_volume          = 10.f;
+        float         m_distanceSquared = 0.f; // To the nearest listener.
+    };
+
+    struct Voice
+    {
+        SoundPlaybackID m_playbackID = 0;
+        SoundID         m_soundID    = 0;
+        SoundPriority   m_priority   = SoundPriority::NORMAL;
+        unsigned int    m_emitterID  = 0;
+        float           m_distanceSquared = 0.f; // To the nearest listener when it started.
+    };
+
+    void  ReapFinishedVoices();
+    void  CoalesceRequests();
+    float GetNearestListenerDistanceSquared(const Vec3& position) const;
+    /// Index of the voice the request may replace, -1 if every candidate is more important.
+    /// @param bSameSoundOnly Only look at the voices of the request sound, for the per sound cap.
+    int  FindVoiceToSteal(const VoiceRequest& request, bool bSameSoundOnly) const;
+    int  CountVoices(SoundID soundID) const;
+    bool IsEmitterPlaying(SoundID soundID, unsigned int emitterID) const;
+    void StopVoice(int voiceIndex);
+
+    AudioVoiceConfig          m_config;
+    std::vector<VoiceRequest> m_requests; // Queued this frame.
+    std::vector<Voice>        m_voices;
+    std::vector<Vec3>         m_listenerPositions;
+
+    /// Totals since Startup, logged on shutdown
+    int m_numRequested = 0;
+    int m_numCoalesced = 0;
+    int m_numCulled    = 0;
+    int m_numStolen    = 0;
+    int m_numDropped   = 0;
+};
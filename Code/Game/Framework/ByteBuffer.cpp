@@ -0,0 +1,117 @@
+﻿#include "ByteBuffer.hpp"
+
+#include <fstream>
+
+void ByteBufferWriter::WriteString(const std::string& value)
+{
+    Write(static_cast<unsigned int>(value.size()));
+    WriteBytes(value.data(), value.size());
+}
+
+void ByteBufferWriter::WriteBytes(const void* data, size_t numBytes)
+{
+    if (numBytes == 0)
+        return;
+    size_t oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + numBytes);
+    memcpy(m_buffer.data() + oldSize, data, numBytes);
+}
+
+void ByteBufferWriter::Clear()
+{
+    m_buffer.clear();
+}
+
+const std::vector<unsigned char>& ByteBufferWriter::GetBuffer() const
+{
+    return m_buffer;
+}
+
+size_t ByteBufferWriter::GetSize() const
+{
+    return m_buffer.size();
+}
+
+ByteBufferReader::ByteBufferReader(const unsigned char* data, size_t size): m_data(data), m_size(size)
+{
+}
+
+ByteBufferReader::ByteBufferReader(const std::vector<unsigned char>& buffer): m_data(buffer.data()), m_size(buffer.size())
+{
+}
+
+bool ByteBufferReader::ReadString(std::string& outValue)
+{
+    unsigned int length = 0;
+    if (!Read(length) || length > GetRemainingSize())
+    {
+        m_bIsValid = false;
+        outValue.clear();
+        return false;
+    }
+    outValue.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+    m_offset += length;
+    return true;
+}
+
+std::string ByteBufferReader::ReadString()
+{
+    std::string value;
+    ReadString(value);
+    return value;
+}
+
+bool ByteBufferReader::ReadBytes(void* outData, size_t numBytes)
+{
+    if (!m_bIsValid || numBytes > GetRemainingSize())
+    {
+        m_bIsValid = false;
+        memset(outData, 0, numBytes);
+        return false;
+    }
+    memcpy(outData, m_data + m_offset, numBytes);
+    m_offset += numBytes;
+    return true;
+}
+
+bool ByteBufferReader::IsValid() const
+{
+    return m_bIsValid;
+}
+
+bool ByteBufferReader::IsAtEnd() const
+{
+    return m_offset >= m_size;
+}
+
+size_t ByteBufferReader::GetOffset() const
+{
+    return m_offset;
+}
+
+size_t ByteBufferReader::GetRemainingSize() const
+{
+    return m_size - m_offset;
+}
+
+bool ReadBinaryFileToBuffer(std::vector<unsigned char>& outBuffer, const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    outBuffer.resize(static_cast<size_t>(size));
+    if (size > 0)
+        file.read(reinterpret_cast<char*>(outBuffer.data()), size);
+    return file.good() || file.eof();
+}
+
+bool WriteBufferToBinaryFile(const std::vector<unsigned char>& buffer, const std::string& filePath)
+{
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return file.good();
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// Append only little endian byte buffer used by every binary format of the game (input replays, snapshots, saves and
+/// cooked definitions). Values are copied raw, so only trivially copyable types and strings can be written.
+class ByteBufferWriter
+{
+public:
+    template <typename T>
+    void Write(const T& value);
+    void WriteString(const std::string& value);
+    void WriteBytes(const void* data, size_t numBytes);
+    void Clear();
+
+    const std::vector<unsigned char>& GetBuffer() const;
+    size_t                            GetSize() const;
+
+private:
+    std::vector<unsigned char> m_buffer;
+};
+
+/// Sequential reader over a byte range that is owned by the caller. Reading past the end never touches memory outside
+/// the range, it zero fills the output and flags the reader as invalid instead.
+class ByteBufferReader
+{
+public:
+    ByteBufferReader(const unsigned char* data, size_t size);
+    explicit ByteBufferReader(const std::vector<unsigned char>& buffer);
+
+    template <typename T>
+    bool        Read(T& outValue);
+    template <typename T>
+    T           Read();
+    bool        ReadString(std::string& outValue);
+    std::string ReadString();
+    bool        ReadBytes(void* outData, size_t numBytes);
+
+    bool   IsValid() const; // False once any read ran past the end of the range.
+    bool   IsAtEnd() const;
+    size_t GetOffset() const;
+    size_t GetRemainingSize() const;
+
+private:
+    const unsigned char* m_data     = nullptr;
+    size_t               m_size     = 0;
+    size_t               m_offset   = 0;
+    bool                 m_bIsValid = true;
+};
+
+/// Read a whole file into outBuffer, return false if the file could not be opened.
+bool ReadBinaryFileToBuffer(std::vector<unsigned char>& outBuffer, const std::string& filePath);
+/// Write the buffer to the file, replacing it. Return false if the file could not be opened.
+bool WriteBufferToBinaryFile(const std::vector<unsigned char>& buffer, const std::string& filePath);
+
+template <typename T>
+void ByteBufferWriter::Write(const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ByteBufferWriter::Write only supports trivially copyable types");
+    WriteBytes(&value, sizeof(T));
+}
+
+template <typename T>
+bool ByteBufferReader::Read(T& outValue)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ByteBufferReader::Read only supports trivially copyable types");
+    return ReadBytes(&outValue, sizeof(T));
+}
+
+template <typename T>
+T ByteBufferReader::Read()
+{
+    T value{};
+    Read(value);
+    return value;
+}
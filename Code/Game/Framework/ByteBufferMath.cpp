@@ -0,0 +1,95 @@
+﻿#include "ByteBufferMath.hpp"
+
+#include "ByteBuffer.hpp"
+
+void WriteVec2(ByteBufferWriter& writer, const Vec2& value)
+{
+    writer.Write(value.x);
+    writer.Write(value.y);
+}
+
+Vec2 ReadVec2(ByteBufferReader& reader)
+{
+    Vec2 value;
+    reader.Read(value.x);
+    reader.Read(value.y);
+    return value;
+}
+
+void WriteVec3(ByteBufferWriter& writer, const Vec3& value)
+{
+    writer.Write(value.x);
+    writer.Write(value.y);
+    writer.Write(value.z);
+}
+
+Vec3 ReadVec3(ByteBufferReader& reader)
+{
+    Vec3 value;
+    reader.Read(value.x);
+    reader.Read(value.y);
+    reader.Read(value.z);
+    return value;
+}
+
+void WriteIntVec2(ByteBufferWriter& writer, const IntVec2& value)
+{
+    writer.Write(value.x);
+    writer.Write(value.y);
+}
+
+IntVec2 ReadIntVec2(ByteBufferReader& reader)
+{
+    IntVec2 value;
+    reader.Read(value.x);
+    reader.Read(value.y);
+    return value;
+}
+
+void WriteEulerAngles(ByteBufferWriter& writer, const EulerAngles& value)
+{
+    writer.Write(value.m_yawDegrees);
+    writer.Write(value.m_pitchDegrees);
+    writer.Write(value.m_rollDegrees);
+}
+
+EulerAngles ReadEulerAngles(ByteBufferReader& reader)
+{
+    EulerAngles value;
+    reader.Read(value.m_yawDegrees);
+    reader.Read(value.m_pitchDegrees);
+    reader.Read(value.m_rollDegrees);
+    return value;
+}
+
+void WriteFloatRange(ByteBufferWriter& writer, const FloatRange& value)
+{
+    writer.Write(value.m_min);
+    writer.Write(value.m_max);
+}
+
+FloatRange ReadFloatRange(ByteBufferReader& reader)
+{
+    FloatRange value;
+    reader.Read(value.m_min);
+    reader.Read(value.m_max);
+    return value;
+}
+
+void WriteRgba8(ByteBufferWriter& writer, const Rgba8& value)
+{
+    writer.Write(value.r);
+    writer.Write(value.g);
+    writer.Write(value.b);
+    writer.Write(value.a);
+}
+
+Rgba8 ReadRgba8(ByteBufferReader& reader)
+{
+    Rgba8 value;
+    reader.Read(value.r);
+    reader.Read(value.g);
+    reader.Read(value.b);
+    reader.Read(value.a);
+    return value;
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/FloatRange.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+class ByteBufferWriter;
+class ByteBufferReader;
+
+/// Engine math types are not trivially copyable, every binary format writes them component wise through these.
+void        WriteVec2(ByteBufferWriter& writer, const Vec2& value);
+Vec2        ReadVec2(ByteBufferReader& reader);
+void        WriteVec3(ByteBufferWriter& writer, const Vec3& value);
+Vec3        ReadVec3(ByteBufferReader& reader);
+void        WriteIntVec2(ByteBufferWriter& writer, const IntVec2& value);
+IntVec2     ReadIntVec2(ByteBufferReader& reader);
+void        WriteEulerAngles(ByteBufferWriter& writer, const EulerAngles& value);
+EulerAngles ReadEulerAngles(ByteBufferReader& reader);
+void        WriteFloatRange(ByteBufferWriter& writer, const FloatRange& value);
+FloatRange  ReadFloatRange(ByteBufferReader& reader);
+void        WriteRgba8(ByteBufferWriter& writer, const Rgba8& value);
+Rgba8       ReadRgba8(ByteBufferReader& reader);
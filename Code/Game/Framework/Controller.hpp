@@ -17,7 +17,6 @@ public:
     ActorHandle  m_actorHandle; // Handle of our currently possessed actor or INVALID if no actor is possessed.
     Map*         m_map   = nullptr; // Reference to the current map for purposes of dereferencing actor handles.
     int          m_index = -1;
-    std::string  m_state = "None"; // Track for state
     virtual void Update(float deltaTime);
     /// Unpossess any currently possessed actor and possess a new one. Notify each actor so it can check for
     /// restoring AI controllers or handling other changes of possession logic.
@@ -0,0 +1,123 @@
+﻿#include "FrameArena.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "Game/GameCommon.hpp"
+
+static std::atomic<size_t> s_numHeapAllocations{0};
+
+#ifdef COUNT_HEAP_ALLOCATIONS
+void* operator new(size_t numBytes)
+{
+    s_numHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(numBytes == 0 ? 1 : numBytes))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
+
+size_t GetNumHeapAllocations()
+{
+    return s_numHeapAllocations.load(std::memory_order_relaxed);
+}
+
+FrameArena::~FrameArena()
+{
+    Shutdown();
+}
+
+void FrameArena::Startup(size_t capacityBytes)
+{
+    Shutdown();
+    m_capacityBytes = capacityBytes;
+    m_block         = new unsigned char[m_capacityBytes];
+    printf("FrameArena::Startup    %llu KB\n", static_cast<unsigned long long>(m_capacityBytes / 1024));
+}
+
+void FrameArena::Shutdown()
+{
+    Reset();
+    delete[] m_block;
+    m_block         = nullptr;
+    m_capacityBytes = 0;
+}
+
+void* FrameArena::Allocate(size_t numBytes, size_t alignment)
+{
+    size_t alignedOffset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (m_block && alignedOffset + numBytes <= m_capacityBytes)
+    {
+        m_offset = alignedOffset + numBytes;
+        return m_block + alignedOffset;
+    }
+    /// Spill, operator new[] aligns to the largest fundamental alignment which covers every frame container
+    unsigned char* overflowBlock = new unsigned char[numBytes];
+    m_overflowBlocks.push_back(overflowBlock);
+    m_overflowBytes += numBytes;
+    return overflowBlock;
+}
+
+void FrameArena::Reset()
+{
+    size_t usedBytes = m_offset + m_overflowBytes;
+    if (usedBytes > m_peakBytes)
+        m_peakBytes = usedBytes;
+    for (unsigned char* overflowBlock : m_overflowBlocks)
+    {
+        delete[] overflowBlock;
+    }
+    m_overflowBlocks.clear();
+    m_offset = 0;
+    if (m_overflowBytes > 0)
+    {
+        /// Grow once so the next frame of the same size fits the block
+        m_numOverflows++;
+        m_overflowBytes = 0;
+        delete[] m_block;
+        m_capacityBytes = m_peakBytes + m_peakBytes / 2;
+        m_block         = new unsigned char[m_capacityBytes];
+        printf("FrameArena::Reset    Frame overflowed, block grown to %llu KB\n", static_cast<unsigned long long>(m_capacityBytes / 1024));
+    }
+}
+
+size_t FrameArena::GetMarker() const
+{
+    return m_offset;
+}
+
+void FrameArena::Rewind(size_t marker)
+{
+    if (marker < m_offset)
+    {
+        if (m_offset + m_overflowBytes > m_peakBytes)
+            m_peakBytes = m_offset + m_overflowBytes;
+        m_offset = marker;
+    }
+}
+
+size_t FrameArena::GetCapacityBytes() const
+{
+    return m_capacityBytes;
+}
+
+size_t FrameArena::GetPeakBytes() const
+{
+    return m_peakBytes;
+}
+
+int FrameArena::GetNumOverflows() const
+{
+    return m_numOverflows;
+}
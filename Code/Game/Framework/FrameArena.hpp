@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+
+/// Linear allocator for memory that only lives until the end of the frame. Allocating bumps an offset, freeing does
+/// nothing, Reset rewinds everything at once. A frame that asks for more than the block holds spills into heap blocks
+/// and the next Reset grows the block to the peak, so a steady state frame allocates nothing from the heap.
+/// Main thread only.
+class FrameArena
+{
+public:
+    FrameArena() = default;
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    ~FrameArena();
+
+    void  Startup(size_t capacityBytes);
+    void  Shutdown();
+    void* Allocate(size_t numBytes, size_t alignment);
+    void  Reset(); // Every allocation of the frame becomes invalid.
+    /// Rewind to an earlier marker, every allocation made in the block since becomes invalid.
+    size_t GetMarker() const;
+    void   Rewind(size_t marker);
+
+    size_t GetCapacityBytes() const;
+    size_t GetPeakBytes() const; // Most bytes a single frame used since startup.
+    int    GetNumOverflows() const; // Frames that did not fit the block.
+
+private:
+    unsigned char*              m_block         = nullptr;
+    size_t                      m_capacityBytes = 0;
+    size_t                      m_offset        = 0;
+    size_t                      m_overflowBytes = 0; // Spilled this frame.
+    size_t                      m_peakBytes     = 0;
+    int                         m_numOverflows  = 0;
+    std::vector<unsigned char*> m_overflowBlocks;
+};
+
+/// Give the block space back when a function called many times per frame returns, its frame containers must be
+/// declared after the scope so they are destroyed first.
+class FrameArenaScope
+{
+public:
+    explicit FrameArenaScope(FrameArena& arena) : m_arena(arena), m_marker(arena.GetMarker())
+    {
+    }
+
+    ~FrameArenaScope()
+    {
+        m_arena.Rewind(m_marker);
+    }
+
+    FrameArenaScope(const FrameArenaScope&)            = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+
+private:
+    FrameArena& m_arena;
+    size_t      m_marker = 0;
+};
+
+/// STL allocator drawing from a frame arena, containers using it must not outlive the frame.
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    explicit FrameAllocator(FrameArena& arena) : m_arena(&arena)
+    {
+    }
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.m_arena)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return m_arena == other.m_arena; }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return m_arena != other.m_arena; }
+
+    FrameArena* m_arena = nullptr;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+/// Global operator new calls since startup, counted when COUNT_HEAP_ALLOCATIONS is defined in GameCommon.hpp.
+size_t GetNumHeapAllocations();
@@ -1,22 +1,24 @@
 ﻿#include "Hud.hpp"
 
+#include <algorithm>
+
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 
 Hud::Hud(const XmlElement& hudElement)
 {
     m_shaderName           = ParseXmlAttribute(hudElement, "shader", m_shaderName);
-    m_shader               = g_theRenderer->CreateShaderFromFile(m_shaderName.c_str(), VertexType::Vertex_PCU);
     m_reticleSize          = ParseXmlAttribute(hudElement, "reticleSize", m_reticleSize);
     m_spriteSize           = ParseXmlAttribute(hudElement, "spriteSize", m_spriteSize);
     m_spritePivot          = ParseXmlAttribute(hudElement, "spritePivot", m_spritePivot);
     m_baseTexturePath      = ParseXmlAttribute(hudElement, "baseTexture", m_baseTexturePath);
     m_m_reticleTexturePath = ParseXmlAttribute(hudElement, "reticleTexture", m_m_reticleTexturePath);
-
-    m_baseTexture    = g_theRenderer->CreateTextureFromFile(m_baseTexturePath.c_str());
-    m_reticleTexture = g_theRenderer->CreateTextureFromFile(m_m_reticleTexturePath.c_str());
+    RequestAssets();
 
     if (hudElement.ChildElementCount() > 0)
     {
@@ -28,12 +30,77 @@ Hud::Hud(const XmlElement& hudElement)
             element = element->NextSiblingElement();
         }
     }
+    ResolveAnimationStates();
     printf("Hud::Hud    Create Hud with base texture: %s\n", m_baseTexturePath.c_str());
 }
 
-Hud::~Hud()
+Hud::Hud(ByteBufferReader& reader)
+{
+    m_shaderName           = reader.ReadString();
+    m_reticleSize          = ReadIntVec2(reader);
+    m_spriteSize           = ReadIntVec2(reader);
+    m_spritePivot          = ReadVec2(reader);
+    m_baseTexturePath      = reader.ReadString();
+    m_m_reticleTexturePath = reader.ReadString();
+    RequestAssets();
+    unsigned int numAnimations = reader.Read<unsigned int>();
+    m_animations.reserve(std::min(static_cast<size_t>(numAnimations), reader.GetRemainingSize())); // A corrupted count can not reserve more than the file holds.
+    for (unsigned int i = 0; i < numAnimations && reader.IsValid(); i++)
+    {
+        m_animations.emplace_back(reader);
+    }
+    ResolveAnimationStates();
+}
+
+void Hud::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_shaderName);
+    WriteIntVec2(writer, m_reticleSize);
+    WriteIntVec2(writer, m_spriteSize);
+    WriteVec2(writer, m_spritePivot);
+    writer.WriteString(m_baseTexturePath);
+    writer.WriteString(m_m_reticleTexturePath);
+    writer.Write(static_cast<unsigned int>(m_animations.size()));
+    for (const Animation& animation : m_animations)
+    {
+        animation.Cook(writer);
+    }
+}
+
+void Hud::ResolveAssets()
+{
+    m_baseTexture    = m_baseTextureAsset.GetTexture();
+    m_reticleTexture = m_reticleTextureAsset.GetTexture();
+    m_spriteOffset   = -Vec2(m_spriteSize) * m_spritePivot;
+    if (m_reticleTexture)
+        m_reticleDimensions = Vec2(m_reticleTexture->GetDimensions());
+    for (Animation& animation : m_animations)
+    {
+        animation.ResolveAssets();
+    }
+}
+
+void Hud::ReleaseAssets()
+{
+    for (Animation& animation : m_animations)
+    {
+        animation.ReleaseAssets();
+    }
+    g_theResourceSubsystem->ReleaseShader(m_shader);
+    g_theResourceSubsystem->ReleaseAsset(m_baseTextureAsset);
+    g_theResourceSubsystem->ReleaseAsset(m_reticleTextureAsset);
+    m_shader              = nullptr;
+    m_baseTexture         = nullptr;
+    m_reticleTexture      = nullptr;
+    m_baseTextureAsset    = AssetHandle();
+    m_reticleTextureAsset = AssetHandle();
+}
+
+void Hud::RequestAssets()
 {
-    POINTER_SAFE_DELETE(m_shader)
+    m_shader              = g_theResourceSubsystem->AcquireShader(m_shaderName, VertexType::Vertex_PCU);
+    m_baseTextureAsset    = g_theResourceSubsystem->RequestTexture(m_baseTexturePath);
+    m_reticleTextureAsset = g_theResourceSubsystem->RequestTexture(m_m_reticleTexturePath);
 }
 
 Animation* Hud::GetAnimationByName(const std::string& animationName)
@@ -48,6 +115,22 @@ Animation* Hud::GetAnimationByName(const std::string& animationName)
     return nullptr;
 }
 
+Animation* Hud::GetAnimation(int animationId)
+{
+    if (animationId < 0 || animationId >= static_cast<int>(m_animations.size()))
+        return nullptr;
+    return &m_animations[animationId];
+}
+
+void Hud::ResolveAnimationStates()
+{
+    m_animationStates.Clear();
+    for (int animationId = 0; animationId < static_cast<int>(m_animations.size()); animationId++)
+    {
+        m_animationStates.SetAnimation(GetAnimationStateByName(m_animations[animationId].m_name), animationId);
+    }
+}
+
 std::vector<Animation>& Hud::GetAnimations()
 {
     return m_animations;
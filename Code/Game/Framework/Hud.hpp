@@ -2,18 +2,26 @@
 #include <vector>
 
 #include "Animation.hpp"
+#include "AnimationState.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Math/Vec2.hpp"
+#include "Game/Framework/AssetLoader.hpp"
 
 class Texture;
 class Shader;
+class ByteBufferWriter;
+class ByteBufferReader;
 
 class Hud
 {
 public:
     Hud(const XmlElement& hudElement);
-    ~Hud();
+    explicit Hud(ByteBufferReader& reader);
+    void                    Cook(ByteBufferWriter& writer) const;
+    void                    ResolveAssets(); // Pick the textures and resolve the animations once they are loaded.
+    void                    ReleaseAssets();
     Animation*              GetAnimationByName(const std::string& animationName);
+    Animation*              GetAnimation(int animationId); // Null for ANIMATION_ID_NONE.
     std::vector<Animation>& GetAnimations();
     std::string             m_name           = "Default";
     Shader*                 m_shader         = nullptr;
@@ -22,10 +30,18 @@ public:
     IntVec2                 m_reticleSize;
     IntVec2                 m_spriteSize;
     Vec2                    m_spritePivot;
+    Vec2                    m_spriteOffset; // -m_spriteSize * m_spritePivot.
+    Vec2                    m_reticleDimensions; // Of the reticle texture, known once the assets resolved.
+    AnimationStateMachine   m_animationStates; // Animation of every state, resolved by name at load.
 
 private:
+    void RequestAssets(); // Queue the textures and create the shader from the parsed paths.
+    void ResolveAnimationStates();
+
     std::string            m_shaderName           = "Default";
     std::string            m_baseTexturePath      = "";
     std::string            m_m_reticleTexturePath = "";
+    AssetHandle            m_baseTextureAsset;
+    AssetHandle            m_reticleTextureAsset;
     std::vector<Animation> m_animations;
 };
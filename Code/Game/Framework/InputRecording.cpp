@@ -0,0 +1,207 @@
+﻿#include "InputRecording.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+
+InputRecorder::InputRecorder(const std::string& filePath, const InputRecordingHeader& header): m_filePath(filePath)
+{
+    m_file.open(filePath, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        printf("InputRecorder::InputRecorder    Failed to open \"%s\" for recording\n", filePath.c_str());
+        return;
+    }
+    m_writer.Write(INPUT_RECORDING_MAGIC);
+    m_writer.Write(INPUT_RECORDING_VERSION);
+    m_writer.Write(header.m_randomSeed);
+    m_writer.WriteString(header.m_mapName);
+    m_writer.Write(static_cast<unsigned int>(header.m_players.size()));
+    for (const InputRecordingPlayer& player : header.m_players)
+    {
+        m_writer.Write(player.m_index);
+        m_writer.Write(static_cast<int>(player.m_deviceType));
+    }
+    printf("InputRecorder::InputRecorder    Recording input to \"%s\", seed %llu\n", filePath.c_str(), header.m_randomSeed);
+}
+
+InputRecorder::~InputRecorder()
+{
+    Flush();
+    if (m_file.is_open())
+        m_file.close();
+    printf("InputRecorder::~InputRecorder    Recorded %d frames to \"%s\"\n", m_numFrames, m_filePath.c_str());
+}
+
+void InputRecorder::BeginFrame(float realDeltaSeconds, float simulationDeltaSeconds)
+{
+    m_realDeltaSeconds       = realDeltaSeconds;
+    m_simulationDeltaSeconds = simulationDeltaSeconds;
+    m_frameCommands.clear();
+}
+
+void InputRecorder::RecordCommand(int playerIndex, const PlayerCommand& command)
+{
+    m_frameCommands.push_back(RecordedPlayerCommand{playerIndex, command});
+}
+
+void InputRecorder::EndFrame()
+{
+    if (!m_file.is_open())
+        return;
+    m_writer.Write(m_realDeltaSeconds);
+    m_writer.Write(m_simulationDeltaSeconds);
+    m_writer.Write(static_cast<unsigned char>(m_frameCommands.size()));
+    for (const RecordedPlayerCommand& recorded : m_frameCommands)
+    {
+        m_writer.Write(static_cast<signed char>(recorded.m_playerIndex));
+        recorded.m_command.Write(m_writer);
+    }
+    m_frameCommands.clear();
+    ++m_numFrames;
+    if (m_writer.GetSize() >= FLUSH_THRESHOLD_BYTES)
+        Flush();
+}
+
+void InputRecorder::Flush()
+{
+    if (!m_file.is_open() || m_writer.GetSize() == 0)
+        return;
+    m_file.write(reinterpret_cast<const char*>(m_writer.GetBuffer().data()), static_cast<std::streamsize>(m_writer.GetSize()));
+    m_file.flush();
+    m_writer.Clear();
+}
+
+bool InputRecorder::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+int InputRecorder::GetNumFrames() const
+{
+    return m_numFrames;
+}
+
+InputReplayer::InputReplayer(const std::string& filePath): m_filePath(filePath)
+{
+    if (!ReadBinaryFileToBuffer(m_fileBuffer, filePath))
+    {
+        printf("InputReplayer::InputReplayer    Failed to open \"%s\"\n", filePath.c_str());
+        return;
+    }
+    m_reader = ByteBufferReader(m_fileBuffer);
+
+    unsigned int magic   = m_reader.Read<unsigned int>();
+    unsigned int version = m_reader.Read<unsigned int>();
+    if (magic != INPUT_RECORDING_MAGIC || version != INPUT_RECORDING_VERSION)
+    {
+        printf("InputReplayer::InputReplayer    \"%s\" is not an input recording of version %u\n", filePath.c_str(), INPUT_RECORDING_VERSION);
+        return;
+    }
+    m_reader.Read(m_header.m_randomSeed);
+    m_reader.ReadString(m_header.m_mapName);
+    unsigned int numPlayers = m_reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numPlayers && m_reader.IsValid(); ++i)
+    {
+        InputRecordingPlayer player;
+        player.m_index      = m_reader.Read<int>();
+        player.m_deviceType = static_cast<DeviceType>(m_reader.Read<int>());
+        m_header.m_players.push_back(player);
+    }
+    m_bIsValid = m_reader.IsValid();
+    printf("InputReplayer::InputReplayer    Replaying \"%s\" on map %s, seed %llu, %u players\n", filePath.c_str(), m_header.m_mapName.c_str(), m_header.m_randomSeed, numPlayers);
+}
+
+bool InputReplayer::IsValid() const
+{
+    return m_bIsValid;
+}
+
+const InputRecordingHeader& InputReplayer::GetHeader() const
+{
+    return m_header;
+}
+
+bool InputReplayer::ReadFrame(float& outRealDeltaSeconds, float& outSimulationDeltaSeconds)
+{
+    m_frameCommands.clear();
+    if (!m_bIsValid || m_reader.IsAtEnd())
+        return false;
+
+    float         realDeltaSeconds       = m_reader.Read<float>();
+    float         simulationDeltaSeconds = m_reader.Read<float>();
+    unsigned char numCommands            = m_reader.Read<unsigned char>();
+    for (unsigned char i = 0; i < numCommands; ++i)
+    {
+        RecordedPlayerCommand recorded;
+        recorded.m_playerIndex = m_reader.Read<signed char>();
+        recorded.m_command.Read(m_reader);
+        m_frameCommands.push_back(recorded);
+    }
+    if (!m_reader.IsValid())
+    {
+        printf("InputReplayer::ReadFrame    Recording is truncated at frame %d\n", m_frameIndex + 1);
+        m_bIsValid = false;
+        m_frameCommands.clear();
+        return false;
+    }
+
+    ++m_frameIndex;
+    outRealDeltaSeconds       = realDeltaSeconds;
+    outSimulationDeltaSeconds = simulationDeltaSeconds;
+    m_frameStartTime          = GetCurrentTimeSeconds();
+
+    ReplayFrameTiming timing;
+    timing.m_frameIndex             = m_frameIndex;
+    timing.m_realDeltaSeconds       = realDeltaSeconds;
+    timing.m_simulationDeltaSeconds = simulationDeltaSeconds;
+    m_frameTimings.push_back(timing);
+    return true;
+}
+
+bool InputReplayer::GetCommand(int playerIndex, PlayerCommand& outCommand) const
+{
+    for (const RecordedPlayerCommand& recorded : m_frameCommands)
+    {
+        if (recorded.m_playerIndex == playerIndex)
+        {
+            outCommand = recorded.m_command;
+            return true;
+        }
+    }
+    outCommand = PlayerCommand();
+    return false;
+}
+
+void InputReplayer::EndFrame()
+{
+    if (m_frameTimings.empty() || m_frameTimings.back().m_frameIndex != m_frameIndex)
+        return;
+    m_frameTimings.back().m_frameSeconds = GetCurrentTimeSeconds() - m_frameStartTime;
+}
+
+int InputReplayer::GetFrameIndex() const
+{
+    return m_frameIndex;
+}
+
+void InputReplayer::WriteTimingLog(const std::string& filePath) const
+{
+    std::ofstream file(filePath, std::ios::trunc);
+    if (!file.is_open())
+    {
+        printf("InputReplayer::WriteTimingLog    Failed to open \"%s\"\n", filePath.c_str());
+        return;
+    }
+    double totalSeconds = 0.0;
+    double worstSeconds = 0.0;
+    file << "frame,realDeltaSeconds,simulationDeltaSeconds,frameMilliseconds\n";
+    for (const ReplayFrameTiming& timing : m_frameTimings)
+    {
+        file << timing.m_frameIndex << ',' << timing.m_realDeltaSeconds << ',' << timing.m_simulationDeltaSeconds << ',' << timing.m_frameSeconds * 1000.0 << '\n';
+        totalSeconds += timing.m_frameSeconds;
+        worstSeconds = timing.m_frameSeconds > worstSeconds ? timing.m_frameSeconds : worstSeconds;
+    }
+    double averageMilliseconds = m_frameTimings.empty() ? 0.0 : totalSeconds * 1000.0 / static_cast<double>(m_frameTimings.size());
+    printf("InputReplayer::WriteTimingLog    %d frames, average %.3f ms, worst %.3f ms, written to \"%s\"\n", static_cast<int>(m_frameTimings.size()), averageMilliseconds, worstSeconds * 1000.0,
+           filePath.c_str());
+}
@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ByteBuffer.hpp"
+#include "PlayerCommand.hpp"
+#include "Game/GameCommon.hpp"
+
+/// Binary layout of an input recording, all values little endian:
+///   header   magic, version, random seed, map name, player count, then index and device type of every player
+///   frame    real delta seconds, simulation delta seconds, command count, then player index and command of each
+/// Together with the map random seed the frames are enough to play a session back deterministically.
+static constexpr unsigned int INPUT_RECORDING_MAGIC   = 0x43524944u; // "DIRC"
+static constexpr unsigned int INPUT_RECORDING_VERSION = 2;
+
+struct InputRecordingPlayer
+{
+    int        m_index      = -1;
+    DeviceType m_deviceType = DeviceType::KEYBOARD_AND_MOUSE;
+};
+
+struct InputRecordingHeader
+{
+    unsigned long long                m_randomSeed = 0;
+    std::string                       m_mapName;
+    std::vector<InputRecordingPlayer> m_players;
+};
+
+struct RecordedPlayerCommand
+{
+    int           m_playerIndex = -1;
+    PlayerCommand m_command;
+};
+
+/// Write the per frame player commands of a session to a file. Frames are buffered in memory and flushed in chunks.
+class InputRecorder
+{
+public:
+    InputRecorder(const std::string& filePath, const InputRecordingHeader& header);
+    ~InputRecorder(); // Flush the pending frames and close the file.
+
+    void BeginFrame(float realDeltaSeconds, float simulationDeltaSeconds);
+    void RecordCommand(int playerIndex, const PlayerCommand& command);
+    void EndFrame();
+    void Flush();
+
+    bool IsOpen() const;
+    int  GetNumFrames() const;
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD_BYTES = 64 * 1024;
+
+    std::string                        m_filePath;
+    std::ofstream                      m_file;
+    ByteBufferWriter                   m_writer;
+    float                              m_realDeltaSeconds       = 0.f;
+    float                              m_simulationDeltaSeconds = 0.f;
+    std::vector<RecordedPlayerCommand> m_frameCommands;
+    int                                m_numFrames = 0;
+};
+
+/// Per frame cost measured while replaying, written out as the frame timing log.
+struct ReplayFrameTiming
+{
+    int    m_frameIndex             = 0;
+    float  m_realDeltaSeconds       = 0.f;
+    float  m_simulationDeltaSeconds = 0.f;
+    double m_frameSeconds           = 0.0; // Wall time from reading the frame to the end of the frame, update and render.
+};
+
+/// Play back a recording made by InputRecorder. The whole file is loaded up front so replaying never touches the disk.
+class InputReplayer
+{
+public:
+    InputReplayer(const std::string& filePath);
+
+    bool                        IsValid() const;
+    const InputRecordingHeader& GetHeader() const;
+    /// Advance to the next recorded frame, return false once the recording is exhausted.
+    bool ReadFrame(float& outRealDeltaSeconds, float& outSimulationDeltaSeconds);
+    /// Command of the player in the current frame, returns false and an empty command if the player recorded nothing.
+    bool GetCommand(int playerIndex, PlayerCommand& outCommand) const;
+    void EndFrame(); // Close the timing of the current frame.
+    int  GetFrameIndex() const;
+
+    void WriteTimingLog(const std::string& filePath) const; // CSV with one line per replayed frame.
+
+private:
+    std::string                        m_filePath;
+    std::vector<unsigned char>         m_fileBuffer;
+    ByteBufferReader                   m_reader = ByteBufferReader(nullptr, 0);
+    InputRecordingHeader               m_header;
+    bool                               m_bIsValid = false;
+    int                                m_frameIndex = -1;
+    std::vector<RecordedPlayerCommand> m_frameCommands;
+    std::vector<ReplayFrameTiming>     m_frameTimings;
+    double                             m_frameStartTime = 0.0;
+};
@@ -0,0 +1,40 @@
+﻿#include "PlayerCommand.hpp"
+
+#include "ByteBuffer.hpp"
+
+void PlayerCommand::SetButton(PlayerCommandButton button, bool bIsDown)
+{
+    if (bIsDown)
+        m_buttons |= static_cast<unsigned char>(button);
+    else
+        m_buttons &= static_cast<unsigned char>(~static_cast<unsigned char>(button));
+}
+
+bool PlayerCommand::IsButtonDown(PlayerCommandButton button) const
+{
+    return (m_buttons & static_cast<unsigned char>(button)) != 0;
+}
+
+void PlayerCommand::Write(ByteBufferWriter& writer) const
+{
+    writer.Write(m_moveIntent.x);
+    writer.Write(m_moveIntent.y);
+    writer.Write(m_yawDelta);
+    writer.Write(m_pitchDelta);
+    writer.Write(m_rollDelta);
+    writer.Write(m_buttons);
+    writer.Write(m_equipWeapon);
+    writer.Write(m_cycleWeapon);
+}
+
+void PlayerCommand::Read(ByteBufferReader& reader)
+{
+    reader.Read(m_moveIntent.x);
+    reader.Read(m_moveIntent.y);
+    reader.Read(m_yawDelta);
+    reader.Read(m_pitchDelta);
+    reader.Read(m_rollDelta);
+    reader.Read(m_buttons);
+    reader.Read(m_equipWeapon);
+    reader.Read(m_cycleWeapon);
+}
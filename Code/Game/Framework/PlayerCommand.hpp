@@ -0,0 +1,35 @@
+﻿#pragma once
+#include "Engine/Math/Vec2.hpp"
+
+class ByteBufferWriter;
+class ByteBufferReader;
+
+/// Bits of PlayerCommand::m_buttons
+enum class PlayerCommandButton : unsigned char
+{
+    SPRINT        = 1 << 0,
+    FIRE          = 1 << 1,
+    FLY_UP        = 1 << 2, // Free-fly camera only
+    FLY_DOWN      = 1 << 3, // Free-fly camera only
+    TOGGLE_CAMERA = 1 << 4,
+    POSSESS_NEXT  = 1 << 5,
+};
+
+/// Device independent input of one player for one frame. The PlayerController samples it from the keyboard and mouse
+/// or from the Xbox controller, or reads it back from an input replay, and only ever acts on the command.
+struct PlayerCommand
+{
+    Vec2          m_moveIntent; // x forward, y left. The length scales the move speed, diagonal keys move faster.
+    float         m_yawDelta    = 0.f; // Degrees
+    float         m_pitchDelta  = 0.f; // Degrees
+    float         m_rollDelta   = 0.f; // Degrees, camera roll from the controller triggers.
+    unsigned char m_buttons     = 0;
+    signed char   m_equipWeapon = -1; // Inventory slot to equip, -1 if none.
+    signed char   m_cycleWeapon = 0; // -1 previous weapon, 1 next weapon.
+
+    void SetButton(PlayerCommandButton button, bool bIsDown);
+    bool IsButtonDown(PlayerCommandButton button) const;
+
+    void Write(ByteBufferWriter& writer) const;
+    void Read(ByteBufferReader& reader);
+};
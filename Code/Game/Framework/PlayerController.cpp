@@ -1,5 +1,6 @@
 ﻿#include "PlayerController.hpp"
 
+#include "InputRecording.hpp"
 #include "WidgetSubsystem.hpp"
 #include "../GameCommon.hpp"
 #include "Engine/Core/EngineCommon.hpp"
@@ -47,40 +48,101 @@ void PlayerController::Update(float deltaSeconds)
     UpdateDebugMessage();
     HandleRayCast();
     UpdateInput(deltaSeconds);
-    UpdateWeapon(deltaSeconds);
     UpdateCamera(deltaSeconds);
 }
 
-void PlayerController::UpdateWeapon(float deltaSeconds)
+PlayerCommand PlayerController::SampleKeyboardCommand(float deltaSeconds)
 {
-    if (g_theGame->m_currentState != GameState::PLAYING)
-        return;
-    if (!m_actorHandle.IsValid())
-        return;
+    UNUSED(deltaSeconds)
+    PlayerCommand command;
+    Vec2          cursorDelta = g_theInput->GetCursorClientDelta();
+    command.m_yawDelta        = -cursorDelta.x * 0.125f;
+    command.m_pitchDelta      = -cursorDelta.y * 0.125f;
+
+    command.SetButton(PlayerCommandButton::POSSESS_NEXT, g_theInput->WasKeyJustPressed('N'));
+    command.SetButton(PlayerCommandButton::TOGGLE_CAMERA, g_theInput->WasKeyJustPressed('F'));
+    command.SetButton(PlayerCommandButton::SPRINT, g_theInput->IsKeyDown(KEYCODE_LEFT_SHIFT) || g_theInput->IsKeyDown(SHIFT_PRESSED));
+    command.SetButton(PlayerCommandButton::FIRE, g_theInput->WasMouseButtonJustPressed(KEYCODE_LEFT_MOUSE));
+    command.SetButton(PlayerCommandButton::FLY_DOWN, g_theInput->IsKeyDown('Z'));
+    command.SetButton(PlayerCommandButton::FLY_UP, g_theInput->IsKeyDown('C'));
+
+    if (g_theInput->IsKeyDown('W'))
+        command.m_moveIntent.x += 1.f;
+    if (g_theInput->IsKeyDown('S'))
+        command.m_moveIntent.x -= 1.f;
+    if (g_theInput->IsKeyDown('A'))
+        command.m_moveIntent.y += 1.f;
+    if (g_theInput->IsKeyDown('D'))
+        command.m_moveIntent.y -= 1.f;
+
+    if (g_theInput->WasKeyJustPressed('1'))
+        command.m_equipWeapon = 0;
+    if (g_theInput->WasKeyJustPressed('2'))
+        command.m_equipWeapon = 1;
+    if (g_theInput->WasKeyJustPressed('3'))
+        command.m_equipWeapon = 2;
+    if (g_theInput->WasKeyJustPressed(KEYCODE_LEFTARROW))
+        command.m_cycleWeapon = -1;
+    if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHTARROW))
+        command.m_cycleWeapon = 1;
+    return command;
+}
+
+PlayerCommand PlayerController::SampleControllerCommand(float deltaSeconds)
+{
+    PlayerCommand command;
     if (m_bCameraMode)
-        return;
-    Actor* possessActor = m_map->GetActorByHandle(m_actorHandle);
-    if (possessActor && possessActor->m_definition->m_name == "Marine")
+        return command;
+    Actor* possessActor = GetActor();
+    if (!possessActor)
+        return command;
+
+    const XboxController& controller    = g_theInput->GetController(0);
+    Vec2                  leftStickPos  = controller.GetLeftStick().GetPosition();
+    Vec2                  rightStickPos = controller.GetRightStick().GetPosition();
+    float                 leftStickMag  = controller.GetLeftStick().GetMagnitude();
+    float                 rightStickMag = controller.GetRightStick().GetMagnitude();
+
+    float turnRate = m_turnRate;
+    if (rightStickMag > 0.f)
     {
-        if (possessActor->m_currentWeapon)
-            possessActor->m_currentWeapon->Update(deltaSeconds);
+        turnRate             = possessActor->m_definition->m_turnSpeed;
+        Vec2 turn            = rightStickPos * m_speed * rightStickMag * turnRate * deltaSeconds;
+        command.m_yawDelta   = -turn.x;
+        command.m_pitchDelta = -turn.y;
+    }
+    command.m_rollDelta = (controller.GetLeftTrigger() - controller.GetRightTrigger()) * turnRate * deltaSeconds * m_speed;
+    if (leftStickMag > 0.f)
+    {
+        // Combine X / Y stick input into one full speed movement, only the keyboard sums its keys
+        command.m_moveIntent = Vec2(leftStickPos.y, -leftStickPos.x).GetNormalized();
     }
+
+    command.SetButton(PlayerCommandButton::SPRINT, controller.IsButtonDown(XBOX_BUTTON_A));
+    command.SetButton(PlayerCommandButton::FIRE, controller.GetRightTrigger() > 0.f);
+    if (controller.WasButtonJustPressed(XBOX_BUTTON_X))
+        command.m_equipWeapon = 0;
+    if (controller.WasButtonJustPressed(XBOX_BUTTON_Y))
+        command.m_equipWeapon = 1;
+    if (controller.WasButtonJustPressed(XBOX_BUTTON_DPAD_DOWN))
+        command.m_cycleWeapon = -1;
+    if (controller.WasButtonJustPressed(XBOX_BUTTON_DPAD_UP))
+        command.m_cycleWeapon = 1;
+    return command;
 }
 
-void PlayerController::UpdateKeyboardInput(float deltaSeconds)
+void PlayerController::ApplyCommand(const PlayerCommand& command, float deltaSeconds)
 {
-    UNUSED(deltaSeconds)
-    Vec2 cursorDelta = g_theInput->GetCursorClientDelta();
-    if (g_theInput->WasKeyJustPressed('N'))
+    if (command.IsButtonDown(PlayerCommandButton::POSSESS_NEXT))
     {
         if (m_map && g_theGame->GetIsSingleMode())
             m_map->DebugPossessNext();
     }
-    if (g_theInput->WasKeyJustPressed('F'))
+    if (command.IsButtonDown(PlayerCommandButton::TOGGLE_CAMERA))
     {
         if (!g_theGame->GetIsSingleMode())
         {
-            printf("PlayerController::UpdateKeyboardInput       Free Camera mode is disable in Multiplayer\n");
+            printf("PlayerController::ApplyCommand       Free Camera mode is disable in Multiplayer\n");
         }
         else { m_bCameraMode = !m_bCameraMode; }
     }
@@ -97,84 +159,50 @@ void PlayerController::UpdateKeyboardInput(float deltaSeconds)
             return;
         EulerAngles possessActorOrientation = possessActor->m_orientation;
         float       actorSpeed              = possessActor->m_definition->m_walkSpeed;
-        if (g_theInput->IsKeyDown(KEYCODE_LEFT_SHIFT))
+        if (command.IsButtonDown(PlayerCommandButton::SPRINT))
         {
             actorSpeed = possessActor->m_definition->m_runSpeed;
         }
 
-        possessActorOrientation.m_yawDegrees += -cursorDelta.x * 0.125f;
-        possessActorOrientation.m_pitchDegrees += -cursorDelta.y * 0.125f;
-
+        possessActorOrientation.m_yawDegrees += command.m_yawDelta;
+        possessActorOrientation.m_pitchDegrees += command.m_pitchDelta;
         possessActor->TurnInDirection(Vec3(possessActorOrientation));
 
         Vec3 forward, left, up;
         possessActor->m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, up);
 
-        if (g_theGame->m_currentState == GameState::PLAYING)
-        {
-            if (g_theInput->WasMouseButtonJustPressed(KEYCODE_LEFT_MOUSE) && !possessActor->m_bIsDead)
-                GetActor()->m_currentWeapon->Fire();
-        }
+        if (command.IsButtonDown(PlayerCommandButton::FIRE))
+            possessActor->Attack();
 
-        if (g_theInput->IsKeyDown('W'))
+        float moveLength = command.m_moveIntent.GetLength();
+        if (moveLength > 0.f)
         {
-            possessActor->MoveInDirection(forward, actorSpeed);
-            possessActor->PlayAnimationByName("Walk");
-        }
-
-        if (g_theInput->IsKeyDown('S'))
-        {
-            possessActor->MoveInDirection(-forward, actorSpeed);
-        }
-
-        if (g_theInput->IsKeyDown('A'))
-        {
-            possessActor->MoveInDirection(left, actorSpeed);
-        }
-
-        if (g_theInput->IsKeyDown('D'))
-        {
-            possessActor->MoveInDirection(-left, actorSpeed);
+            Vec3 moveDir = forward * command.m_moveIntent.x + left * command.m_moveIntent.y;
+            moveDir.z    = 0.f;
+            possessActor->MoveInDirection(moveDir, actorSpeed * moveLength);
+            possessActor->PlayAnimation(AnimationState::WALK);
         }
 
-        if (g_theInput->WasKeyJustPressed('1'))
-        {
-            possessActor->EquipWeapon(0);
-        }
-        if (g_theInput->WasKeyJustPressed('2'))
+        if (command.m_equipWeapon >= 0)
         {
-            possessActor->EquipWeapon(1);
+            possessActor->EquipWeapon(command.m_equipWeapon);
         }
-        if (g_theInput->WasKeyJustPressed('3'))
+        if (command.m_cycleWeapon != 0 && !possessActor->m_weapons.empty())
         {
-            possessActor->EquipWeapon(2);
+            auto it       = std::find(possessActor->m_weapons.begin(), possessActor->m_weapons.end(), possessActor->m_currentWeapon);
+            int  index    = static_cast<int>(it - possessActor->m_weapons.begin()) + command.m_cycleWeapon;
+            int  numSlots = static_cast<int>(possessActor->m_weapons.size());
+            possessActor->EquipWeapon((index + numSlots) % numSlots);
         }
-        if (g_theInput->WasKeyJustPressed(KEYCODE_LEFTARROW))
-        {
-            auto it    = std::find(possessActor->m_weapons.begin(), possessActor->m_weapons.end(), possessActor->m_currentWeapon);
-            int  index = static_cast<int>(it - possessActor->m_weapons.begin());
-            index--;
-            int newIndex = static_cast<int>((index + possessActor->m_weapons.size()) % possessActor->m_weapons.size());
-            possessActor->EquipWeapon(newIndex);
-        }
-        if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHTARROW))
-        {
-            auto it    = std::find(possessActor->m_weapons.begin(), possessActor->m_weapons.end(), possessActor->m_currentWeapon);
-            int  index = static_cast<int>(it - possessActor->m_weapons.begin());
-            index++;
-            int newIndex = index % possessActor->m_weapons.size();
-            possessActor->EquipWeapon(newIndex);
-        }
-
 
         m_position    = possessActor->m_position;
         m_orientation = possessActor->m_orientation;
+        m_orientation.m_rollDegrees += command.m_rollDelta;
     }
     else
     {
-        m_orientation.m_yawDegrees += -cursorDelta.x * 0.125f;
-        m_orientation.m_pitchDegrees += -cursorDelta.y * 0.125f;
-
+        m_orientation.m_yawDegrees += command.m_yawDelta;
+        m_orientation.m_pitchDegrees += command.m_pitchDelta;
 
         m_orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees, -85.f, 85.f);
         m_orientation.m_rollDegrees  = GetClamped(m_orientation.m_rollDegrees, -45.f, 45.f);
@@ -183,147 +211,50 @@ void PlayerController::UpdateKeyboardInput(float deltaSeconds)
         m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, up);
 
         float speed = m_speed;
-
-        if (g_theInput->IsKeyDown(SHIFT_PRESSED))
+        if (command.IsButtonDown(PlayerCommandButton::SPRINT))
         {
             speed *= 15.0f;
         }
 
-        if (g_theInput->IsKeyDown('W'))
-        {
-            m_position += forward * speed * deltaSeconds;
-        }
-
-        if (g_theInput->IsKeyDown('S'))
-        {
-            m_position -= forward * speed * deltaSeconds;
-        }
-
-        if (g_theInput->IsKeyDown('A'))
-        {
-            m_position += left * speed * deltaSeconds;
-        }
-
-        if (g_theInput->IsKeyDown('D'))
-        {
-            m_position -= left * speed * deltaSeconds;
-        }
-
-        if (g_theInput->IsKeyDown('Z'))
+        m_position += (forward * command.m_moveIntent.x + left * command.m_moveIntent.y) * speed * deltaSeconds;
+        if (command.IsButtonDown(PlayerCommandButton::FLY_DOWN))
         {
             m_position.z -= deltaSeconds * speed;
         }
-
-        if (g_theInput->IsKeyDown('C'))
+        if (command.IsButtonDown(PlayerCommandButton::FLY_UP))
         {
             m_position.z += deltaSeconds * speed;
         }
     }
 }
 
-void PlayerController::UpdateControllerInput(float deltaSeconds)
+void PlayerController::UpdateInput(float deltaSeconds)
 {
-    if (g_theGame->m_currentState != GameState::PLAYING)
-        return;
-
-    const XboxController& controller = g_theInput->GetController(0);
-    float                 speed      = m_speed;
-    float                 turnRate   = m_turnRate;
-    if (!m_bCameraMode)
+    /// Replays feed the recorded command, otherwise sample the device of this player
+    PlayerCommand command;
+    if (g_theGame->m_inputReplayer)
     {
-        Actor* possessActor = GetActor();
-        if (!possessActor)
-            return;
-        if (possessActor->m_bIsDead) /// Handle player Actor dead
-            return;
-        EulerAngles possessActorOrientation = possessActor->m_orientation;
-
-        float actorSpeed = possessActor->m_definition->m_walkSpeed;
-
-        Vec2  leftStickPos  = controller.GetLeftStick().GetPosition();
-        Vec2  rightStickPos = controller.GetRightStick().GetPosition();
-        float leftStickMag  = controller.GetLeftStick().GetMagnitude();
-        float rightStickMag = controller.GetRightStick().GetMagnitude();
-        float leftTrigger   = controller.GetLeftTrigger();
-        float rightTrigger  = controller.GetRightTrigger();
-
-
-        if (rightStickMag > 0.f)
-        {
-            turnRate = possessActor->m_definition->m_turnSpeed;
-            possessActorOrientation.m_yawDegrees += -(rightStickPos * speed * rightStickMag * turnRate * deltaSeconds).x;
-            possessActorOrientation.m_pitchDegrees += -(rightStickPos * speed * rightStickMag * turnRate * deltaSeconds).y;
-            possessActor->TurnInDirection(Vec3(possessActorOrientation));
-        }
-
-        if (controller.IsButtonDown(XBOX_BUTTON_A))
-        {
-            actorSpeed = possessActor->m_definition->m_runSpeed;
-        }
-
-        Vec3 forward, left, up;
-        possessActor->m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, up);
-        if (leftStickMag > 0.f)
-        {
-            // Combine X / Y stick input into one movement vector
-            Vec3 moveDir = forward * leftStickPos.y + -left * leftStickPos.x;
-            moveDir.z    = 0.f;
-            possessActor->MoveInDirection(moveDir.GetNormalized(), actorSpeed);
-            possessActor->PlayAnimationByName("Walk");
-        }
-
-        if (controller.WasButtonJustPressed(XBOX_BUTTON_DPAD_DOWN))
-        {
-            auto it    = std::find(possessActor->m_weapons.begin(), possessActor->m_weapons.end(), possessActor->m_currentWeapon);
-            int  index = static_cast<int>(it - possessActor->m_weapons.begin());
-            index--;
-            int newIndex = static_cast<int>((index + possessActor->m_weapons.size()) % possessActor->m_weapons.size());
-            possessActor->EquipWeapon(newIndex);
-        }
-        if (rightTrigger > 0.f)
-        {
-            GetActor()->m_currentWeapon->Fire();
-        }
-        if (controller.WasButtonJustPressed(XBOX_BUTTON_Y))
-        {
-            possessActor->EquipWeapon(1);
-        }
-        if (controller.WasButtonJustPressed(XBOX_BUTTON_X))
-        {
-            possessActor->EquipWeapon(0);
-        }
-        if (controller.WasButtonJustPressed(XBOX_BUTTON_DPAD_UP))
-        {
-            auto it    = std::find(possessActor->m_weapons.begin(), possessActor->m_weapons.end(), possessActor->m_currentWeapon);
-            int  index = static_cast<int>(it - possessActor->m_weapons.begin());
-            index++;
-            int newIndex = index % possessActor->m_weapons.size();
-            possessActor->EquipWeapon(newIndex);
-        }
-
-        m_orientation.m_rollDegrees += leftTrigger * turnRate * deltaSeconds * speed;
-        m_orientation.m_rollDegrees -= rightTrigger * turnRate * deltaSeconds * speed;
+        g_theGame->m_inputReplayer->GetCommand(m_index, command);
     }
-}
-
-void PlayerController::UpdateInput(float deltaSeconds)
-{
-    UNUSED(deltaSeconds)
-    Vec2 cursorDelta = g_theInput->GetCursorClientDelta();
-
-    switch (m_deviceType)
+    else
     {
-    case DeviceType::CONTROLLER:
+        switch (m_deviceType)
         {
-            UpdateControllerInput(deltaSeconds);
-            break;
-        }
-    case DeviceType::KEYBOARD_AND_MOUSE:
-        {
-            UpdateKeyboardInput(deltaSeconds);
-            break;
+        case DeviceType::CONTROLLER:
+            {
+                command = SampleControllerCommand(deltaSeconds);
+                break;
+            }
+        case DeviceType::KEYBOARD_AND_MOUSE:
+            {
+                command = SampleKeyboardCommand(deltaSeconds);
+                break;
+            }
         }
     }
+    if (g_theGame->m_inputRecorder)
+        g_theGame->m_inputRecorder->RecordCommand(m_index, command);
+    ApplyCommand(command, deltaSeconds);
 }
 
 void PlayerController::UpdateCamera(float deltaSeconds)
@@ -357,7 +288,7 @@ void PlayerController::UpdateCamera(float deltaSeconds)
     m_worldCamera->SetCameraToRenderTransform(ndcMatrix);
 }
 
-void PlayerController::Render() const
+void PlayerController::Render()
 {
     g_theRenderer->BeingCamera(*m_viewCamera);
     if (g_theGame->m_currentState != GameState::PLAYING)
@@ -370,7 +301,7 @@ void PlayerController::Render() const
     if (possessActor->m_definition->m_name == "Marine")
     {
         if (possessActor->m_currentWeapon)
-            possessActor->m_currentWeapon->Render();
+            possessActor->m_currentWeapon->Render(m_hudCache);
     }
     g_theRenderer->EndCamera(*m_viewCamera);
 }
@@ -385,14 +316,14 @@ void PlayerController::HandleActorDead(float deltaSeconds)
         Actor* possessActor = m_map->GetActorByHandle(m_actorHandle);
         if (possessActor && possessActor->m_bIsDead && possessActor->m_definition->m_name == "Marine")
         {
-            if (possessActor->m_dead <= deltaSeconds)
+            if (possessActor->GetSecondsDead() <= deltaSeconds)
             {
                 auto playerDeathWidget = new WidgetPlayerDeath();
                 g_theWidgetSubsystem->AddToPlayerViewport(playerDeathWidget, this);
             }
             Vec3  startPos      = possessActor->m_position + Vec3(0, 0, possessActor->m_definition->m_eyeHeight);
             Vec3  endPos        = possessActor->m_position;
-            float deathFraction = GetClamped(possessActor->m_dead / possessActor->m_definition->m_corpseLifetime, 0.f, 1.f);
+            float deathFraction = GetClamped(possessActor->GetSecondsDead() / possessActor->m_definition->m_corpseLifetime, 0.f, 1.f);
             float interpolate   = Interpolate(startPos.z, endPos.z, deathFraction);
             m_position          = Vec3(possessActor->m_position.x, possessActor->m_position.y, interpolate);
         }
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "Controller.hpp"
+#include "PlayerCommand.hpp"
+#include "PlayerHudCache.hpp"
 #include "../Entity.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Game/GameCommon.hpp"
@@ -30,14 +32,16 @@ public:
 
     /// Update
     void Update(float deltaSeconds) override;
-    void UpdateWeapon(float deltaSeconds);
-    void UpdateKeyboardInput(float deltaSeconds);
-    void UpdateControllerInput(float deltaSeconds);
     void UpdateInput(float deltaSeconds); // Perform input processing for controlling actors and free-fly camera mode.
+
+    /// Input commands, devices are only read while sampling so a recorded command replays exactly
+    PlayerCommand SampleKeyboardCommand(float deltaSeconds);
+    PlayerCommand SampleControllerCommand(float deltaSeconds);
+    void          ApplyCommand(const PlayerCommand& command, float deltaSeconds);
     void UpdateCamera(float deltaSeconds); // Update our camera settings, taking in to account actor eye height and field of vision.
 
     /// Render
-    void Render() const;
+    void Render();
 
     void HandleActorDead(float deltaSeconds);
 
@@ -49,9 +53,10 @@ public:
     bool m_bCameraMode = false; // Toggles whether we are controlling an actor or a free-fly camera currently.
 
 private:
-    float      m_speed      = 2.0f;
-    float      m_turnRate   = 0.075f;
-    DeviceType m_deviceType = DeviceType::KEYBOARD_AND_MOUSE;
+    float          m_speed      = 2.0f;
+    float          m_turnRate   = 0.075f;
+    DeviceType     m_deviceType = DeviceType::KEYBOARD_AND_MOUSE;
+    PlayerHudCache m_hudCache; // Weapon hud geometry of this player viewport.
 
     void HandleRayCast();
     void UpdateDebugMessage();
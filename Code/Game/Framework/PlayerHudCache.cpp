@@ -0,0 +1,60 @@
+﻿#include "PlayerHudCache.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Game/GameCommon.hpp"
+
+PlayerHudCache::~PlayerHudCache()
+{
+    for (HudLayerBuffer& layer : m_layers)
+    {
+        POINTER_SAFE_DELETE(layer.m_buffer)
+    }
+}
+
+bool PlayerHudCache::NeedsLayout(const Hud* hud, const AABB2& hudBaseBound, const AABB2& screenViewport) const
+{
+    return hud != m_hud || hudBaseBound.m_mins != m_hudBaseBound.m_mins || hudBaseBound.m_maxs != m_hudBaseBound.m_maxs ||
+        screenViewport.m_mins != m_screenViewport.m_mins || screenViewport.m_maxs != m_screenViewport.m_maxs;
+}
+
+void PlayerHudCache::SetLayout(const Hud* hud, const AABB2& hudBaseBound, const AABB2& screenViewport)
+{
+    m_hud            = hud;
+    m_hudBaseBound   = hudBaseBound;
+    m_screenViewport = screenViewport;
+    m_bIsTextValid   = false;
+}
+
+bool PlayerHudCache::NeedsText(int health, int kills, int deaths) const
+{
+    return !m_bIsTextValid || health != m_health || kills != m_kills || deaths != m_deaths;
+}
+
+void PlayerHudCache::SetText(int health, int kills, int deaths)
+{
+    m_bIsTextValid = true;
+    m_health       = health;
+    m_kills        = kills;
+    m_deaths       = deaths;
+}
+
+void PlayerHudCache::Upload(HudLayer layer, const std::vector<Vertex_PCU>& vertexes)
+{
+    HudLayerBuffer& layerBuffer = m_layers[static_cast<int>(layer)];
+    layerBuffer.m_numVertexes   = static_cast<int>(vertexes.size());
+    if (vertexes.empty())
+        return;
+    if (layerBuffer.m_buffer == nullptr)
+        layerBuffer.m_buffer = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+    g_theRenderer->CopyCPUToGPU(vertexes.data(), vertexes.size() * sizeof(Vertex_PCU), layerBuffer.m_buffer);
+}
+
+void PlayerHudCache::Draw(HudLayer layer, const Texture* texture) const
+{
+    const HudLayerBuffer& layerBuffer = m_layers[static_cast<int>(layer)];
+    if (layerBuffer.m_numVertexes == 0)
+        return;
+    g_theRenderer->BindTexture(texture);
+    g_theRenderer->DrawVertexBuffer(layerBuffer.m_buffer, layerBuffer.m_numVertexes);
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <vector>
+
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/AABB2.hpp"
+
+class BitmapFont;
+class Hud;
+class Texture;
+class VertexBuffer;
+
+enum class HudLayer : unsigned char
+{
+    BASE,
+    RETICLE,
+    TEXT, // Health, kills and deaths.
+    COUNT
+};
+
+/// Weapon hud geometry of one player viewport. The base and reticle only depend on the hud and the viewport, they are
+/// rebuilt when the player switches weapon or the viewport changes. The text is rebuilt when a shown number changes.
+/// Only the animation quad is generated every frame, into vertexes reused between frames.
+class PlayerHudCache
+{
+public:
+    PlayerHudCache() = default;
+    PlayerHudCache(const PlayerHudCache&)            = delete;
+    PlayerHudCache& operator=(const PlayerHudCache&) = delete;
+    ~PlayerHudCache();
+
+    bool NeedsLayout(const Hud* hud, const AABB2& hudBaseBound, const AABB2& screenViewport) const;
+    void SetLayout(const Hud* hud, const AABB2& hudBaseBound, const AABB2& screenViewport); // Also invalidates the text.
+    bool NeedsText(int health, int kills, int deaths) const; // Kills and deaths are -1 for a player without save data.
+    void SetText(int health, int kills, int deaths);
+
+    void Upload(HudLayer layer, const std::vector<Vertex_PCU>& vertexes);
+    void Draw(HudLayer layer, const Texture* texture) const;
+
+    BitmapFont*             m_font          = nullptr;
+    float                   m_viewportScale = 1.f; // Screen height over viewport height, squeezes the hud horizontally in split screen.
+    AABB2                   m_animationBound; // Animation quad without the frame UVs.
+    std::vector<Vertex_PCU> m_scratchVertexes; // Reused to build every layer and the animation quad.
+
+private:
+    struct HudLayerBuffer
+    {
+        VertexBuffer* m_buffer      = nullptr;
+        int           m_numVertexes = 0;
+    };
+
+    HudLayerBuffer m_layers[static_cast<int>(HudLayer::COUNT)];
+
+    /// Layout key
+    const Hud* m_hud = nullptr;
+    AABB2      m_hudBaseBound;
+    AABB2      m_screenViewport;
+    /// Text key
+    bool m_bIsTextValid = false;
+    int  m_health       = 0;
+    int  m_kills        = 0;
+    int  m_deaths       = 0;
+};
@@ -0,0 +1,79 @@
+﻿#include "RandomStream.hpp"
+
+static constexpr unsigned long long SPLITMIX_GAMMA = 0x9E3779B97F4A7C15ull;
+
+RandomStream::RandomStream(unsigned long long seed): m_seed(seed)
+{
+}
+
+void RandomStream::SetSeed(unsigned long long seed)
+{
+    m_seed    = seed;
+    m_counter = 0;
+}
+
+unsigned long long RandomStream::GetSeed() const
+{
+    return m_seed;
+}
+
+unsigned long long RandomStream::GetCounter() const
+{
+    return m_counter;
+}
+
+void RandomStream::SetCounter(unsigned long long counter)
+{
+    m_counter = counter;
+}
+
+unsigned long long RandomStream::RollRandomUInt64()
+{
+    /// The n-th value is Mix(seed + (n + 1) * gamma), no hidden state besides the counter.
+    ++m_counter;
+    return Mix(m_seed + m_counter * SPLITMIX_GAMMA);
+}
+
+int RandomStream::RollRandomIntLessThan(int maxNotInclusive)
+{
+    if (maxNotInclusive <= 0)
+    {
+        return 0;
+    }
+    /// Lemire multiply-shift range reduction on the upper 32 bits
+    unsigned long long bits32 = RollRandomUInt64() >> 32;
+    return static_cast<int>((bits32 * static_cast<unsigned long long>(maxNotInclusive)) >> 32);
+}
+
+int RandomStream::RollRandomIntInRange(int minInclusive, int maxInclusive)
+{
+    if (maxInclusive <= minInclusive)
+    {
+        return minInclusive;
+    }
+    return minInclusive + RollRandomIntLessThan(maxInclusive - minInclusive + 1);
+}
+
+float RandomStream::RollRandomFloatZeroToOne()
+{
+    /// Top 24 bits fill the float mantissa exactly, result is in [0, 1]
+    unsigned long long bits24 = RollRandomUInt64() >> 40;
+    return static_cast<float>(bits24) * (1.f / static_cast<float>(0xFFFFFF));
+}
+
+float RandomStream::RollRandomFloatInRange(float minInclusive, float maxInclusive)
+{
+    return minInclusive + (maxInclusive - minInclusive) * RollRandomFloatZeroToOne();
+}
+
+unsigned long long RandomStream::DeriveSeed(unsigned long long parentSeed, unsigned long long streamId)
+{
+    return Mix(parentSeed ^ Mix(streamId + SPLITMIX_GAMMA));
+}
+
+unsigned long long RandomStream::Mix(unsigned long long value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
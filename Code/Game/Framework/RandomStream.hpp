@@ -0,0 +1,31 @@
+﻿#pragma once
+
+/// Counter based SplitMix64 random stream. Every value is a pure function of the seed and the number of values drawn
+/// before it, so a stream only depends on its own history. Map, actors and weapons each own one, seeded from their
+/// parent with DeriveSeed, which keeps the randomness of one object independent from the update order of the others.
+class RandomStream
+{
+public:
+    RandomStream() = default;
+    explicit RandomStream(unsigned long long seed);
+
+    void               SetSeed(unsigned long long seed); // Re-seed the stream and rewind its counter.
+    unsigned long long GetSeed() const;
+    unsigned long long GetCounter() const;
+    void               SetCounter(unsigned long long counter); // Restore the stream position, e.g. from a snapshot.
+
+    unsigned long long RollRandomUInt64();
+    int                RollRandomIntLessThan(int maxNotInclusive);
+    int                RollRandomIntInRange(int minInclusive, int maxInclusive);
+    float              RollRandomFloatZeroToOne();
+    float              RollRandomFloatInRange(float minInclusive, float maxInclusive);
+
+    /// Mix a parent seed with a stream id into the seed of a child stream, e.g. map seed and actor uid.
+    static unsigned long long DeriveSeed(unsigned long long parentSeed, unsigned long long streamId);
+    /// SplitMix64 finalizer, a bijective mix of all 64 bits.
+    static unsigned long long Mix(unsigned long long value);
+
+private:
+    unsigned long long m_seed    = 0;
+    unsigned long long m_counter = 0;
+};
@@ -1,8 +1,47 @@
 ﻿#include "ResourceSubsystem.hpp"
 
+#include <algorithm>
+
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Renderer/SpriteSheet.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 
+/// Playbacks count as playing until the check finishes or stops them, every StopSound call is recorded
+class FakeSoundPlaybackBackend : public SoundPlaybackBackend
+{
+public:
+    bool IsPlaying(SoundPlaybackID playback) override
+    {
+        return std::find(m_playing.begin(), m_playing.end(), playback) != m_playing.end();
+    }
+
+    void StopSound(SoundPlaybackID playback) override
+    {
+        m_stopped.push_back(playback);
+        Finish(playback);
+    }
+
+    void Finish(SoundPlaybackID playback)
+    {
+        m_playing.erase(std::remove(m_playing.begin(), m_playing.end(), playback), m_playing.end());
+    }
+
+    std::vector<SoundPlaybackID> m_playing;
+    std::vector<SoundPlaybackID> m_stopped;
+};
+
+bool AudioSystemPlaybackBackend::IsPlaying(SoundPlaybackID playback)
+{
+    return g_theAudio->IsPlaying(playback);
+}
+
+void AudioSystemPlaybackBackend::StopSound(SoundPlaybackID playback)
+{
+    g_theAudio->StopSound(playback);
+}
+
 ResourceSubsystem::ResourceSubsystem(ResourceSystemConfig config): m_config(config)
 {
 }
@@ -13,16 +52,29 @@ ResourceSubsystem::~ResourceSubsystem()
 
 void ResourceSubsystem::BeginFrame()
 {
+    m_assetLoader.ProcessDecodedAssets();
 }
 
 void ResourceSubsystem::Startup()
 {
     printf("ResourceSubsystem::Startup    Initialize Resource Subsystem\n");
     RegisterSounds();
+    m_assetLoader.Startup(m_config.m_numAssetWorkers);
+    m_voiceManager.Startup(m_config.m_voiceConfig);
+    if (m_config.m_bCheckPlaybackCache)
+        RunPlaybackCacheCheck();
 }
 
 void ResourceSubsystem::Shutdown()
 {
+    if (!m_shaders.empty() || !m_spriteSheets.empty())
+    {
+        printf("ResourceSubsystem::Shutdown    %d shaders and %d sprite sheets were never released\n", static_cast<int>(m_shaders.size()), static_cast<int>(m_spriteSheets.size()));
+    }
+    m_shaders.clear();
+    m_spriteSheets.clear();
+    m_assetLoader.Shutdown();
+    m_voiceManager.Shutdown();
 }
 
 void ResourceSubsystem::Update()
@@ -31,6 +83,14 @@ void ResourceSubsystem::Update()
 
 void ResourceSubsystem::EndFrame()
 {
+    m_voiceManager.Update();
+
+    m_secondsSinceReap += Clock::GetSystemClock().GetDeltaSeconds();
+    if (m_secondsSinceReap >= m_config.m_soundReapSeconds)
+    {
+        m_secondsSinceReap = 0.f;
+        ReapFinishedSoundPlaybacks();
+    }
 }
 
 void ResourceSubsystem::RegisterSounds()
@@ -41,57 +101,242 @@ void ResourceSubsystem::RegisterSounds()
     g_theAudio->CreateOrGetSound(g_gameConfigBlackboard.GetValue("buttonClickSound", ""));
 }
 
-std::vector<SoundPlaybackID> ResourceSubsystem::StopSoundsBySoundID(SoundID soundID)
+AssetHandle ResourceSubsystem::RequestImage(const std::string& path)
 {
-    std::vector<SoundPlaybackID> sounds;
-    sounds.reserve(m_cachedSounds.size());
-    for (std::pair<SoundPlaybackID, SoundID> sound : m_cachedSounds)
+    return m_assetLoader.RequestImage(path);
+}
+
+AssetHandle ResourceSubsystem::RequestTexture(const std::string& path)
+{
+    return m_assetLoader.RequestTexture(path);
+}
+
+void ResourceSubsystem::WaitForAssets()
+{
+    m_assetLoader.WaitForAssets();
+}
+
+void ResourceSubsystem::ReleaseAsset(const AssetHandle& handle)
+{
+    m_assetLoader.ReleaseAsset(handle);
+}
+
+Shader* ResourceSubsystem::AcquireShader(const std::string& shaderName, VertexType vertexType)
+{
+    m_numShaderRequests++;
+    SharedResource<Shader>& shader = m_shaders[Stringf("%s|%d", shaderName.c_str(), static_cast<int>(vertexType))];
+    if (!shader.m_resource)
+        shader.m_resource = g_theRenderer->CreateShaderFromFile(shaderName.c_str(), vertexType);
+    shader.m_refCount++;
+    return shader.m_resource;
+}
+
+void ResourceSubsystem::ReleaseShader(Shader* shader)
+{
+    if (!shader)
+        return;
+    for (auto it = m_shaders.begin(); it != m_shaders.end(); ++it)
+    {
+        if (it->second.m_resource != shader)
+            continue;
+        if (--it->second.m_refCount == 0)
+        {
+            delete it->second.m_resource;
+            m_shaders.erase(it);
+        }
+        return;
+    }
+}
+
+SpriteSheet* ResourceSubsystem::AcquireSpriteSheet(const AssetHandle& texture, const IntVec2& cellCount)
+{
+    if (!texture.IsReady())
+        return nullptr;
+    m_numSpriteSheetRequests++;
+    SharedResource<SpriteSheet>& spriteSheet = m_spriteSheets[Stringf("%s|%d|%d", texture.GetPath().c_str(), cellCount.x, cellCount.y)];
+    if (!spriteSheet.m_resource)
+        spriteSheet.m_resource = new SpriteSheet(*texture.GetTexture(), cellCount);
+    spriteSheet.m_refCount++;
+    return spriteSheet.m_resource;
+}
+
+void ResourceSubsystem::ReleaseSpriteSheet(const SpriteSheet* spriteSheet)
+{
+    if (!spriteSheet)
+        return;
+    for (auto it = m_spriteSheets.begin(); it != m_spriteSheets.end(); ++it)
     {
-        if (sound.second == soundID)
+        if (it->second.m_resource != spriteSheet)
+            continue;
+        if (--it->second.m_refCount == 0)
         {
-            g_theAudio->StopSound(sound.first);
-            sounds.emplace_back(sound.second);
-            m_cachedSounds.erase(sound.first); // Erase
+            delete it->second.m_resource;
+            m_spriteSheets.erase(it);
         }
+        return;
+    }
+}
+
+void ResourceSubsystem::PrintResourceStatistics() const
+{
+    printf("ResourceSubsystem::PrintResourceStatistics    Unique / requested: %d / %d shaders, %d / %d textures, %d / %d sprite sheets, %d / %d images\n",
+           static_cast<int>(m_shaders.size()), m_numShaderRequests,
+           m_assetLoader.GetNumUniqueAssets(AssetType::TEXTURE), m_assetLoader.GetNumRequestedAssets(AssetType::TEXTURE),
+           static_cast<int>(m_spriteSheets.size()), m_numSpriteSheetRequests,
+           m_assetLoader.GetNumUniqueAssets(AssetType::IMAGE), m_assetLoader.GetNumRequestedAssets(AssetType::IMAGE));
+}
+
+std::vector<SoundPlaybackID> ResourceSubsystem::StopSoundsBySoundID(SoundID soundID)
+{
+    std::vector<SoundPlaybackID> sounds;
+    auto                         it = m_cachedPlaybacksBySound.find(soundID);
+    if (it == m_cachedPlaybacksBySound.end())
+        return sounds;
+    sounds.swap(it->second);
+    m_cachedPlaybacksBySound.erase(it);
+    for (SoundPlaybackID playback : sounds)
+    {
+        m_playbackBackend->StopSound(playback);
+        m_cachedSoundsByPlayback.erase(playback);
     }
     return sounds;
 }
 
 void ResourceSubsystem::CachedSoundPlaybackID(SoundPlaybackID playback, SoundID soundID)
 {
-    auto it = m_cachedSounds.find(playback);
-    if (it == m_cachedSounds.end())
-        m_cachedSounds.emplace(playback, soundID);
-    else
-        m_cachedSounds[playback] = soundID;
+    auto it = m_cachedSoundsByPlayback.find(playback);
+    if (it != m_cachedSoundsByPlayback.end())
+    {
+        if (it->second == soundID)
+            return;
+        UncachePlayback(playback, it->second); // The playback ID was reused for another sound.
+    }
+    m_cachedSoundsByPlayback.emplace(playback, soundID);
+    m_cachedPlaybacksBySound[soundID].push_back(playback);
 }
 
 int ResourceSubsystem::GetCachedSoundPlaybackIDs(SoundID soundID, std::vector<SoundPlaybackID>& playbacks)
 {
-    for (std::pair<SoundPlaybackID, SoundID> sound : m_cachedSounds)
-    {
-        if (sound.second == soundID)
-            playbacks.emplace_back(sound.first);
-    }
+    auto it = m_cachedPlaybacksBySound.find(soundID);
+    if (it != m_cachedPlaybacksBySound.end())
+        playbacks.insert(playbacks.end(), it->second.begin(), it->second.end());
     return static_cast<int>(playbacks.size());
 }
 
 int ResourceSubsystem::ForceStopSoundAndRemoveSoundPlaybackID(SoundID soundID)
+{
+    return static_cast<int>(StopSoundsBySoundID(soundID).size());
+}
+
+int ResourceSubsystem::ReapFinishedSoundPlaybacks()
 {
     int numOfRemove = 0;
-    // Use iterator to traverse manually, erase(it) directly when encountering the target, and continue traversing with the return value
-    for (auto it = m_cachedSounds.begin(); it != m_cachedSounds.end();)
+    for (auto it = m_cachedPlaybacksBySound.begin(); it != m_cachedPlaybacksBySound.end();)
     {
-        if (it->second == soundID)
+        std::vector<SoundPlaybackID>& playbacks = it->second;
+        for (int i = static_cast<int>(playbacks.size()) - 1; i >= 0; i--)
         {
-            g_theAudio->StopSound(it->first);
-            it = m_cachedSounds.erase(it); // erase returns the next valid iterator
+            if (m_playbackBackend->IsPlaying(playbacks[i]))
+                continue;
+            m_cachedSoundsByPlayback.erase(playbacks[i]);
+            playbacks[i] = playbacks.back();
+            playbacks.pop_back();
             numOfRemove++;
         }
+        if (playbacks.empty())
+            it = m_cachedPlaybacksBySound.erase(it);
         else
-        {
-            ++it; // proceed normally
-        }
+            ++it;
     }
     return numOfRemove;
 }
+
+void ResourceSubsystem::UncachePlayback(SoundPlaybackID playback, SoundID soundID)
+{
+    m_cachedSoundsByPlayback.erase(playback);
+    auto it = m_cachedPlaybacksBySound.find(soundID);
+    if (it == m_cachedPlaybacksBySound.end())
+        return;
+    std::vector<SoundPlaybackID>& playbacks = it->second;
+    auto                          found     = std::find(playbacks.begin(), playbacks.end(), playback);
+    if (found != playbacks.end())
+    {
+        *found = playbacks.back();
+        playbacks.pop_back();
+    }
+    if (playbacks.empty())
+        m_cachedPlaybacksBySound.erase(it);
+}
+
+void ResourceSubsystem::RunPlaybackCacheCheck()
+{
+    auto expect = [](bool bCondition, const char* what)
+    {
+        if (!bCondition)
+            ERROR_AND_DIE(Stringf("ResourceSubsystem::RunPlaybackCacheCheck    %s", what))
+    };
+
+    /// The check runs on empty indexes, the real ones and the audio backend come back afterwards
+    std::unordered_map<SoundID, std::vector<SoundPlaybackID>> playbacksBySound;
+    std::unordered_map<SoundPlaybackID, SoundID>              soundsByPlayback;
+    playbacksBySound.swap(m_cachedPlaybacksBySound);
+    soundsByPlayback.swap(m_cachedSoundsByPlayback);
+    FakeSoundPlaybackBackend fakeBackend;
+    m_playbackBackend = &fakeBackend;
+
+    constexpr SoundID            SOUND_A = 1;
+    constexpr SoundID            SOUND_B = 2;
+    std::vector<SoundPlaybackID> playbacks;
+
+    /// A playback ID the audio system reused for another sound moves to that sound
+    fakeBackend.m_playing = {101, 102, 103};
+    CachedSoundPlaybackID(101, SOUND_A);
+    CachedSoundPlaybackID(102, SOUND_A);
+    CachedSoundPlaybackID(101, SOUND_B);
+    expect(GetCachedSoundPlaybackIDs(SOUND_A, playbacks) == 1 && playbacks[0] == 102, "Reused playback still listed under its old sound");
+    playbacks.clear();
+    expect(GetCachedSoundPlaybackIDs(SOUND_B, playbacks) == 1 && playbacks[0] == 101, "Reused playback missing under its new sound");
+    playbacks.clear();
+    expect(m_cachedSoundsByPlayback.at(101) == SOUND_B, "Reused playback maps to its old sound");
+
+    /// Reaping drops a finished playback out of both indexes and keeps the playing ones
+    CachedSoundPlaybackID(103, SOUND_B);
+    fakeBackend.Finish(101);
+    expect(ReapFinishedSoundPlaybacks() == 1, "Reap did not drop exactly the finished playback");
+    expect(m_cachedSoundsByPlayback.count(101) == 0, "Reaped playback still maps to a sound");
+    expect(GetCachedSoundPlaybackIDs(SOUND_B, playbacks) == 1 && playbacks[0] == 103, "Reap touched a playing playback");
+    playbacks.clear();
+
+    /// Stop by sound returns and stops the playbacks of that sound only
+    std::vector<SoundPlaybackID> stopped = StopSoundsBySoundID(SOUND_A);
+    expect(stopped.size() == 1 && stopped[0] == 102, "Stop by sound returned the wrong playbacks");
+    expect(fakeBackend.m_stopped == stopped, "Stop by sound stopped the wrong playbacks");
+    expect(m_cachedPlaybacksBySound.count(SOUND_A) == 0 && m_cachedSoundsByPlayback.count(102) == 0, "Stopped playbacks are still cached");
+    expect(StopSoundsBySoundID(SOUND_A).empty(), "Second stop by sound returned playbacks");
+    expect(GetCachedSoundPlaybackIDs(SOUND_B, playbacks) == 1, "Stop by sound touched another sound");
+    playbacks.clear();
+
+    /// The last finished playback of a sound removes the sound from the index
+    fakeBackend.Finish(103);
+    expect(ReapFinishedSoundPlaybacks() == 1 && m_cachedPlaybacksBySound.empty() && m_cachedSoundsByPlayback.empty(), "Indexes not empty after the last reap");
+
+    m_playbackBackend = &m_audioPlaybackBackend;
+    m_cachedPlaybacksBySound.swap(playbacksBySound);
+    m_cachedSoundsByPlayback.swap(soundsByPlayback);
+    printf("ResourceSubsystem::RunPlaybackCacheCheck    Playback reuse, reap and stop by sound passed\n");
+}
+
+void ResourceSubsystem::PlaySoundAt(SoundID soundID, const Vec3& position, SoundPriority priority, unsigned int emitterID)
+{
+    m_voiceManager.RequestSoundAt(soundID, position, priority, emitterID);
+}
+
+void ResourceSubsystem::SetNumSoundListeners(int numListeners)
+{
+    m_voiceManager.SetNumListeners(numListeners);
+}
+
+void ResourceSubsystem::SetSoundListenerPosition(int listenerIndex, const Vec3& position)
+{
+    m_voiceManager.SetListenerPosition(listenerIndex, position);
+}
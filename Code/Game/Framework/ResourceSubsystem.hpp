@@ -1,9 +1,46 @@
 ﻿#pragma once
+#include <unordered_map>
+
+#include "AssetLoader.hpp"
+#include "AudioVoiceManager.hpp"
 #include "Sound.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+class SpriteSheet;
 
 struct ResourceSystemConfig
 {
-    bool m_bRemoveSoundPlaybackID = false;
+    bool             m_bRemoveSoundPlaybackID = false;
+    int              m_numAssetWorkers        = 0; // Threads decoding images and textures, 0 picks one less than the hardware threads.
+    float            m_soundReapSeconds       = 1.f; // Interval between two sweeps dropping the cached playbacks that finished.
+    bool             m_bCheckPlaybackCache    = false; // Run the playback cache against a fake audio backend on startup.
+    AudioVoiceConfig m_voiceConfig;
+};
+
+/// Audio calls of the sound playback cache, the engine audio system unless a check swaps in a fake.
+class SoundPlaybackBackend
+{
+public:
+    virtual ~SoundPlaybackBackend() = default;
+
+    virtual bool IsPlaying(SoundPlaybackID playback) = 0;
+    virtual void StopSound(SoundPlaybackID playback) = 0;
+};
+
+class AudioSystemPlaybackBackend : public SoundPlaybackBackend
+{
+public:
+    bool IsPlaying(SoundPlaybackID playback) override;
+    void StopSound(SoundPlaybackID playback) override;
+};
+
+/// Path keyed resource shared by every definition that uses it, deleted once the last one releases it.
+template <typename T>
+struct SharedResource
+{
+    T*  m_resource = nullptr;
+    int m_refCount = 0;
 };
 
 class ResourceSubsystem
@@ -22,13 +59,48 @@ public:
     /// Pre Registering Resource
     void RegisterSounds();
 
-    /// Sound Resource management
-    std::vector<SoundPlaybackID> StopSoundsBySoundID(SoundID soundID);
+    /// Asset loading, handles resolve on the main thread in BeginFrame or WaitForAssets
+    AssetHandle RequestImage(const std::string& path);
+    AssetHandle RequestTexture(const std::string& path);
+    void        WaitForAssets();
+    void        ReleaseAsset(const AssetHandle& handle);
+
+    /// Shared resources, every Acquire must be paired with one Release by the definition that owns the result
+    Shader*      AcquireShader(const std::string& shaderName, VertexType vertexType);
+    void         ReleaseShader(Shader* shader);
+    SpriteSheet* AcquireSpriteSheet(const AssetHandle& texture, const IntVec2& cellCount); // The texture must be ready.
+    void         ReleaseSpriteSheet(const SpriteSheet* spriteSheet);
+    void         PrintResourceStatistics() const; // Unique against requested count of every resource kind.
+
+    /// Sound Resource management, cached playbacks are indexed both ways and the finished ones reaped periodically
+    std::vector<SoundPlaybackID> StopSoundsBySoundID(SoundID soundID); // Returns the stopped playbacks.
     void                         CachedSoundPlaybackID(SoundPlaybackID playback, SoundID soundID);
     int                          GetCachedSoundPlaybackIDs(SoundID soundID, std::vector<SoundPlaybackID>& playbacks);
     int                          ForceStopSoundAndRemoveSoundPlaybackID(SoundID soundID);
+    int                          ReapFinishedSoundPlaybacks(); // Returns the number of playbacks dropped.
+    /// Reuse of a playback ID, reaping and stop by sound against a fake backend, die on the first wrong index.
+    void RunPlaybackCacheCheck();
+
+    /// 3D sounds, queued and started under the voice limits in EndFrame
+    void PlaySoundAt(SoundID soundID, const Vec3& position, SoundPriority priority = SoundPriority::NORMAL, unsigned int emitterID = 0);
+    void SetNumSoundListeners(int numListeners);
+    void SetSoundListenerPosition(int listenerIndex, const Vec3& position);
 
 private:
     ResourceSystemConfig               m_config;
-    std::map<SoundPlaybackID, SoundID> m_cachedSounds;
+    AssetLoader                        m_assetLoader;
+    AudioVoiceManager                  m_voiceManager;
+
+    std::unordered_map<std::string, SharedResource<Shader>>      m_shaders; // Keyed by shader name and vertex type.
+    std::unordered_map<std::string, SharedResource<SpriteSheet>> m_spriteSheets; // Keyed by texture path and cell count.
+    int                                                          m_numShaderRequests      = 0;
+    int                                                          m_numSpriteSheetRequests = 0;
+
+    void UncachePlayback(SoundPlaybackID playback, SoundID soundID);
+
+    std::unordered_map<SoundID, std::vector<SoundPlaybackID>> m_cachedPlaybacksBySound; // Few playbacks per sound, scanned linearly.
+    std::unordered_map<SoundPlaybackID, SoundID>              m_cachedSoundsByPlayback;
+    float                                                     m_secondsSinceReap = 0.f;
+    AudioSystemPlaybackBackend                                m_audioPlaybackBackend;
+    SoundPlaybackBackend*                                     m_playbackBackend = &m_audioPlaybackBackend;
 };
@@ -1,5 +1,6 @@
 ﻿#include "Sound.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
 
 Sound::Sound(const XmlElement& soundElement)
 {
@@ -8,6 +9,19 @@ Sound::Sound(const XmlElement& soundElement)
     m_id       = g_theAudio->CreateOrGetSound(m_filePath,FMOD_3D);
 }
 
+Sound::Sound(ByteBufferReader& reader)
+{
+    m_name     = reader.ReadString();
+    m_filePath = reader.ReadString();
+    m_id       = g_theAudio->CreateOrGetSound(m_filePath,FMOD_3D);
+}
+
+void Sound::Cook(ByteBufferWriter& writer) const
+{
+    writer.WriteString(m_name);
+    writer.WriteString(m_filePath);
+}
+
 SoundID Sound::GetSoundID() const
 {
     return m_id;
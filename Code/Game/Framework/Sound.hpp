@@ -4,6 +4,9 @@
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 
+class ByteBufferWriter;
+class ByteBufferReader;
+
 ///
 /// Different from FMod::Sound, this class Encapsulate sound name, file path and SoundID from
 /// FMod. because we want have the same name sound that store in ActorDefinition or elsewhere
@@ -12,6 +15,8 @@ class Sound
 {
 public:
     Sound(const XmlElement& soundElement);
+    explicit Sound(ByteBufferReader& reader);
+    void Cook(ByteBufferWriter& writer) const;
 
     SoundID     GetSoundID() const;
     std::string m_name     = "Default";
@@ -0,0 +1,66 @@
+﻿#include "SoundCue.hpp"
+
+#include "Sound.hpp"
+
+static const char* SOUND_CUE_NAMES[SOUND_CUE_COUNT] = {"Fire", "Hurt", "Death"};
+
+const char* GetSoundCueName(SoundCue cue)
+{
+    if (cue >= SoundCue::COUNT)
+        return "";
+    return SOUND_CUE_NAMES[static_cast<int>(cue)];
+}
+
+SoundCue GetSoundCueByName(const std::string& name)
+{
+    for (int cue = 0; cue < SOUND_CUE_COUNT; cue++)
+    {
+        if (name == SOUND_CUE_NAMES[cue])
+            return static_cast<SoundCue>(cue);
+    }
+    return SoundCue::COUNT;
+}
+
+SoundCueTable::SoundCueTable()
+{
+    for (SoundID& soundID : m_soundIDs)
+    {
+        soundID = MISSING_SOUND_ID;
+    }
+}
+
+void SoundCueTable::Resolve(const std::vector<Sound>& sounds, const std::string& ownerName)
+{
+    for (SoundID& soundID : m_soundIDs)
+    {
+        soundID = MISSING_SOUND_ID;
+    }
+    for (const Sound& sound : sounds)
+    {
+        SoundCue cue = GetSoundCueByName(sound.m_name);
+        if (cue == SoundCue::COUNT)
+        {
+            printf("SoundCueTable::Resolve    Sound \"%s\" of \"%s\" is not a sound cue, it never plays\n", sound.m_name.c_str(), ownerName.c_str());
+            continue;
+        }
+        m_soundIDs[static_cast<int>(cue)] = sound.GetSoundID();
+    }
+}
+
+void SoundCueTable::ReportIfMissing(SoundCue cue, const std::string& ownerName) const
+{
+    if (!HasSound(cue))
+        printf("SoundCueTable::ReportIfMissing    \"%s\" has no \"%s\" sound\n", ownerName.c_str(), GetSoundCueName(cue));
+}
+
+SoundID SoundCueTable::GetSoundID(SoundCue cue) const
+{
+    if (cue >= SoundCue::COUNT)
+        return MISSING_SOUND_ID;
+    return m_soundIDs[static_cast<int>(cue)];
+}
+
+bool SoundCueTable::HasSound(SoundCue cue) const
+{
+    return GetSoundID(cue) != MISSING_SOUND_ID;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+#include "Engine/Audio/AudioSystem.hpp"
+
+class Sound;
+
+/// Well known sound events of actors and weapons, authored as the "sound" attribute of a Sound element.
+enum class SoundCue : unsigned char
+{
+    FIRE,
+    HURT,
+    DEATH,
+    COUNT
+};
+
+static constexpr int SOUND_CUE_COUNT = static_cast<int>(SoundCue::COUNT);
+
+const char* GetSoundCueName(SoundCue cue); // Sound name authored for the cue, e.g. "Hurt".
+SoundCue    GetSoundCueByName(const std::string& name); // COUNT if the name is not a cue.
+
+/// SoundID of every cue of a definition, resolved once by name at load so playing a cue is an array read. A cue
+/// without a sound resolves to MISSING_SOUND_ID, which the voice manager ignores.
+class SoundCueTable
+{
+public:
+    SoundCueTable();
+
+    /// Fill the table from the sounds of a definition, sounds that are not a cue are reported.
+    void    Resolve(const std::vector<Sound>& sounds, const std::string& ownerName);
+    void    ReportIfMissing(SoundCue cue, const std::string& ownerName) const; // Logs a missing cue the definition needs.
+    SoundID GetSoundID(SoundCue cue) const;
+    bool    HasSound(SoundCue cue) const;
+
+private:
+    SoundID m_soundIDs[SOUND_CUE_COUNT];
+};
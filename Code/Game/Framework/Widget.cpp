@@ -10,6 +10,7 @@ Widget::Widget()
 
 Widget::~Widget()
 {
+    POINTER_SAFE_DELETE(m_geometryBuffer)
 }
 
 void Widget::BeginFrame()
@@ -18,6 +19,8 @@ void Widget::BeginFrame()
 
 void Widget::Render()
 {
+    if (m_bIsDirty)
+        RebuildGeometry();
     if (m_owner == nullptr) // means viewport
     {
         Camera* viewportCam = g_theWidgetSubsystem->m_config.m_viewportCamera;
@@ -79,3 +82,41 @@ void Widget::RemoveFromViewport()
 {
     m_bIsGarbage = true;
 }
+
+void Widget::MarkDirty()
+{
+    m_bIsDirty = true;
+}
+
+bool Widget::IsDirty() const
+{
+    return m_bIsDirty;
+}
+
+const Texture* Widget::BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const
+{
+    UNUSED(outVertexes)
+    return nullptr;
+}
+
+void Widget::DrawGeometry() const
+{
+    if (m_numGeometryVertexes == 0)
+        return;
+    g_theRenderer->BindTexture(m_geometryTexture);
+    g_theRenderer->DrawVertexBuffer(m_geometryBuffer, m_numGeometryVertexes);
+}
+
+void Widget::RebuildGeometry()
+{
+    m_bIsDirty = false;
+    m_geometryVertexes.clear();
+    m_geometryTexture     = BuildGeometry(m_geometryVertexes);
+    m_numGeometryVertexes = static_cast<int>(m_geometryVertexes.size());
+    g_theWidgetSubsystem->m_numGeometryRebuilds++;
+    if (m_numGeometryVertexes == 0)
+        return;
+    if (m_geometryBuffer == nullptr)
+        m_geometryBuffer = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+    g_theRenderer->CopyCPUToGPU(m_geometryVertexes.data(), m_geometryVertexes.size() * sizeof(Vertex_PCU), m_geometryBuffer);
+}
@@ -1,5 +1,11 @@
 ﻿#pragma once
+#include <vector>
+
 #include "PlayerController.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+
+class Texture;
+class VertexBuffer;
 
 class Widget
 {
@@ -24,11 +30,29 @@ public:
     virtual void AddToPlayerViewport(PlayerController* player, int zOrder = 0);
     virtual void RemoveFromViewport();
 
+    void MarkDirty(); // Rebuild the retained geometry before the next render.
+    bool IsDirty() const;
+
 protected:
+    /// Retained geometry, generated on the CPU only when the widget is dirty and drawn from a vertex buffer otherwise.
+    /// Returns the texture the geometry is drawn with, null for untextured geometry.
+    virtual const Texture* BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const;
+    void                   DrawGeometry() const; // Draw the retained geometry with the current shader and blend mode.
+
     PlayerController* m_owner      = nullptr; // If player controller is null it basic means that it is the viewport widget.
     int               m_zOrder     = 0;
     bool              m_bIsTick    = true;
     std::string       m_name       = "Untitled";
+    int               m_nameId     = -1; // Interned by the widget subsystem when the widget is added.
     bool              m_bIsVisible = true;
     bool              m_bIsGarbage = false;
+
+private:
+    void RebuildGeometry();
+
+    std::vector<Vertex_PCU> m_geometryVertexes; // Kept between rebuilds so rebuilding does not reallocate.
+    VertexBuffer*           m_geometryBuffer      = nullptr;
+    const Texture*          m_geometryTexture     = nullptr;
+    int                     m_numGeometryVertexes = 0;
+    bool                    m_bIsDirty            = true;
 };
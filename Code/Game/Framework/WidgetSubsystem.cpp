@@ -1,23 +1,16 @@
 ﻿#include "WidgetSubsystem.hpp"
 
+#include <algorithm>
+
 #include "Widget.hpp"
 
-bool DescendingZOrderPtr::operator()(const Widget* lhs, const Widget* rhs) const
+static void EraseWidget(std::vector<Widget*>& widgets, const Widget* widget)
 {
-    // If two pointers point to the same object, they are considered equivalent
-    if (lhs == rhs)
-    {
-        return false;
-    }
-    // If the zorder is the same, you need to define whether they are considered equal in the set.
-    // Here, in order to meet the strict weak ordering (Strict Weak Ordering), when the zorder is the same,
-    // We compare the pointers themselves to ensure that equal elements are not considered unequal in the set.
-    if (lhs->GetZOrder() == rhs->GetZOrder())
-    {
-        return lhs < rhs;
-    }
-    // Larger zorders are placed on the "left" (i.e. keys that are considered smaller in the collection)
-    return lhs->GetZOrder() > rhs->GetZOrder();
+    auto it = std::find(widgets.begin(), widgets.end(), widget);
+    if (it == widgets.end())
+        return;
+    *it = widgets.back();
+    widgets.pop_back();
 }
 
 WidgetSubsystem::WidgetSubsystem(WidgetSystemConfig config): m_config(config)
@@ -26,28 +19,17 @@ WidgetSubsystem::WidgetSubsystem(WidgetSystemConfig config): m_config(config)
 
 WidgetSubsystem::~WidgetSubsystem()
 {
-    for (Widget* widget : m_widgets)
-    {
-        delete widget;
-        widget = nullptr;
-    }
+    DeleteAllWidgets();
 }
 
 void WidgetSubsystem::BeginFrame()
 {
-    for (int i = 0; i < static_cast<int>(m_widgets.size()); ++i)
-    {
-        if (m_widgets[i] && m_widgets[i]->m_bIsGarbage)
-        {
-            delete m_widgets[i];
-            m_widgets[i] = nullptr;
-        }
-    }
+    CollectGarbageWidgets();
+    InsertPendingWidgets();
 
     for (Widget* widget : m_widgets)
     {
-        if (widget)
-            widget->BeginFrame();
+        widget->BeginFrame();
     }
 }
 
@@ -58,39 +40,48 @@ void WidgetSubsystem::Startup()
 
 void WidgetSubsystem::Shutdown()
 {
-    printf("WidgetSubsystem::Shutdown\n");
-    for (Widget* widget : m_widgets)
-    {
-        delete widget;
-        widget = nullptr;
-    }
-    m_widgets.clear();
+    printf("WidgetSubsystem::Shutdown    %d widget geometry rebuilds\n", m_numGeometryRebuilds);
+    DeleteAllWidgets();
 }
 
 void WidgetSubsystem::Update()
 {
+    m_bIsIterating = true;
     for (Widget* widget : m_widgets)
     {
-        if (widget && !widget->m_bIsGarbage)
+        if (!widget->m_bIsGarbage)
             widget->Update();
     }
+    m_bIsIterating = false;
 }
 
 void WidgetSubsystem::Render()
 {
+    InsertPendingWidgets();
+    RebuildDirtyGeometry();
+    m_bIsIterating = true;
     for (Widget* widget : m_widgets)
     {
-        if (widget && !widget->m_bIsGarbage)
+        if (!widget->m_bIsGarbage)
             widget->Render();
     }
+    m_bIsIterating = false;
+}
+
+void WidgetSubsystem::RebuildDirtyGeometry()
+{
+    for (Widget* widget : m_widgets)
+    {
+        if (!widget->m_bIsGarbage && widget->m_bIsDirty)
+            widget->RebuildGeometry();
+    }
 }
 
 void WidgetSubsystem::EndFrame()
 {
     for (Widget* widget : m_widgets)
     {
-        if (widget)
-            widget->EndFrame();
+        widget->EndFrame();
     }
 }
 
@@ -98,7 +89,7 @@ void WidgetSubsystem::AddToViewport(Widget* widget, int zOrder)
 {
     printf("WidgetSubsystem::AddToViewport      Add widget %s\n", widget->GetName().c_str());
     widget->m_zOrder = zOrder;
-    m_widgets.push_back(widget);
+    AddWidget(widget);
 }
 
 void WidgetSubsystem::AddToPlayerViewport(Widget* widget, PlayerController* player, int zOrder)
@@ -106,41 +97,132 @@ void WidgetSubsystem::AddToPlayerViewport(Widget* widget, PlayerController* play
     printf("WidgetSubsystem::AddToPlayerViewport        Add widget %s to player viewport\n", widget->GetName().c_str());
     widget->m_zOrder = zOrder;
     widget->m_owner  = player;
-    m_widgets.push_back(widget);
+    AddWidget(widget);
 }
 
 void WidgetSubsystem::RemoveFromViewport(Widget* widget)
 {
-    for (Widget* m_widget : m_widgets)
+    if (widget && !widget->m_bIsGarbage)
     {
-        if (m_widget == widget)
-        {
-            printf("WidgetSubsystem::RemoveFromViewport        Remove widget %s\n", widget->GetName().c_str());
-            m_widget->RemoveFromViewport();
-        }
+        printf("WidgetSubsystem::RemoveFromViewport        Remove widget %s\n", widget->GetName().c_str());
+        widget->RemoveFromViewport();
     }
 }
 
-void WidgetSubsystem::RemoveFromViewport(std::string widgetName)
+void WidgetSubsystem::RemoveFromViewport(const std::string& widgetName)
 {
-    for (Widget* widget : m_widgets)
+    auto it = m_widgetsByName.find(FindNameId(widgetName));
+    if (it == m_widgetsByName.end())
+        return;
+    for (Widget* widget : it->second)
     {
-        if (widget && widget->m_name == widgetName)
-        {
-            printf("WidgetSubsystem::RemoveFromViewport        Remove widget %s\n", widget->GetName().c_str());
-            widget->RemoveFromViewport();
-        }
+        RemoveFromViewport(widget);
     }
 }
 
-void WidgetSubsystem::RemoveFromPlayerViewport(PlayerController* player, std::string widgetName)
+void WidgetSubsystem::RemoveFromPlayerViewport(PlayerController* player, const std::string& widgetName)
 {
-    for (Widget* widget : m_widgets)
+    auto it = m_widgetsByOwner.find(player);
+    if (it == m_widgetsByOwner.end())
+        return;
+    int nameId = FindNameId(widgetName);
+    for (Widget* widget : it->second)
     {
-        if (widget && widget->m_name == widgetName && widget->m_owner == player)
+        if (widget->m_nameId == nameId && !widget->m_bIsGarbage)
         {
             printf("WidgetSubsystem::RemoveFromViewport        Remove player %d 's widget %s\n", player->m_index, widget->GetName().c_str());
             widget->RemoveFromViewport();
         }
     }
 }
+
+void WidgetSubsystem::RemoveAllFromPlayerViewport(PlayerController* player)
+{
+    auto it = m_widgetsByOwner.find(player);
+    if (it == m_widgetsByOwner.end())
+        return;
+    for (Widget* widget : it->second)
+    {
+        RemoveFromViewport(widget);
+    }
+}
+
+int WidgetSubsystem::GetNumWidgets() const
+{
+    return static_cast<int>(m_widgets.size() + m_pendingWidgets.size());
+}
+
+int WidgetSubsystem::GetNumGeometryRebuilds() const
+{
+    return m_numGeometryRebuilds;
+}
+
+int WidgetSubsystem::InternName(const std::string& widgetName)
+{
+    auto it = m_nameIds.find(widgetName);
+    if (it != m_nameIds.end())
+        return it->second;
+    int nameId = static_cast<int>(m_nameIds.size());
+    m_nameIds.emplace(widgetName, nameId);
+    return nameId;
+}
+
+int WidgetSubsystem::FindNameId(const std::string& widgetName) const
+{
+    auto it = m_nameIds.find(widgetName);
+    return it == m_nameIds.end() ? -1 : it->second;
+}
+
+void WidgetSubsystem::AddWidget(Widget* widget)
+{
+    widget->m_nameId = InternName(widget->m_name);
+    m_widgetsByName[widget->m_nameId].push_back(widget);
+    m_widgetsByOwner[widget->m_owner].push_back(widget);
+    m_pendingWidgets.push_back(widget);
+    if (!m_bIsIterating)
+        InsertPendingWidgets();
+}
+
+void WidgetSubsystem::InsertPendingWidgets()
+{
+    for (Widget* widget : m_pendingWidgets)
+    {
+        /// After every widget of the same z order, so equal z orders keep the order they were added in
+        auto it = std::upper_bound(m_widgets.begin(), m_widgets.end(), widget->m_zOrder, [](int zOrder, const Widget* other)
+        {
+            return zOrder < other->m_zOrder;
+        });
+        m_widgets.insert(it, widget);
+    }
+    m_pendingWidgets.clear();
+}
+
+void WidgetSubsystem::CollectGarbageWidgets()
+{
+    auto garbageBegin = std::stable_partition(m_widgets.begin(), m_widgets.end(), [](const Widget* widget)
+    {
+        return !widget->m_bIsGarbage;
+    });
+    for (auto it = garbageBegin; it != m_widgets.end(); ++it)
+    {
+        Widget* widget = *it;
+        EraseWidget(m_widgetsByName[widget->m_nameId], widget);
+        EraseWidget(m_widgetsByOwner[widget->m_owner], widget);
+        if (m_widgetsByOwner[widget->m_owner].empty())
+            m_widgetsByOwner.erase(widget->m_owner);
+        delete widget;
+    }
+    m_widgets.erase(garbageBegin, m_widgets.end());
+}
+
+void WidgetSubsystem::DeleteAllWidgets()
+{
+    InsertPendingWidgets();
+    for (Widget* widget : m_widgets)
+    {
+        delete widget;
+    }
+    m_widgets.clear();
+    m_widgetsByName.clear();
+    m_widgetsByOwner.clear();
+}
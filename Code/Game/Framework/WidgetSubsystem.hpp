@@ -1,6 +1,7 @@
 ﻿#pragma once
-#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Renderer/Camera.hpp"
@@ -15,11 +16,10 @@ struct WidgetSystemConfig
     Camera*     m_viewportCamera = nullptr;
 };
 
-struct DescendingZOrderPtr
-{
-    bool operator()(const Widget* lhs, const Widget* rhs) const;
-};
-
+/// Widgets are kept sorted by ascending z order, widgets of the same z order in the order they were added, and render
+/// in that order so the highest z order ends on top. Widgets added while the widgets update are held back until the next
+/// render or frame so the sorted list never changes under an iteration. Removed widgets are deleted and compacted away
+/// in BeginFrame. Widgets are indexed by interned name and by owning player so removals only touch their matches.
 class WidgetSubsystem
 {
     friend class Widget;
@@ -35,6 +35,7 @@ public:
     void Shutdown();
     void Update();
     void Render();
+    void RebuildDirtyGeometry(); // Rebuild the retained geometry of every dirty widget, Render does it before drawing.
 
     void EndFrame();
 
@@ -42,11 +43,28 @@ public:
     void AddToPlayerViewport(Widget* widget, PlayerController* player, int zOrder = 0);
     void RemoveFromViewport(Widget* widget);
     // I certainly need an reflect system to remove the widget by class
-    void RemoveFromViewport(std::string widgetName);
-    void RemoveFromPlayerViewport(PlayerController* player, std::string widgetName);
+    void RemoveFromViewport(const std::string& widgetName);
+    void RemoveFromPlayerViewport(PlayerController* player, const std::string& widgetName);
+    void RemoveAllFromPlayerViewport(PlayerController* player); // Before the player controller is deleted.
+
+    int GetNumWidgets() const;
+    int GetNumGeometryRebuilds() const; // Retained geometry rebuilds of every widget since startup.
 
 private:
+    int  InternName(const std::string& widgetName);
+    int  FindNameId(const std::string& widgetName) const; // -1 if no widget was ever added with the name.
+    void AddWidget(Widget* widget);
+    void InsertPendingWidgets();
+    void CollectGarbageWidgets();
+    void DeleteAllWidgets();
+
     WidgetSystemConfig   m_config;
-    std::vector<Widget*> m_widgets;
-    //std::set<Widget*, DescendingZOrderPtr> m_widgets;
+    std::vector<Widget*> m_widgets; // Sorted by ascending z order, stable.
+    std::vector<Widget*> m_pendingWidgets; // Added during the update, inserted before the next render.
+    bool                 m_bIsIterating        = false;
+    int                  m_numGeometryRebuilds = 0;
+
+    std::unordered_map<std::string, int>                              m_nameIds;
+    std::unordered_map<int, std::vector<Widget*>>                     m_widgetsByName;
+    std::unordered_map<const PlayerController*, std::vector<Widget*>> m_widgetsByOwner; // Viewport widgets are keyed by null.
 };
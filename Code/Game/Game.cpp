@@ -2,14 +2,19 @@
 
 #include "App.hpp"
 #include "GameCommon.hpp"
+#include "Framework/ByteBuffer.hpp"
+#include "Framework/InputRecording.hpp"
 #include "Framework/PlayerController.hpp"
 #include "Prop.hpp"
 #include "Definition/ActorDefinition.hpp"
+#include "Definition/DefinitionCache.hpp"
+#include "Definition/DefinitionHotReloader.hpp"
 #include "Definition/MapDefinition.hpp"
 #include "Definition/TileDefinition.hpp"
 #include "Definition/WeaponDefinition.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
 
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -23,16 +28,40 @@
 #include "Framework/ResourceSubsystem.hpp"
 #include "Framework/WidgetSubsystem.hpp"
 #include "Gameplay/Map.hpp"
+#include "Gameplay/Save/MapSnapshot.hpp"
 #include "Gameplay/Save/PlayerSaveSubsystem.hpp"
 #include "Gameplay/Widget/WidgetAttract.h"
+#include "Gameplay/Widget/WidgetLobby.hpp"
 
 Game::Game()
 {
+    m_frameArena.Startup(static_cast<size_t>(g_gameConfigBlackboard.GetValue("frameArenaKB", 256)) * 1024);
+
+    /// Definitions, a cold start parses the XML and cooks it, a warm start only reads the cooked files
+    DefinitionCache::s_bEnabled = g_gameConfigBlackboard.GetValue("useCookedDefinitions", true);
+    DefinitionCache::ResetStatistics();
+    double definitionStartTime = GetCurrentTimeSeconds();
     MapDefinition::LoadDefinitions("Data/Definitions/MapDefinitions.xml");
     TileDefinition::LoadDefinitions("Data/Definitions/TileDefinitions.xml");
     ActorDefinition::LoadDefinitions("Data/Definitions/ActorDefinitions.xml");
     ActorDefinition::LoadDefinitions("Data/Definitions/ProjectileActorDefinitions.xml");
     WeaponDefinition::LoadDefinitions("Data/Definitions/WeaponDefinitions.xml");
+    g_theResourceSubsystem->WaitForAssets(); // The definitions only queued their textures and images, the workers decoded them meanwhile.
+    MapDefinition::ResolveAllAssets();
+    ActorDefinition::ResolveAllAssets();
+    WeaponDefinition::ResolveAllAssets();
+    g_theResourceSubsystem->PrintResourceStatistics();
+    printf("Game::Game    %s start, loaded definitions in %.3f ms (%d cooked, %d from XML)\n", DefinitionCache::s_numXmlLoads == 0 ? "Warm" : "Cold",
+           (GetCurrentTimeSeconds() - definitionStartTime) * 1000.0, DefinitionCache::s_numCookedLoads, DefinitionCache::s_numXmlLoads);
+    if (g_gameConfigBlackboard.GetValue("definitionHotReload", false))
+    {
+        m_definitionReloader = new DefinitionHotReloader();
+        m_definitionReloader->WatchFile("Data/Definitions/ActorDefinitions.xml", ActorDefinition::ReloadDefinitions);
+        m_definitionReloader->WatchFile("Data/Definitions/ProjectileActorDefinitions.xml", ActorDefinition::ReloadDefinitions);
+        m_definitionReloader->WatchFile("Data/Definitions/WeaponDefinitions.xml", WeaponDefinition::ReloadDefinitions);
+        m_definitionReloader->Startup(g_gameConfigBlackboard.GetValue("definitionReloadPollSeconds", 0.5f));
+    }
+    /// 
 
     /// Event Register
     g_theEventSystem->SubscribeEventCallbackFunction("GameExitEvent", GameExitEvent);
@@ -72,6 +101,10 @@ Game::Game()
     m_clock = new Clock(Clock::GetSystemClock());
     ///
 
+    /// Input recording
+    m_inputReplayFilePath = g_gameConfigBlackboard.GetValue("inputReplayFile", "");
+    ///
+
     /// Game State
     g_theInput->SetCursorMode(CursorMode::POINTER);
     EnterState(GameState::ATTRACT);
@@ -79,9 +112,13 @@ Game::Game()
 
 Game::~Game()
 {
+    StopInputRecordingAndReplay();
     POINTER_SAFE_DELETE(m_map)
     POINTER_SAFE_DELETE(m_screenCamera)
     POINTER_SAFE_DELETE(m_worldCamera)
+    if (m_definitionReloader)
+        m_definitionReloader->Shutdown();
+    POINTER_SAFE_DELETE(m_definitionReloader)
     MapDefinition::ClearDefinitions();
     ActorDefinition::ClearDefinitions();
     WeaponDefinition::ClearDefinitions();
@@ -131,27 +168,40 @@ void Game::UpdateListeners(float deltaTime)
         Vec3 forward, left, up;
         controller->m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, up);
         g_theAudio->UpdateListener(controller->m_index - 1, controller->m_position, forward, up); // Index is an adjustment
+        g_theResourceSubsystem->SetSoundListenerPosition(controller->m_index - 1, controller->m_position);
     }
 }
 
 
 void Game::Update()
 {
+    ApplyDefinitionReloads();
+
     if (m_currentState == GameState::ATTRACT)
     {
         g_theInput->SetCursorMode(CursorMode::POINTER);
+        if (!m_inputReplayFilePath.empty())
+        {
+            StartInputReplay(m_inputReplayFilePath);
+            m_inputReplayFilePath.clear();
+        }
     }
 
+    BeginSimulationFrame();
+
     /// PlayerController
     if (m_currentState == GameState::PLAYING)
     {
         for (PlayerController* controller : m_localPlayerControllers)
         {
-            controller->Update(Clock::GetSystemClock().GetDeltaSeconds());
-            DebugAddMessage(Stringf("PlayerController position: %.2f, %.2f, %.2f", controller->m_position.x, controller->m_position.y, controller->m_position.z), 0);
-            DebugAddMessage(Stringf("PlayerController orientation: %.2f, %.2f, %.2f", controller->m_orientation.m_yawDegrees, controller->m_orientation.m_pitchDegrees,
-                                    controller->m_orientation.m_rollDegrees),
-                            0);
+            controller->Update(m_realDeltaSeconds);
+            if (IS_DEBUG_ENABLED())
+            {
+                DebugAddMessage(Stringf("PlayerController position: %.2f, %.2f, %.2f", controller->m_position.x, controller->m_position.y, controller->m_position.z), 0);
+                DebugAddMessage(Stringf("PlayerController orientation: %.2f, %.2f, %.2f", controller->m_orientation.m_yawDegrees, controller->m_orientation.m_pitchDegrees,
+                                        controller->m_orientation.m_rollDegrees),
+                                0);
+            }
         }
         UpdateListeners(Clock::GetSystemClock().GetDeltaSeconds());
     }
@@ -162,14 +212,26 @@ void Game::Update()
         m_map->Update();
     /// 
 
-    /// Debug Only
-    std::string debugGameState = Stringf("Time: %.2f FPS: %.1f Scale: %.2f",
-                                         m_clock->GetTotalSeconds(),
-                                         m_clock->GetFrameRate(),
-                                         m_clock->GetTimeScale()
-    );
+    /// Debug Only, the text is only built when shown so a steady state frame does not allocate
     g_theWidgetSubsystem->Update();
-    DebugAddScreenText(debugGameState, m_screenSpace, 14, 0);
+    if (IS_DEBUG_ENABLED())
+    {
+#ifdef COUNT_HEAP_ALLOCATIONS
+        std::string debugGameState = Stringf("Time: %.2f FPS: %.1f Scale: %.2f Heap Allocs: %d",
+                                             m_clock->GetTotalSeconds(),
+                                             m_clock->GetFrameRate(),
+                                             m_clock->GetTimeScale(),
+                                             m_numHeapAllocationsLastFrame
+        );
+#else
+        std::string debugGameState = Stringf("Time: %.2f FPS: %.1f Scale: %.2f",
+                                             m_clock->GetTotalSeconds(),
+                                             m_clock->GetFrameRate(),
+                                             m_clock->GetTimeScale()
+        );
+#endif
+        DebugAddScreenText(debugGameState, m_screenSpace, 14, 0);
+    }
     float deltaTime = m_clock->GetDeltaSeconds();
     UpdateCameras(deltaTime);
     HandleMouseEvent(deltaTime);
@@ -180,6 +242,86 @@ void Game::EndFrame()
 {
     if (m_map)
         m_map->EndFrame();
+    if (m_inputRecorder)
+        m_inputRecorder->EndFrame();
+    if (m_inputReplayer)
+        m_inputReplayer->EndFrame();
+
+    size_t numHeapAllocations     = GetNumHeapAllocations();
+    m_numHeapAllocationsLastFrame = static_cast<int>(numHeapAllocations - m_heapAllocationMark);
+    m_heapAllocationMark          = numHeapAllocations;
+    m_frameArena.Reset();
+}
+
+void Game::BeginSimulationFrame()
+{
+    m_realDeltaSeconds       = Clock::GetSystemClock().GetDeltaSeconds();
+    m_simulationDeltaSeconds = m_clock->GetDeltaSeconds();
+    if (m_currentState != GameState::PLAYING)
+        return;
+
+    if (m_inputReplayer)
+    {
+        if (!m_inputReplayer->ReadFrame(m_realDeltaSeconds, m_simulationDeltaSeconds))
+        {
+            printf("Game::BeginSimulationFrame    Input replay finished after %d frames\n", m_inputReplayer->GetFrameIndex() + 1);
+            g_theEventSystem->FireEvent("GameExitEvent");
+            return;
+        }
+    }
+    if (m_inputRecorder)
+        m_inputRecorder->BeginFrame(m_realDeltaSeconds, m_simulationDeltaSeconds);
+    m_simulationTotalSeconds += m_simulationDeltaSeconds;
+}
+
+void Game::StartInputRecording()
+{
+    std::string filePath = g_gameConfigBlackboard.GetValue("inputRecordFile", "");
+    if (filePath.empty() || m_inputReplayer || !m_map)
+        return;
+    InputRecordingHeader header;
+    header.m_randomSeed = m_map->GetRandomSeed();
+    header.m_mapName    = m_map->GetDefinition()->m_name;
+    for (PlayerController* controller : m_localPlayerControllers)
+    {
+        header.m_players.push_back(InputRecordingPlayer{controller->GetControllerIndex(), controller->GetInputDeviceType()});
+    }
+    m_inputRecorder = new InputRecorder(filePath, header);
+}
+
+void Game::StartInputReplay(const std::string& filePath)
+{
+    StopInputRecordingAndReplay();
+    auto replayer = new InputReplayer(filePath);
+    if (!replayer->IsValid())
+    {
+        delete replayer;
+        return;
+    }
+    m_inputReplayer = replayer;
+
+    /// Recreate the recorded players, the lobby is skipped
+    g_theWidgetSubsystem->RemoveFromViewport("WidgetAttract");
+    for (PlayerController* controller : m_localPlayerControllers)
+    {
+        POINTER_SAFE_DELETE(controller)
+    }
+    m_localPlayerControllers.clear();
+    for (const InputRecordingPlayer& player : m_inputReplayer->GetHeader().m_players)
+    {
+        CreateLocalPlayer(player.m_index, player.m_deviceType);
+    }
+    EnterState(GameState::PLAYING);
+}
+
+void Game::StopInputRecordingAndReplay()
+{
+    POINTER_SAFE_DELETE(m_inputRecorder)
+    if (m_inputReplayer)
+    {
+        m_inputReplayer->WriteTimingLog(g_gameConfigBlackboard.GetValue("inputReplayTimingLog", "ReplayTimings.csv"));
+        POINTER_SAFE_DELETE(m_inputReplayer)
+    }
 }
 
 
@@ -188,11 +330,12 @@ bool Game::GameExitEvent(EventArgs& args)
     UNUSED(args)
     printf("Event::GameStartEvent    Exiting game...\n");
     Game* game = g_theGame;
+    game->StopInputRecordingAndReplay();
     delete game->m_map;
     game->m_map = nullptr;
     game->m_localPlayerControllers.clear();
     game->EnterState(GameState::ATTRACT);
-    g_thePlayerSaveSubsystem->ClearSaves();
+    g_thePlayerSaveSubsystem->Flush();
     g_theInput->SetCursorMode(CursorMode::POINTER);
     return true;
 }
@@ -229,6 +372,7 @@ void Game::RemoveLocalPlayer(int id)
                                  if (controller && controller->GetControllerIndex() == id)
                                  {
                                      printf("Game::RemoveLocalPlayer     Remove Local Player with id: %d\n", id);
+                                     g_theWidgetSubsystem->RemoveAllFromPlayerViewport(controller);
                                      delete controller;
                                      return true;
                                  }
@@ -314,12 +458,17 @@ void Game::EnterPlayingState()
     printf("Event::GameStartEvent    Starting game...\n");
     g_theInput->SetCursorMode(CursorMode::FPS);
     g_theAudio->SetNumListeners(static_cast<int>(m_localPlayerControllers.size()));
+    g_theResourceSubsystem->SetNumSoundListeners(static_cast<int>(m_localPlayerControllers.size()));
     std::string defaultMapName = g_gameConfigBlackboard.GetValue("defaultMap", "Default");
-    m_map                      = new Map(this, MapDefinition::GetByName(defaultMapName));
+    if (m_inputReplayer)
+        defaultMapName = m_inputReplayer->GetHeader().m_mapName;
+    m_simulationTotalSeconds = 0.f;
+    m_map                    = new Map(this, MapDefinition::GetByName(defaultMapName));
     for (PlayerController* playerController : m_localPlayerControllers)
     {
         playerController->m_map = m_map;
     }
+    StartInputRecording();
     SoundID         mainMenuSoundID    = g_theAudio->CreateOrGetSound(g_gameConfigBlackboard.GetValue("gameMusic", ""));
     SoundPlaybackID mainMenuPlaybackID = g_theAudio->StartSound(mainMenuSoundID, true, 0.25f);
     g_theResourceSubsystem->CachedSoundPlaybackID(mainMenuPlaybackID, mainMenuSoundID);
@@ -345,6 +494,110 @@ void Game::HandleKeyBoardEvent(float deltaTime)
             g_theEventSystem->FireEvent("GameExitEvent");
         }
     }
+
+    if (m_currentState == GameState::PLAYING)
+    {
+        if (g_theInput->WasKeyJustPressed(KEYCODE_F10))
+            SaveMapSnapshot();
+        if (g_theInput->WasKeyJustPressed(KEYCODE_F11))
+            RestoreMapSnapshot();
+    }
+}
+
+void Game::ApplyDefinitionReloads()
+{
+    if (!m_definitionReloader || !m_definitionReloader->HasPendingReloads())
+        return;
+    std::vector<ActorDefinitionBinding> bindings;
+    if (m_map)
+        m_map->CaptureDefinitionBindings(bindings);
+    double startTime  = GetCurrentTimeSeconds();
+    int    numApplied = m_definitionReloader->ApplyPendingReloads();
+    if (m_map)
+        m_map->RebindDefinitions(bindings);
+    if (numApplied > 0)
+        DebugAddMessage(Stringf("Reloaded %d definition file(s) in %.2f ms", numApplied, (GetCurrentTimeSeconds() - startTime) * 1000.0), 3.f);
+}
+
+void Game::RunWidgetRebuildCheck()
+{
+    /// Widget frames without the renderer drawing, the geometry is rebuilt where Render would rebuild it
+    auto runFrames = [](const char* stage, int numExpectedFirstFrame)
+    {
+        constexpr int NUM_STEADY_FRAMES = 60;
+        for (int frame = 0; frame <= NUM_STEADY_FRAMES; frame++)
+        {
+            int numRebuildsBefore = g_theWidgetSubsystem->GetNumGeometryRebuilds();
+            g_theWidgetSubsystem->BeginFrame();
+            g_theWidgetSubsystem->Update();
+            g_theWidgetSubsystem->RebuildDirtyGeometry();
+            g_theWidgetSubsystem->EndFrame();
+            int numRebuilds = g_theWidgetSubsystem->GetNumGeometryRebuilds() - numRebuildsBefore;
+            int numExpected = frame == 0 ? numExpectedFirstFrame : 0;
+            if (numRebuilds != numExpected)
+                ERROR_AND_DIE(Stringf("Game::RunWidgetRebuildCheck    %s frame %d rebuilt %d widgets instead of %d", stage, frame, numRebuilds, numExpected))
+        }
+    };
+
+    /// The attract widget of the constructor is built once, then the same steps the attract screen takes on space
+    runFrames("Attract", 1);
+    CreateLocalPlayer(1, DeviceType::KEYBOARD_AND_MOUSE);
+    Widget* lobbyWidget = new WidgetLobby();
+    g_theWidgetSubsystem->AddToViewport(lobbyWidget);
+    g_theWidgetSubsystem->RemoveFromViewport("WidgetAttract");
+    runFrames("Lobby", 1);
+    CreateLocalPlayer(2, DeviceType::CONTROLLER);
+    runFrames("Lobby join", 1);
+    GetLocalPlayer(1)->SetInputDeviceType(DeviceType::CONTROLLER);
+    runFrames("Lobby device swap", 1);
+    RemoveLocalPlayer(2);
+    runFrames("Lobby leave", 1);
+
+    /// Back to the state the constructor left, the lobby is deleted before the attract screen starts its music again
+    RemoveLocalPlayer(1);
+    g_theWidgetSubsystem->RemoveFromViewport(lobbyWidget);
+    g_theWidgetSubsystem->BeginFrame();
+    EnterState(GameState::ATTRACT);
+    printf("Game::RunWidgetRebuildCheck    Steady attract and lobby frames rebuilt nothing, every lobby change rebuilt once\n");
+}
+
+void Game::SaveMapSnapshot()
+{
+    if (!m_map)
+        return;
+    std::string filePath = g_gameConfigBlackboard.GetValue("mapSnapshotFile", "MapSnapshot.bin");
+    if (MapSnapshot::SaveToFile(*m_map, filePath))
+        DebugAddMessage(Stringf("Map snapshot saved to %s", filePath.c_str()), 3.f);
+}
+
+void Game::RestoreMapSnapshot()
+{
+    std::string                filePath = g_gameConfigBlackboard.GetValue("mapSnapshotFile", "MapSnapshot.bin");
+    std::vector<unsigned char> buffer;
+    std::string                mapName;
+    MapSnapshotData            snapshot;
+    if (!ReadBinaryFileToBuffer(buffer, filePath) || !MapSnapshot::ParseBuffer(buffer, mapName, snapshot))
+    {
+        printf("Game::RestoreMapSnapshot    No valid map snapshot at \"%s\"\n", filePath.c_str());
+        return;
+    }
+    const MapDefinition* definition = MapDefinition::GetByName(mapName);
+    if (!definition)
+    {
+        printf("Game::RestoreMapSnapshot    Unknown map \"%s\" in the snapshot\n", mapName.c_str());
+        return;
+    }
+    if (!m_map || m_map->GetDefinition() != definition)
+    {
+        POINTER_SAFE_DELETE(m_map)
+        m_map = new Map(this, definition);
+        for (PlayerController* playerController : m_localPlayerControllers)
+        {
+            playerController->m_map = m_map;
+        }
+    }
+    MapSnapshot::Apply(*m_map, snapshot);
+    DebugAddMessage(Stringf("Map snapshot restored from %s", filePath.c_str()), 3.f);
 }
 
 void Game::HandleMouseEvent(float deltaTime)
@@ -3,11 +3,15 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Math/AABB2.hpp"
+#include "Framework/FrameArena.hpp"
 
 class Map;
 class PlayerController;
 class Clock;
 class Prop;
+class InputRecorder;
+class InputReplayer;
+class DefinitionHotReloader;
 
 enum class GameState
 {
@@ -56,6 +60,24 @@ public:
     /// Audio
     void UpdateListeners(float deltaTime);
 
+    /// Simulation and input recording
+    void BeginSimulationFrame(); // Pick the frame delta times from the clocks, or from the replay when one is running.
+    void StartInputRecording();
+    void StartInputReplay(const std::string& filePath); // Recreate the recorded players and start the recorded map.
+    void StopInputRecordingAndReplay();
+
+    /// Map snapshot
+    void SaveMapSnapshot(); // Write the running map to the snapshot file.
+    void RestoreMapSnapshot(); // Parse the snapshot file first, then switch to its map if another one is running and apply it.
+
+    /// Definition hot reload
+    void ApplyDefinitionReloads(); // Swap in the definition files the reloader parsed and re-point the live actors.
+
+    /// Widgets
+    /// Drive the attract and lobby widgets through steady frames, a join, a device swap and a leave without rendering,
+    /// die unless every steady frame rebuilds no geometry and every change rebuilds it exactly once.
+    void RunWidgetRebuildCheck();
+
     /// Game State
     GameState m_currentState = GameState::ATTRACT;
     GameState m_nextState    = GameState::ATTRACT;
@@ -77,6 +99,28 @@ public:
     Clock* m_clock = nullptr;
     /// 
 
+    /// Simulation, every gameplay system reads its frame time from here so a replay can drive it
+    float m_realDeltaSeconds       = 0.f; // System clock delta, drives the player controllers even while paused.
+    float m_simulationDeltaSeconds = 0.f; // Game clock delta, drives the map.
+    float m_simulationTotalSeconds = 0.f; // Accumulated game clock time since the map was created.
+    /// 
+
+    /// Transient memory, every frame container of the gameplay draws from the arena, rewound in EndFrame
+    FrameArena m_frameArena;
+    size_t     m_heapAllocationMark          = 0; // Heap allocation count when the frame started.
+    int        m_numHeapAllocationsLastFrame = 0;
+    /// 
+
+    /// Input recording
+    InputRecorder* m_inputRecorder       = nullptr;
+    InputReplayer* m_inputReplayer       = nullptr;
+    std::string    m_inputReplayFilePath = ""; // Replay requested by the config, started on the first update.
+    /// 
+
+    /// Definition hot reload
+    DefinitionHotReloader* m_definitionReloader = nullptr; // Only created when the config enables the hot reload.
+    /// 
+
     /// PlayerController
     std::vector<PlayerController*> m_localPlayerControllers;
     /// 
@@ -4,6 +4,8 @@
 /// Whether or not enable cosmic circle (developer)
 #define COSMIC
 //#define DEBUG_GRID
+/// Count every global operator new, shown per frame in the debug game state line (developer)
+//#define COUNT_HEAP_ALLOCATIONS
 
 #define PLAY_SOUND_CLICK(configKey) \
 do { \
@@ -1,15 +1,14 @@
 ﻿#include "Actor.hpp"
 
+#include <algorithm>
 #include <cstdio>
 
 #include "Weapon.hpp"
 #include "Engine/Core/EngineCommon.hpp"
-#include "Engine/Core/Timer.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/SpriteDefinition.hpp"
 #include "Game/Game.hpp"
@@ -17,7 +16,10 @@
 #include "Game/Definition/ActorDefinition.hpp"
 #include "Game/Definition/WeaponDefinition.hpp"
 #include "Game/Framework/AIController.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
 #include "Game/Framework/PlayerController.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 #include "Game/Framework/WidgetSubsystem.hpp"
 #include "Save/PlayerSaveSubsystem.hpp"
 #include "Widget/WidgetPlayerDeath.hpp"
@@ -25,7 +27,7 @@
 Actor::Actor(): m_position(Vec3(0, 0, 0)), m_orientation(EulerAngles(0, 0, 0)), m_bIsStatic(false), m_physicalHeight(2.0f), m_physicalRadius(1.0f), m_color(Rgba8::WHITE)
 {
     m_collisionZCylinder = ZCylinder(m_position, m_physicalRadius, m_physicalHeight, true);
-    InitLocalVertex();
+    m_lastPosition       = m_position;
     printf("Object::Actor    + Creating Actor at (%f, %f, %f)\n", m_position.x, m_position.y, m_position.z);
 }
 
@@ -33,7 +35,7 @@ Actor::Actor(const Vec3& position, const EulerAngles& orientation, const Rgba8&
     m_bIsStatic(bIsStatic), m_physicalHeight(physicalHeight), m_physicalRadius(physicalRadius), m_color(color)
 {
     m_collisionZCylinder = ZCylinder(m_position, m_physicalRadius, m_physicalHeight, true);
-    InitLocalVertex();
+    m_lastPosition       = m_position;
     printf("Object::Actor    + Creating Actor at (%f, %f, %f)\n", m_position.x, m_position.y, m_position.z);
 }
 
@@ -50,6 +52,7 @@ Actor::Actor(const SpawnInfo& spawnInfo)
     m_health             = definition->m_health;
     m_physicalRadius     = definition->m_physicsRadius;
     m_position           = spawnInfo.m_position;
+    m_lastPosition       = spawnInfo.m_position;
     m_velocity           = spawnInfo.m_velocity;
     m_orientation        = EulerAngles(spawnInfo.m_orientation);
     m_collisionZCylinder = ZCylinder(spawnInfo.m_position, m_physicalRadius, m_physicalHeight, true);
@@ -69,15 +72,17 @@ Actor::Actor(const SpawnInfo& spawnInfo)
     {
         m_color = Rgba8::RED;
     }
-
-    if (m_definition->m_visible)
-        InitLocalVertex();
     printf("Object::Actor    + Creating Actor at (%f, %f, %f)\n", m_position.x, m_position.y, m_position.z);
 }
 
 
 Actor::~Actor()
 {
+    if (m_map)
+    {
+        m_map->m_timerWheel.Cancel(m_animationEndTimer);
+        m_map->m_timerWheel.Cancel(m_corpseTimer);
+    }
     for (Weapon* weapon : m_weapons)
     {
         POINTER_SAFE_DELETE(weapon)
@@ -87,7 +92,148 @@ Actor::~Actor()
 }
 
 
-void Actor::PostInitialize()
+void Actor::SetRandomSeed(unsigned long long seed)
+{
+    m_randomStream.SetSeed(seed);
+    for (int i = 0; i < static_cast<int>(m_weapons.size()); ++i)
+    {
+        m_weapons[i]->m_randomStream.SetSeed(RandomStream::DeriveSeed(seed, static_cast<unsigned long long>(i)));
+    }
+}
+
+void Actor::WriteSnapshot(ByteBufferWriter& writer) const
+{
+    WriteVec3(writer, m_position);
+    WriteVec3(writer, m_lastPosition);
+    WriteEulerAngles(writer, m_orientation);
+    WriteVec3(writer, m_velocity);
+    WriteVec3(writer, m_acceleration);
+    writer.Write(m_health);
+    writer.Write(GetSecondsDead());
+    writer.Write(m_bIsDead);
+    writer.Write(m_bIsGarbage);
+    writer.Write(m_owner ? m_owner->m_handle.GetData() : 0u);
+    writer.Write(m_aiController ? m_aiController->GetTargetActorHandle().GetData() : 0u);
+    writer.Write(m_randomStream.GetSeed());
+    writer.Write(m_randomStream.GetCounter());
+    writer.Write(static_cast<unsigned char>(m_simulationState));
+
+    auto currentWeapon = std::find(m_weapons.begin(), m_weapons.end(), m_currentWeapon);
+    writer.Write(static_cast<signed char>(currentWeapon == m_weapons.end() ? -1 : currentWeapon - m_weapons.begin()));
+    writer.Write(static_cast<unsigned char>(m_weapons.size()));
+    for (const Weapon* weapon : m_weapons)
+    {
+        writer.Write(m_map->m_timerWheel.GetRemainingSeconds(weapon->m_refireTimer));
+        writer.Write(weapon->m_randomStream.GetSeed());
+        writer.Write(weapon->m_randomStream.GetCounter());
+    }
+}
+
+void Actor::ReadSnapshot(ByteBufferReader& reader, ActorSnapshot& outSnapshot)
+{
+    outSnapshot.m_position         = ReadVec3(reader);
+    outSnapshot.m_lastPosition     = ReadVec3(reader);
+    outSnapshot.m_orientation      = ReadEulerAngles(reader);
+    outSnapshot.m_velocity         = ReadVec3(reader);
+    outSnapshot.m_acceleration     = ReadVec3(reader);
+    outSnapshot.m_health           = reader.Read<float>();
+    outSnapshot.m_secondsDead      = reader.Read<float>();
+    outSnapshot.m_bIsDead          = reader.Read<bool>();
+    outSnapshot.m_bIsGarbage       = reader.Read<bool>();
+    outSnapshot.m_ownerHandleData  = reader.Read<unsigned int>();
+    outSnapshot.m_targetHandleData = reader.Read<unsigned int>();
+    outSnapshot.m_randomSeed       = reader.Read<unsigned long long>();
+    outSnapshot.m_randomCounter    = reader.Read<unsigned long long>();
+    outSnapshot.m_simulationState  = static_cast<ActorSimulationState>(reader.Read<unsigned char>());
+    outSnapshot.m_currentWeapon    = reader.Read<signed char>();
+
+    outSnapshot.m_weapons.resize(reader.Read<unsigned char>());
+    for (ActorSnapshot::WeaponState& weapon : outSnapshot.m_weapons)
+    {
+        weapon.m_refireSeconds = reader.Read<float>();
+        weapon.m_randomSeed    = reader.Read<unsigned long long>();
+        weapon.m_randomCounter = reader.Read<unsigned long long>();
+    }
+}
+
+void Actor::RestoreSnapshot(const ActorSnapshot& snapshot)
+{
+    m_position     = snapshot.m_position;
+    m_lastPosition = snapshot.m_lastPosition;
+    m_orientation  = snapshot.m_orientation;
+    m_velocity     = snapshot.m_velocity;
+    m_acceleration = snapshot.m_acceleration;
+    m_health       = snapshot.m_health;
+    m_bIsGarbage   = snapshot.m_bIsGarbage;
+    m_randomStream.SetSeed(snapshot.m_randomSeed);
+    m_randomStream.SetCounter(snapshot.m_randomCounter);
+
+    for (int i = 0; i < static_cast<int>(snapshot.m_weapons.size()) && i < static_cast<int>(m_weapons.size()); ++i)
+    {
+        const ActorSnapshot::WeaponState& weaponState = snapshot.m_weapons[i];
+        m_map->m_timerWheel.Cancel(m_weapons[i]->m_refireTimer);
+        if (weaponState.m_refireSeconds > 0.f)
+            m_weapons[i]->m_refireTimer = m_map->m_timerWheel.Schedule(weaponState.m_refireSeconds, {m_handle, TimerEventType::WEAPON_REFIRE, static_cast<unsigned char>(i)});
+        m_weapons[i]->m_randomStream.SetSeed(weaponState.m_randomSeed);
+        m_weapons[i]->m_randomStream.SetCounter(weaponState.m_randomCounter);
+    }
+    int currentWeapon = snapshot.m_currentWeapon;
+    m_currentWeapon   = currentWeapon >= 0 && currentWeapon < static_cast<int>(m_weapons.size()) ? m_weapons[currentWeapon] : nullptr;
+
+    /// Corpses keep their look, the dead flag is restored directly so the death sound does not play again
+    m_bIsDead = snapshot.m_bIsDead;
+    if (m_bIsDead)
+    {
+        m_deathTime = g_theGame->m_simulationTotalSeconds - snapshot.m_secondsDead;
+        ScheduleCorpseExpiry(m_definition->m_corpseLifetime - snapshot.m_secondsDead);
+        PlayAnimation(AnimationState::DEATH, true);
+    }
+    UpdateColliderPosition();
+    if (m_map && snapshot.m_simulationState != m_simulationState)
+        m_map->SetActorSimulationState(this, snapshot.m_simulationState);
+}
+
+ActorDefinitionBinding Actor::CaptureDefinitionBinding() const
+{
+    ActorDefinitionBinding binding;
+    binding.m_definitionName     = m_definition ? m_definition->m_name : "";
+    binding.m_animationGroupName = m_currentPlayingAnimationGroup ? m_currentPlayingAnimationGroup->m_name : "";
+    for (const Weapon* weapon : m_weapons)
+    {
+        binding.m_weaponDefinitionNames.push_back(weapon->m_definition->m_name);
+        binding.m_weaponAnimationNames.push_back(weapon->m_currentPlayingAnimation ? weapon->m_currentPlayingAnimation->m_name : "");
+    }
+    return binding;
+}
+
+void Actor::RebindDefinitions(const ActorDefinitionBinding& binding)
+{
+    ActorDefinition* definition = ActorDefinition::GetByName(binding.m_definitionName);
+    if (definition)
+        m_definition = definition;
+
+    /// The playing group follows the animation state through the reloaded state machine, the reload may have renamed
+    /// or removed the group that was playing
+    const AnimationStateMachine& stateMachine = m_definition->m_animationStates;
+    m_currentPlayingAnimationGroup            = nullptr;
+    if (!binding.m_animationGroupName.empty())
+        m_currentPlayingAnimationGroup = m_definition->GetAnimationGroup(stateMachine.GetAnimationId(m_animationState));
+    if (!m_currentPlayingAnimationGroup)
+    {
+        m_map->m_timerWheel.Cancel(m_animationEndTimer);
+        if (!stateMachine.IsFinal(m_animationState))
+            m_animationState = AnimationState::IDLE;
+    }
+
+    for (int i = 0; i < static_cast<int>(m_weapons.size()) && i < static_cast<int>(binding.m_weaponDefinitionNames.size()); ++i)
+    {
+        WeaponDefinition* weaponDefinition = WeaponDefinition::GetByName(binding.m_weaponDefinitionNames[i]);
+        if (weaponDefinition)
+            m_weapons[i]->RebindDefinition(weaponDefinition, binding.m_weaponAnimationNames[i]);
+    }
+}
+
+void Actor::PostInitialize(bool bApplyDieOnSpawn)
 {
     /// AI Controller
     if (m_definition->m_aiEnabled)
@@ -96,9 +242,8 @@ void Actor::PostInitialize()
         m_controller   = m_aiController;
         m_controller->Possess(m_handle);
     }
-    m_currentWeapon  = m_weapons.empty() ? nullptr : m_weapons[0];
-    m_animationTimer = new Timer(0, g_theGame->m_clock); // Create timer
-    if (m_definition->m_dieOnSpawn)
+    m_currentWeapon = m_weapons.empty() ? nullptr : m_weapons[0];
+    if (bApplyDieOnSpawn && m_definition->m_dieOnSpawn)
         SetActorDead();
 }
 
@@ -106,17 +251,9 @@ void Actor::Update(float deltaSeconds)
 {
     UNUSED(deltaSeconds)
     UpdateAnimation(deltaSeconds);
-    if (m_bIsDead)
-        m_dead += deltaSeconds;
-    if (m_dead > m_definition->m_corpseLifetime)
-        m_bIsGarbage = true;
-
-    /// Shitty code :D
-    m_collisionZCylinder.m_center.x = m_position.x;
-    m_collisionZCylinder.m_center.y = m_position.y;
-    m_collisionZCylinder.m_center.z = m_position.z + m_physicalHeight / 2.0f;
+    UpdateColliderPosition();
 
-    if (m_definition->m_simulated && m_dead == 0.f)
+    if (m_definition->m_simulated && !m_bIsDead)
     {
         UpdatePhysics(deltaSeconds);
         if (m_aiController)
@@ -129,17 +266,47 @@ void Actor::UpdateAnimation(float deltaSeconds)
     UNUSED(deltaSeconds)
     if (!m_currentPlayingAnimationGroup)
         return;
-    if (m_animationTimer->GetElapsedTime() > m_currentPlayingAnimationGroup->GetAnimationLength())
-    {
-        m_currentPlayingAnimationGroup = nullptr;
-        m_animationTimer->Stop();
-    }
     if (m_definition->m_runSpeed != 0.f) // Zero safe check
         m_animationTimerSpeedMultiplier = m_velocity.GetLength() / m_definition->m_runSpeed;
 }
 
+void Actor::OnAnimationEnd()
+{
+    m_currentPlayingAnimationGroup = nullptr;
+    if (!m_definition->m_animationStates.IsFinal(m_animationState))
+        m_animationState = AnimationState::IDLE;
+    // A corpse has nothing left to update once its death animation is over, the corpse expiry is a map timer.
+    if (m_bIsDead && m_simulationState == ActorSimulationState::ACTIVE)
+    {
+        m_velocity = Vec3::ZERO;
+        m_map->SetActorSimulationState(this, ActorSimulationState::SLEEPING);
+    }
+}
+
+void Actor::OnCorpseExpired()
+{
+    m_bIsGarbage = true;
+}
+
+void Actor::ScheduleCorpseExpiry(float delaySeconds)
+{
+    m_map->m_timerWheel.Cancel(m_corpseTimer);
+    m_corpseTimer = m_map->m_timerWheel.Schedule(delaySeconds, {m_handle, TimerEventType::CORPSE_EXPIRE, 0});
+}
+
+float Actor::GetSecondsDead() const
+{
+    return m_bIsDead ? g_theGame->m_simulationTotalSeconds - m_deathTime : 0.f;
+}
+
+float Actor::GetAnimationElapsedSeconds() const
+{
+    return g_theGame->m_simulationTotalSeconds - m_animationStartTime;
+}
+
 void Actor::UpdatePhysics(float deltaSeconds)
 {
+    m_lastPosition = m_position;
     float dragValue = m_definition->m_drag;
     Vec3  dragForce = -m_velocity * dragValue;
     AddForce(dragForce);
@@ -162,6 +329,7 @@ void Actor::AddForce(Vec3 force)
 void Actor::AddImpulse(Vec3 impulse)
 {
     m_velocity += impulse;
+    WakeUp();
 }
 
 void Actor::MoveInDirection(Vec3 direction, float speed)
@@ -173,6 +341,33 @@ void Actor::MoveInDirection(Vec3 direction, float speed)
     AddForce(force);
 }
 
+bool Actor::IsStaticActor() const
+{
+    if (m_bIsStatic)
+        return true;
+    if (!m_definition)
+        return false;
+    return !m_definition->m_visible && !m_definition->m_collidesWithActors && !m_definition->m_collidesWithWorld && !m_definition->m_aiEnabled;
+}
+
+bool Actor::CanSleep() const
+{
+    constexpr float SLEEP_VELOCITY_SQUARED = 0.0001f;
+    if (m_currentPlayingAnimationGroup)
+        return false;
+    if (m_bIsDead)
+        return true; // Corpses keep their controllers until they expire, but neither physics nor AI runs on them.
+    if (m_controller || m_aiController || m_owner)
+        return false;
+    return m_velocity.GetLengthSquared() < SLEEP_VELOCITY_SQUARED && m_acceleration == Vec3::ZERO;
+}
+
+void Actor::WakeUp()
+{
+    if (m_simulationState == ActorSimulationState::SLEEPING && m_map)
+        m_map->WakeActor(this);
+}
+
 void Actor::TurnInDirection(Vec3 direction)
 {
     m_orientation = EulerAngles(direction);
@@ -183,6 +378,13 @@ ZCylinder& Actor::GetColliderZCylinder()
     return m_collisionZCylinder;
 }
 
+void Actor::UpdateColliderPosition()
+{
+    m_collisionZCylinder.m_center.x = m_position.x;
+    m_collisionZCylinder.m_center.y = m_position.y;
+    m_collisionZCylinder.m_center.z = m_position.z + m_physicalHeight / 2.0f;
+}
+
 
 void Actor::OnColliedEnter(Actor* other)
 {
@@ -201,7 +403,7 @@ void Actor::OnColliedEnter(Actor* other)
         {
             return;
         }
-        float randomDamage = g_rng->RollRandomFloatInRange(m_definition->m_damageOnCollide.m_min, m_definition->m_damageOnCollide.m_max);
+        float randomDamage = m_randomStream.RollRandomFloatInRange(m_definition->m_damageOnCollide.m_min, m_definition->m_damageOnCollide.m_max);
         other->Damage(randomDamage, m_owner->m_handle);
         Vec3 forward, left, right;
         m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, right);
@@ -216,7 +418,7 @@ void Actor::OnColliedEnter(Actor* other)
         {
             return;
         }
-        float randomDamage = g_rng->RollRandomFloatInRange(other->m_definition->m_damageOnCollide.m_min, other->m_definition->m_damageOnCollide.m_max);
+        float randomDamage = other->m_randomStream.RollRandomFloatInRange(other->m_definition->m_damageOnCollide.m_min, other->m_definition->m_damageOnCollide.m_max);
         Damage(randomDamage, other->m_handle);
         Vec3 forward, left, right;
         other->m_orientation.GetAsVectors_IFwd_JLeft_KUp(forward, left, right);
@@ -224,44 +426,16 @@ void Actor::OnColliedEnter(Actor* other)
         other->SetActorDead();
         return;
     }
+}
 
-    ///
-    if (other->m_definition->m_collidesWithActors)
-    {
-        float A_bottom = m_position.z;
-        float A_top    = m_position.z + m_physicalHeight;
-        float B_bottom = other->m_position.z;
-        float B_top    = other->m_position.z + other->m_physicalHeight;
+void Actor::OnColliedStay(Actor* other)
+{
+    UNUSED(other)
+}
 
-        auto rangeA = FloatRange(A_bottom, A_top);
-        auto rangeB = FloatRange(B_bottom, B_top);
-        if (rangeA.IsOverlappingWith(rangeB))
-        {
-            auto pos2D      = Vec2(m_position.x, m_position.y);
-            auto otherPos2D = Vec2(other->m_position.x, other->m_position.y);
-            PushDiscsOutOfEachOther2D(otherPos2D, other->m_physicalRadius, pos2D, m_physicalRadius);
-            //PushDiscOutOfDisc2D(otherPos2D, other->m_physicalRadius, pos2D, m_physicalRadius);
-            other->m_position = Vec3(otherPos2D.x, otherPos2D.y, other->m_position.z);
-        }
-        else
-        {
-            // Calculate penetration depths
-            float overlapDown = A_top - B_bottom; // How much B intrudes from below
-            float overlapUp   = B_top - A_bottom; // How much B intrudes from above
-
-            // Choose minimal displacement direction:
-            if (overlapDown < overlapUp)
-            {
-                // Push B downward so its bottom touches A_top
-                other->m_position.z = A_top;
-            }
-            else
-            {
-                // Push B upward so its top touches A_bottom
-                other->m_position.z = A_bottom - other->m_physicalHeight;
-            }
-        }
-    }
+void Actor::OnColliedExit(Actor* other)
+{
+    UNUSED(other)
 }
 
 void Actor::OnColliedEnter(AABB2& tileXYBound)
@@ -303,52 +477,44 @@ void Actor::OnColliedEnter(AABB3& tileXYZBound)
 
 void Actor::Damage(float damage, ActorHandle instigator)
 {
+    WakeUp();
     m_health -= damage;
     printf("Actor::Damage    Actor %s was Damaged, health now %f\n", m_definition->m_name.c_str(), m_health);
 
-    /// Sound with disable duplication sounds
-    SoundID actorDamagedSound = m_definition->GetSoundByName("Hurt")->GetSoundID();
-    auto    it                = m_soundPlaybackIDs.find(actorDamagedSound);
-    if (it != m_soundPlaybackIDs.end())
-    {
-        SoundPlaybackID playbackID = it->second;
-        if (!g_theAudio->IsPlaying(playbackID))
-        {
-            SoundPlaybackID id = g_theAudio->StartSoundAt(actorDamagedSound, m_position);
-            m_soundPlaybackIDs.insert(std::pair<SoundID, SoundPlaybackID>(id, actorDamagedSound));
-        }
-    }
-    else
-    {
-        SoundPlaybackID id = g_theAudio->StartSoundAt(actorDamagedSound, m_position);
-        m_soundPlaybackIDs.insert(std::pair<SoundID, SoundPlaybackID>(id, actorDamagedSound));
-    }
-
+    /// The actor is the emitter, its hurt sound does not restart while still playing
+    g_theResourceSubsystem->PlaySoundAt(m_definition->GetSoundCue(SoundCue::HURT), m_position, SoundPriority::NORMAL, m_handle.GetData());
 
     if (m_health <= 0.f)
     {
         SetActorDead();
-        auto instigatorController = dynamic_cast<PlayerController*>(m_map->GetActorByHandle(instigator)->m_controller);
-        auto targetController     = dynamic_cast<PlayerController*>(m_controller);
+        Actor* instigatorActor      = m_map->GetActorByHandle(instigator);
+        auto   instigatorController = instigatorActor ? dynamic_cast<PlayerController*>(instigatorActor->m_controller) : nullptr;
+        auto   targetController     = dynamic_cast<PlayerController*>(m_controller);
         if (instigatorController && targetController)
         {
-            g_thePlayerSaveSubsystem->GetPlayerSaveData(targetController->m_index)->m_numOfDeaths++;
-            g_thePlayerSaveSubsystem->GetPlayerSaveData(instigatorController->m_index)->m_numOfKilled++;
+            g_thePlayerSaveSubsystem->RecordDeath(targetController->m_index);
+            g_thePlayerSaveSubsystem->RecordKill(instigatorController->m_index);
         }
     }
+    else
+    {
+        PlayAnimation(AnimationState::HURT);
+    }
     if (m_aiController)
         m_aiController->DamagedBy(instigator);
 }
 
 bool Actor::SetActorDead(bool bNewDead)
 {
-    m_bIsDead = bNewDead;
-    PlayAnimationByName("Death", true);
-    if (m_definition->GetSoundByName("Death"))
+    bool bWasDead = m_bIsDead;
+    m_bIsDead     = bNewDead;
+    if (m_bIsDead && !bWasDead)
     {
-        SoundID actorDamagedSound = m_definition->GetSoundByName("Death")->GetSoundID();
-        g_theAudio->StartSoundAt(actorDamagedSound, m_position);
+        m_deathTime = g_theGame->m_simulationTotalSeconds;
+        ScheduleCorpseExpiry(m_definition->m_corpseLifetime);
     }
+    PlayAnimation(AnimationState::DEATH, true);
+    g_theResourceSubsystem->PlaySoundAt(m_definition->GetSoundCue(SoundCue::DEATH), m_position, SoundPriority::HIGH, m_handle.GetData());
 
     // Handel Player Actor Death.
     /*PlayerController* player = dynamic_cast<PlayerController*>(m_controller);
@@ -357,23 +523,6 @@ bool Actor::SetActorDead(bool bNewDead)
         WidgetPlayerDeath* playerDeathWidget = new WidgetPlayerDeath();
         g_theWidgetSubsystem->AddToPlayerViewport(playerDeathWidget, player);
     }*/
-
-    for (Vertex_PCU& m_vertex : m_vertexes)
-    {
-        m_vertex.m_color = m_vertex.m_color * 0.4f;
-    }
-    for (Vertex_PCU& m_vertexes_wireframe : m_vertexesWireframe)
-    {
-        m_vertexes_wireframe.m_color = m_vertexes_wireframe.m_color * 0.4f;
-    }
-    for (Vertex_PCU& m_vertexes_cone : m_vertexesCone)
-    {
-        m_vertexes_cone.m_color = m_vertexes_cone.m_color * 0.4f;
-    }
-    for (Vertex_PCU& m_vertexes_cone_wireframe : m_vertexesConeWireframe)
-    {
-        m_vertexes_cone_wireframe.m_color = m_vertexes_cone_wireframe.m_color * 0.4f;
-    }
     return m_bIsDead;
 }
 
@@ -404,6 +553,8 @@ void Actor::Render(PlayerController* toPlayer) const
 {
     if (!PredicateRender(toPlayer))
         return;
+    if (m_map->m_bDrawActorColliders)
+        RenderCollider();
     Mat44 localToWorldMat;
     if (m_definition->m_billboardType == "None")
         localToWorldMat = GetModelToWorldTransform();
@@ -445,7 +596,7 @@ void Actor::Render(PlayerController* toPlayer) const
     }
 
     const SpriteAnimDefinition* anim         = &animationGroup->GetSpriteAnimation(viewingDirection);
-    const SpriteDefinition      spriteAtTime = anim->GetSpriteDefAtTime(m_animationTimer->GetElapsedTime() * 1); // TODO: Handle animation speed.
+    const SpriteDefinition      spriteAtTime = anim->GetSpriteDefAtTime(GetAnimationElapsedSeconds() * 1); // TODO: Handle animation speed.
     AABB2                       uvAtTime     = spriteAtTime.GetUVs();
 
 
@@ -456,19 +607,18 @@ void Actor::Render(PlayerController* toPlayer) const
     Vec3 topRight     = bottomRight + Vec3(0, 0, m_definition->m_size.y);
 
     /// Create geometry.
-    bool                       bIsLit = m_definition->m_renderLit;
-    std::vector<Vertex_PCUTBN> vertexesLit;
-    std::vector<Vertex_PCU>    vertexesUnlit;
+    bool                        bIsLit        = m_definition->m_renderLit;
+    std::vector<Vertex_PCUTBN>& vertexesLit   = m_map->m_actorLitVertexes;
+    std::vector<Vertex_PCU>&    vertexesUnlit = m_map->m_actorUnlitVertexes;
     if (bIsLit)
     {
+        vertexesLit.clear();
         if (m_definition->m_renderRounded)
         {
-            vertexesLit.reserve(8192);
             AddVertsForRoundedQuad3D(vertexesLit, bottomLeft, bottomRight, topRight, topLeft, Rgba8::WHITE, uvAtTime);
         }
         else
         {
-            vertexesUnlit.reserve(8192);
             AddVertsForQuad3D(vertexesLit, bottomLeft, bottomRight, topRight, topLeft, Rgba8::WHITE, uvAtTime);
         }
         g_theRenderer->SetModelConstants(localToWorldMat, Rgba8::WHITE);
@@ -482,7 +632,7 @@ void Actor::Render(PlayerController* toPlayer) const
 
     if (!bIsLit)
     {
-        vertexesUnlit.reserve(8192);
+        vertexesUnlit.clear();
         AddVertsForQuad3D(vertexesUnlit, bottomLeft, bottomRight, topRight, topLeft, Rgba8::WHITE, uvAtTime);
         g_theRenderer->SetModelConstants(localToWorldMat, Rgba8::WHITE);
         g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
@@ -492,20 +642,25 @@ void Actor::Render(PlayerController* toPlayer) const
         ///g_theRenderer->BindTexture(nullptr);
         g_theRenderer->DrawVertexArray(vertexesUnlit);
         g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
-        return;
     }
+}
 
-    g_theRenderer->SetModelConstants(localToWorldMat, m_color);
+void Actor::RenderCollider() const
+{
+    /// The color of this actor and its death darkening go in the model color
+    Rgba8 tint = m_bIsDead ? m_color * 0.4f : m_color;
+    g_theRenderer->SetModelConstants(GetModelToWorldTransform(), tint);
+    g_theRenderer->BindShader(nullptr);
     g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
-    g_theRenderer->BindTexture(m_texture);
-    g_theRenderer->DrawVertexArray(m_vertexes);
+    g_theRenderer->BindTexture(nullptr);
+    m_definition->DrawDebugMesh(ActorDebugMesh::CYLINDER);
     if (!m_owner)
-        g_theRenderer->DrawVertexArray(m_vertexesCone);
+        m_definition->DrawDebugMesh(ActorDebugMesh::CONE);
 
     g_theRenderer->SetRasterizerMode(RasterizerMode::WIREFRAME_CULL_BACK);
-    g_theRenderer->DrawVertexArray(m_vertexesWireframe);
+    m_definition->DrawDebugMesh(ActorDebugMesh::CYLINDER_WIREFRAME);
     if (!m_owner)
-        g_theRenderer->DrawVertexArray(m_vertexesConeWireframe);
+        m_definition->DrawDebugMesh(ActorDebugMesh::CONE_WIREFRAME);
     g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
 }
 
@@ -535,6 +690,7 @@ Mat44 Actor::GetModelToWorldTransform() const
 void Actor::OnPossessed(Controller* controller)
 {
     m_controller = controller;
+    WakeUp();
 }
 
 void Actor::OnUnpossessed()
@@ -547,56 +703,16 @@ void Actor::OnUnpossessed()
 }
 
 
-AnimationGroup* Actor::PlayAnimationByName(std::string animationName, bool force)
+AnimationGroup* Actor::PlayAnimation(AnimationState state, bool force)
 {
-    AnimationGroup* foundedGroup = m_definition->GetAnimationGroupByName(animationName);
-    if (foundedGroup)
-    {
-        if (foundedGroup == m_currentPlayingAnimationGroup)
-        {
-            return foundedGroup;
-        }
-        /// We want to replace to new animation, force update it whether or not it finished
-        if (force)
-        {
-            m_currentPlayingAnimationGroup = foundedGroup;
-            m_animationTimer->Start();
-            return foundedGroup;
-        }
-        if (m_currentPlayingAnimationGroup)
-        {
-            bool isCurrentAnimFinished = m_animationTimer->GetElapsedTime() >= m_currentPlayingAnimationGroup->GetAnimationLength();
-            if (isCurrentAnimFinished)
-            {
-                m_currentPlayingAnimationGroup = foundedGroup;
-                m_animationTimer->Start();
-                return foundedGroup;
-            }
-        }
-        else
-        {
-            m_currentPlayingAnimationGroup = foundedGroup;
-            m_animationTimer->Start();
-            return foundedGroup;
-        }
-    }
-    return nullptr;
-}
-
-void Actor::InitLocalVertex()
-{
-    if (m_physicalHeight <= 0.001f || m_physicalRadius <= 0.001f)
-    {
-        return;
-    }
-    m_vertexes.reserve(8192);
-    // TODO: consider give a better way to handle base center ZCylinder
-    ZCylinder localCylinder = m_collisionZCylinder;
-    localCylinder.m_center  = Vec3(0, 0, m_physicalHeight / 2.0f);
-    AddVertsForCylinderZ3D(m_vertexes, localCylinder, m_color * 0.5f, AABB2::ZERO_TO_ONE);
-    AddVertsForCylinderZ3D(m_vertexesWireframe, localCylinder, m_color, AABB2::ZERO_TO_ONE);
-    auto localConeStartPoint = Vec3(m_definition->m_physicsRadius - 0.05f, 0, m_definition->m_eyeHeight * 0.85f);
-    Vec3 localConeEndPoint   = localConeStartPoint + Vec3(m_definition->m_physicsRadius / 2.f, 0, 0);
-    AddVertsForCone3D(m_vertexesCone, localConeEndPoint, localConeStartPoint, m_definition->m_physicsHeight / 5.0f, m_color * 0.5f);
-    AddVertsForCone3D(m_vertexesConeWireframe, localConeEndPoint, localConeStartPoint, m_definition->m_physicsHeight / 5.0f, m_color);
+    const AnimationStateMachine& stateMachine      = m_definition->m_animationStates;
+    if (!stateMachine.CanTransition(m_animationState, m_currentPlayingAnimationGroup != nullptr, state, force))
+        return state == m_animationState ? m_currentPlayingAnimationGroup : nullptr;
+    m_currentPlayingAnimationGroup = m_definition->GetAnimationGroup(stateMachine.GetAnimationId(state));
+    m_animationState               = state;
+    m_animationStartTime           = g_theGame->m_simulationTotalSeconds;
+    m_map->m_timerWheel.Cancel(m_animationEndTimer);
+    if (m_currentPlayingAnimationGroup)
+        m_animationEndTimer = m_map->m_timerWheel.Schedule(m_currentPlayingAnimationGroup->GetAnimationLength(), {m_handle, TimerEventType::ACTOR_ANIMATION_END, 0});
+    return m_currentPlayingAnimationGroup;
 }
@@ -2,6 +2,7 @@
 #include <vector>
 
 #include "Map.hpp"
+#include "TimerWheel.hpp"
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Math/EulerAngles.hpp"
@@ -10,10 +11,14 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/ZCylinder.hpp"
 #include "Game/Framework/ActorHandle.hpp"
+#include "Game/Framework/AnimationState.hpp"
+#include "Game/Framework/RandomStream.hpp"
 #include "Game/Framework/Sound.hpp"
 
 
 class AnimationGroup;
+class ByteBufferWriter;
+class ByteBufferReader;
 class Controller;
 class AIController;
 class Weapon;
@@ -24,6 +29,52 @@ class AABB3;
 class AABB2;
 class Texture;
 
+/// Which per-frame list of the map the actor lives in.
+enum class ActorSimulationState
+{
+    ACTIVE, // Updated and collided every frame.
+    SLEEPING, // At rest without any controller, skipped until an impulse, damage or collision wakes it up.
+    STATIONARY, // Never moves (spawn points, static props), never enters the per-frame loops.
+};
+
+/// Names of the definitions an actor points into, captured before a definition hot reload so the actor can be
+/// re-pointed at the reloaded definitions afterwards.
+struct ActorDefinitionBinding
+{
+    std::string              m_definitionName;
+    std::string              m_animationGroupName; // Empty if no animation group is playing.
+    std::vector<std::string> m_weaponDefinitionNames; // Per weapon slot.
+    std::vector<std::string> m_weaponAnimationNames; // Per weapon slot, empty if no animation is playing.
+};
+
+/// Per actor state of a map snapshot, parsed on its own so the map can validate the whole snapshot before it
+/// touches any of its running actors.
+struct ActorSnapshot
+{
+    struct WeaponState
+    {
+        float              m_refireSeconds = 0.f; // Remaining refire delay, 0 if the weapon is ready.
+        unsigned long long m_randomSeed    = 0;
+        unsigned long long m_randomCounter = 0;
+    };
+
+    Vec3                     m_position;
+    Vec3                     m_lastPosition;
+    EulerAngles              m_orientation;
+    Vec3                     m_velocity;
+    Vec3                     m_acceleration;
+    float                    m_health           = 1.f;
+    float                    m_secondsDead      = 0.f;
+    bool                     m_bIsDead          = false;
+    bool                     m_bIsGarbage       = false;
+    unsigned int             m_ownerHandleData  = 0; // Raw handle data, the map relinks it once every actor exists.
+    unsigned int             m_targetHandleData = 0; // Raw handle data of the AI target.
+    unsigned long long       m_randomSeed       = 0;
+    unsigned long long       m_randomCounter    = 0;
+    ActorSimulationState     m_simulationState  = ActorSimulationState::ACTIVE;
+    int                      m_currentWeapon    = -1; // Weapon slot, -1 if none.
+    std::vector<WeaponState> m_weapons;
+};
 
 class Actor
 {
@@ -38,6 +89,7 @@ public:
     EulerAngles m_orientation; // 3D orientation, as EulerAngles, in degrees.
     Vec3        m_velocity; // 3D velocity, as a Vec3, in world units per second.
     Vec3        m_acceleration; // 3D acceleration, as a Vec3, in world units per second squared.
+    Vec3        m_lastPosition; // Position before the latest physics integration, used to sweep fast movers.
 
     bool  m_bIsStatic;
     float m_physicalHeight;
@@ -50,7 +102,7 @@ public:
     ActorHandle      m_handle     = ActorHandle::INVALID; // This actor's handle, assigned by the map when this actor was spawned.
     float            m_health     = 1.f; // Current health.
     Actor*           m_owner      = nullptr; //Only applies to projectile actors. Actor that fired this projectile, for purposes of collision filtering.
-    float            m_dead       = 0.f; // Any data needed to track if and how long we have been dead.
+    float            m_deathTime  = 0.f; // Simulation time of the death, the corpse expires m_corpseLifetime later.
     bool             m_bIsDead    = false;
     bool             m_bIsGarbage = false; // If true, this actor is no longer needed and can be safely deleted.
 
@@ -64,28 +116,52 @@ public:
     std::vector<Weapon*> m_weapons;
     Weapon*              m_currentWeapon = nullptr;
 
+    /// Simulation
+    ActorSimulationState m_simulationState     = ActorSimulationState::ACTIVE;
+    int                  m_simulationListIndex = -1; // Index inside the map list that matches m_simulationState.
+    unsigned int         m_lastPushedStep      = 0; // Actor collision step of the map that last pushed this actor.
+
+    /// Random
+    RandomStream m_randomStream; // Collision damage rolls, seeded by the map from its seed and this actor uid.
+
 private:
-    ZCylinder               m_collisionZCylinder;
-    std::vector<Vertex_PCU> m_vertexes;
-    std::vector<Vertex_PCU> m_vertexesCone;
-    std::vector<Vertex_PCU> m_vertexesWireframe;
-    std::vector<Vertex_PCU> m_vertexesConeWireframe;
-    Texture*                m_texture = nullptr;
+    ZCylinder m_collisionZCylinder;
 
     AnimationGroup* m_currentPlayingAnimationGroup  = nullptr;
-    Timer*          m_animationTimer                = nullptr;
+    AnimationState  m_animationState                = AnimationState::IDLE; // Kept after a final state finished playing.
+    float           m_animationStartTime            = 0.f; // Simulation time the playing animation group started.
     float           m_animationTimerSpeedMultiplier = 1.f;
-
-    std::map<SoundID, SoundPlaybackID> m_soundPlaybackIDs;
+    TimerHandle     m_animationEndTimer;
+    TimerHandle     m_corpseTimer;
 
 public:
     /// After we inject the map pointer and other handle etc, we perform post initialize
-    void PostInitialize();
+    /// @param bApplyDieOnSpawn False when restoring a snapshot, which already holds the dead state.
+    void PostInitialize(bool bApplyDieOnSpawn = true);
+    void SetRandomSeed(unsigned long long seed); // Seed this actor stream and derive one stream per weapon slot.
+    /// Snapshot of the per actor state, the map writes the definition and handle in front of it.
+    void WriteSnapshot(ByteBufferWriter& writer) const;
+    /// Parse the state written by WriteSnapshot without touching any actor.
+    static void ReadSnapshot(ByteBufferReader& reader, ActorSnapshot& outSnapshot);
+    /// Apply a parsed state after PostInitialize. Owner and AI target are left to the map, which relinks them once
+    /// every actor of the snapshot exists.
+    void RestoreSnapshot(const ActorSnapshot& snapshot);
+    /// Definition hot reload
+    ActorDefinitionBinding CaptureDefinitionBinding() const;
+    /// Re-point the definition, the playing animation group and every weapon by name. Health and the collider keep
+    /// their current values, only what is read from the definition every frame picks up the change.
+    void RebindDefinitions(const ActorDefinitionBinding& binding);
 
     void Update(float deltaSeconds);
-    /// Update Animation, if the animation is finished, we stop the animation timer and set current anim to nullptr.
+    /// Update Animation, the end of the playing animation is a timer of the map that calls OnAnimationEnd.
     /// @param deltaSeconds 
     void UpdateAnimation(float deltaSeconds);
+    void OnAnimationEnd(); // Set current anim to nullptr, back to idle unless the state is final, corpses go to sleep.
+    void OnCorpseExpired();
+    /// Reschedule the corpse expiry, e.g. after a snapshot restored how long the actor has been dead.
+    void  ScheduleCorpseExpiry(float delaySeconds);
+    float GetSecondsDead() const; // 0 while alive.
+    float GetAnimationElapsedSeconds() const;
     /// Perform physics processing if the actor is simulated. Set velocity Z-components to zero for non-flying actors.
     /// Add a drag force equal to our drag times our negative current velocity. Integrate acceleration, velocity,
     /// and position then clear out acceleration for next frame.
@@ -103,15 +179,32 @@ public:
     /// @param direction 
     /// @param speed 
     void MoveInDirection(Vec3 direction, float speed);
+    /// Whether or not the actor never needs per-frame update and collision, static props or invisible markers like
+    /// spawn points that neither collide nor think.
+    bool IsStaticActor() const;
+    /// Whether or not the actor is at rest and nothing drives it, or is a corpse whose death animation is over, so the
+    /// map could move it into the sleeping list.
+    bool CanSleep() const;
+    /// Move the actor back to the active list if it is sleeping.
+    void WakeUp();
     /// Turn in the shortest possible path in the supplied direction, up to a maximum that must also be provided.
     /// Set the actor orientation directly rather than using angular velocity or other physics simulation.
     /// The caller is trusted to determine the maximum amount to turn based on turn rate and delta seconds. 
     /// @param direction 
     void       TurnInDirection(Vec3 direction);
     ZCylinder& GetColliderZCylinder();
-    /// Handle Actor collied with other actors
+    /// Move the collision ZCylinder to the current actor position, the cylinder center sits at half of the physical height.
+    void UpdateColliderPosition();
+    /// Handle Actor start overlapping with other actor, raised once by the map when the contact begins.
+    /// Projectile hits are handled here, the push out is resolved by the map once per pair.
     /// @param other 
     void OnColliedEnter(Actor* other);
+    /// Handle Actor keep overlapping with other actor, raised every collision step while the contact persists.
+    /// @param other 
+    void OnColliedStay(Actor* other);
+    /// Handle Actor stop overlapping with other actor, raised once when the contact ends or either actor dies.
+    /// @param other 
+    void OnColliedExit(Actor* other);
     /// Handle Actor collied with Tile bound in XY plane
     /// @param tileXYBound 
     void OnColliedEnter(AABB2& tileXYBound);
@@ -132,6 +225,7 @@ public:
     Vec3  GetActorEyePosition();
     void  Render(PlayerController* toPlayer) const;
     bool  PredicateRender(PlayerController* toPlayer) const; /// Predicate whether or not we render actor
+    void  RenderCollider() const; // Shared collision debug meshes of the definition, tinted by the actor color.
     Mat44 GetModelToWorldTransform() const;
 
     /// AI
@@ -141,13 +235,12 @@ public:
 
     /// Animation
 
-    /// Play Animation by specific name, it will automatically reset the animation timer if
-    /// successful play
-    /// @param animationName The Name of the animation group
+    /// Request an animation state through the state machine of the definition, it will automatically reset the
+    /// animation timer if the state starts playing
+    /// @param state The state whose animation group plays
     /// @param force Whether or not force to play animation that do not wait current animation finished.
-    /// @return the AnimationGroup that played.
-    AnimationGroup* PlayAnimationByName(std::string animationName, bool force = false);
+    /// @return the AnimationGroup that played, or the playing one if the state is already playing.
+    AnimationGroup* PlayAnimation(AnimationState state, bool force = false);
 
 private:
-    void InitLocalVertex();
 };
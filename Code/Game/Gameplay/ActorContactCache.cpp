@@ -0,0 +1,130 @@
+﻿#include "ActorContactCache.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+
+unsigned long long ActorContactCache::MakePairKey(const ActorHandle& actorA, const ActorHandle& actorB)
+{
+    unsigned long long dataA = actorA.GetData();
+    unsigned long long dataB = actorB.GetData();
+    if (dataA > dataB)
+    {
+        std::swap(dataA, dataB);
+    }
+    return (dataA << 32) | dataB;
+}
+
+void ActorContactCache::BeginStep()
+{
+    ++m_currentStep;
+    m_numPairsTested  = 0;
+    m_numPairsSkipped = 0;
+}
+
+void ActorContactCache::EndStep(std::vector<ActorContact>& outExitedContacts)
+{
+    for (auto it = m_contacts.begin(); it != m_contacts.end();)
+    {
+        if (it->second.m_lastTouchedStep != m_currentStep)
+        {
+            outExitedContacts.push_back(it->second);
+            it = m_contacts.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+ActorContact* ActorContactCache::FindContact(unsigned long long pairKey)
+{
+    auto it = m_contacts.find(pairKey);
+    if (it == m_contacts.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+ActorContact& ActorContactCache::FindOrAddContact(unsigned long long pairKey, const ActorHandle& actorA, const ActorHandle& actorB, bool& bOutIsNew)
+{
+    auto it = m_contacts.find(pairKey);
+    if (it != m_contacts.end())
+    {
+        bOutIsNew = false;
+        return it->second;
+    }
+    bOutIsNew = true;
+    ActorContact contact;
+    bool         bIsOrdered       = actorA.GetData() < actorB.GetData();
+    contact.m_actorA              = bIsOrdered ? actorA : actorB;
+    contact.m_actorB              = bIsOrdered ? actorB : actorA;
+    contact.m_lastTouchedStep     = m_currentStep;
+    return m_contacts.emplace(pairKey, contact).first->second;
+}
+
+void ActorContactCache::TouchContact(ActorContact& contact)
+{
+    contact.m_lastTouchedStep = m_currentStep;
+}
+
+bool ActorContactCache::IsContactStable(const ActorContact& contact, const Vec3& positionA, const Vec3& positionB) const
+{
+    return contact.m_resolvedPositionA == positionA && contact.m_resolvedPositionB == positionB;
+}
+
+void ActorContactCache::Clear()
+{
+    m_contacts.clear();
+}
+
+int ActorContactCache::GetNumContacts() const
+{
+    return static_cast<int>(m_contacts.size());
+}
+
+void ActorContactCache::WriteSnapshot(ByteBufferWriter& writer) const
+{
+    std::vector<unsigned long long> pairKeys;
+    pairKeys.reserve(m_contacts.size());
+    for (const auto& pair : m_contacts)
+    {
+        pairKeys.push_back(pair.first);
+    }
+    std::sort(pairKeys.begin(), pairKeys.end());
+
+    writer.Write(m_currentStep);
+    writer.Write(static_cast<unsigned int>(pairKeys.size()));
+    for (unsigned long long pairKey : pairKeys)
+    {
+        const ActorContact& contact = m_contacts.at(pairKey);
+        writer.Write(pairKey);
+        writer.Write(contact.m_actorA.GetData());
+        writer.Write(contact.m_actorB.GetData());
+        WriteVec3(writer, contact.m_resolvedPositionA);
+        WriteVec3(writer, contact.m_resolvedPositionB);
+        writer.Write(contact.m_lastTouchedStep);
+    }
+}
+
+void ActorContactCache::ReadSnapshot(ByteBufferReader& reader)
+{
+    m_contacts.clear();
+    reader.Read(m_currentStep);
+    unsigned int numContacts = reader.Read<unsigned int>();
+    for (unsigned int i = 0; i < numContacts && reader.IsValid(); ++i)
+    {
+        unsigned long long pairKey = reader.Read<unsigned long long>();
+        ActorContact       contact;
+        contact.m_actorA            = ActorHandle(reader.Read<unsigned int>());
+        contact.m_actorB            = ActorHandle(reader.Read<unsigned int>());
+        contact.m_resolvedPositionA = ReadVec3(reader);
+        contact.m_resolvedPositionB = ReadVec3(reader);
+        contact.m_lastTouchedStep   = reader.Read<unsigned int>();
+        m_contacts[pairKey]         = contact;
+    }
+}
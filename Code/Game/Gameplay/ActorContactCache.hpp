@@ -0,0 +1,74 @@
+﻿#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "Engine/Math/Vec3.hpp"
+#include "Game/Framework/ActorHandle.hpp"
+
+class Actor;
+class ByteBufferWriter;
+class ByteBufferReader;
+
+/// A persistent contact between two actors, the pair is unordered so m_actorA always holds the lower handle data.
+struct ActorContact
+{
+    ActorHandle  m_actorA;
+    ActorHandle  m_actorB;
+    Vec3         m_resolvedPositionA; // Position of actor A right after the last resolution of this pair.
+    Vec3         m_resolvedPositionB; // Position of actor B right after the last resolution of this pair.
+    unsigned int m_lastTouchedStep = 0; // Collision step that last saw the pair overlapping.
+};
+
+/// Entry of the contact buffer filled by the narrow phase. Each pair only writes its own entry so the narrow phase
+/// can run in parallel, the solve pass later applies the displacements in buffer order.
+struct ActorPairContact
+{
+    Actor*             m_actorA         = nullptr;
+    Actor*             m_actorB         = nullptr;
+    unsigned long long m_pairKey        = 0;
+    bool               m_bIsOverlapping = false;
+    Vec3               m_displacementA; // Push out displacement of actor A computed by the narrow phase.
+    Vec3               m_displacementB; // Push out displacement of actor B computed by the narrow phase.
+};
+
+/// Tracks overlapping actor pairs across frames so the map can raise enter, stay and exit events, resolve each pair
+/// once per step and skip the narrow phase of pairs that have not moved since they were last resolved.
+class ActorContactCache
+{
+public:
+    ActorContactCache()  = default;
+    ~ActorContactCache() = default;
+
+    /// Order independent key of the pair, the lower handle data is stored in the high 32 bits.
+    static unsigned long long MakePairKey(const ActorHandle& actorA, const ActorHandle& actorB);
+
+    /// Begin a new collision step, the contacts that are not touched during the step will be reported as exited.
+    void BeginStep();
+    /// Collect the contacts that were not touched during the current step and remove them from the cache.
+    /// @param outExitedContacts receives the removed contacts.
+    void EndStep(std::vector<ActorContact>& outExitedContacts);
+
+    ActorContact* FindContact(unsigned long long pairKey);
+    /// Find the contact of the pair or create it if the pair starts overlapping.
+    /// @param bOutIsNew true if the contact did not exist before.
+    ActorContact& FindOrAddContact(unsigned long long pairKey, const ActorHandle& actorA, const ActorHandle& actorB, bool& bOutIsNew);
+    /// Mark the contact as overlapping in the current step.
+    void TouchContact(ActorContact& contact);
+    /// Whether or not both actors are exactly where the last resolution left them, in which case the pair is stable.
+    bool IsContactStable(const ActorContact& contact, const Vec3& positionA, const Vec3& positionB) const;
+    void Clear();
+
+    int GetNumContacts() const;
+
+    /// Snapshot, contacts are written sorted by pair key so the same cache always produces the same bytes.
+    void WriteSnapshot(ByteBufferWriter& writer) const;
+    void ReadSnapshot(ByteBufferReader& reader);
+
+    /// Per-step statistics
+    int m_numPairsTested  = 0;
+    int m_numPairsSkipped = 0;
+
+private:
+    std::unordered_map<unsigned long long, ActorContact> m_contacts;
+    unsigned int                                         m_currentStep = 0;
+};
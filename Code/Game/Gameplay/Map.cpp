@@ -1,16 +1,22 @@
 ﻿#include "Map.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <execution>
+
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/FloatRange.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Math/RaycastUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.h"
 #include "Engine/Renderer/Renderer.hpp"
@@ -22,17 +28,52 @@
 #include "Game/Definition/TileDefinition.hpp"
 #include "Engine/Renderer/Renderer.cpp"
 #include "Game/Framework/ActorHandle.hpp"
+#include "Game/Framework/AIController.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/InputRecording.hpp"
 #include "Game/Framework/WidgetSubsystem.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "MapRegionSource.hpp"
+#include "MapRegionStreamer.hpp"
+#include "Weapon.hpp"
+#include "Save/MapSnapshot.hpp"
 
 Map::Map(Game* game, const MapDefinition* definition): m_game(game), m_definition(definition)
 {
     printf("Map::Map    + Creating Map from the definition \"%s\"\n", definition->m_name.c_str());
-    m_texture    = g_theRenderer->CreateTextureFromFile("Data/Images/Terrain_8x8.png");
-    m_dimensions = definition->m_mapImage->GetDimensions();
+    m_texture    = definition->m_spriteSheetAsset.GetTexture(); // Shared with the definition instead of a new texture per map.
+    m_dimensions = definition->GetDimensions();
     m_shader     = definition->m_shader;
-    CreateTiles();
-    CreateGeometry();
-    CreateBuffers();
+    if (TileDefinition::s_definitions.size() >= TILE_DEFINITION_NONE)
+        ERROR_AND_DIE("Map::Map    Too many tile definitions for one byte tile indexes")
+
+    m_bParallelNarrowPhase = g_gameConfigBlackboard.GetValue("parallelNarrowPhase", m_bParallelNarrowPhase);
+    m_bVerifyNarrowPhase   = g_gameConfigBlackboard.GetValue("verifyNarrowPhase", m_bVerifyNarrowPhase);
+    m_bDrawActorColliders  = g_gameConfigBlackboard.GetValue("drawActorColliders", m_bDrawActorColliders);
+
+    /// Random streams, a fixed seed reproduces the spawn choices and every actor and weapon roll of the session
+    int configSeed = g_gameConfigBlackboard.GetValue("randomSeed", 0);
+    m_randomSeed   = configSeed != 0 ? static_cast<unsigned long long>(configSeed) : static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+    if (game->m_inputReplayer)
+        m_randomSeed = game->m_inputReplayer->GetHeader().m_randomSeed;
+    m_randomStream.SetSeed(m_randomSeed);
+    printf("Map::Map    Random seed %llu\n", m_randomSeed);
+    if (m_definition->m_bIsStreamed)
+    {
+        CreateRegionStreamer();
+    }
+    else
+    {
+        CreateTiles();
+        CreateGeometry();
+        CreateBuffers();
+    }
+
+    if (g_gameConfigBlackboard.GetValue("mapRaycastBenchmark", false))
+        RunRaycastBenchmark(g_gameConfigBlackboard.GetValue("mapRaycastBenchmarkRays", 100000));
+    if (g_gameConfigBlackboard.GetValue("mapTunnellingBenchmark", false))
+        RunTunnellingBenchmark(g_gameConfigBlackboard.GetValue("mapTunnellingBenchmarkProjectiles", 10000));
 
     /// Testing Adding Actors
     /*AddActorsToMap(new Actor(Vec3(7.5f, 8.5f, 0.25f), EulerAngles(), Rgba8::RED, 0.75f, 0.35f, true));
@@ -69,6 +110,11 @@ Map::~Map()
     delete m_vertexBuffer;
     m_vertexBuffer = nullptr;
 
+    if (m_regionStreamer)
+        m_regionStreamer->Shutdown();
+    POINTER_SAFE_DELETE(m_regionStreamer)
+    POINTER_SAFE_DELETE(m_regionSource)
+
     for (Actor* actor : m_actors)
     {
         delete actor;
@@ -84,9 +130,7 @@ void Map::CreateTiles()
     {
         for (int x = 0; x < m_definition->m_mapImage->GetDimensions().x; x++)
         {
-            Tile* tile = GetTile(x, y);
-            tile->SetTileCoords(IntVec2(x, y));
-            tile->SetBounds(AABB3(Vec3(static_cast<float>(x), static_cast<float>(y), 0.f), Vec3(static_cast<float>(x + 1), static_cast<float>(y + 1), 1.f)));
+            Tile*           tile       = GetTile(x, y);
             Rgba8           color      = m_definition->m_mapImage->GetTexelColor(IntVec2(x, y));
             TileDefinition* definition = TileDefinition::GetByTexelColor(color);
             if (definition == nullptr)
@@ -95,29 +139,36 @@ void Map::CreateTiles()
             //printf("Map::Create       ‖ Add tile %s at (%d, %d)\n", definition->m_name.c_str(), x, y);
         }
     }
-    printf("Map::Create       ‖ Creating total tiles: %d\n", static_cast<int>(m_tiles.size()));
+    printf("Map::Create       ‖ Creating total tiles: %d, %d bytes per tile, %.2f KB\n", static_cast<int>(m_tiles.size()), static_cast<int>(sizeof(Tile)),
+           static_cast<double>(m_tiles.size() * sizeof(Tile)) / 1024.0);
 }
 
 void Map::CreateGeometry()
 {
     printf("Map::Create       ‖ Creating Map Geometry \n");
-    for (Tile& tile : m_tiles)
+    for (int tileIndex = 0; tileIndex < static_cast<int>(m_tiles.size()); tileIndex++)
     {
-        TileDefinition* definition = tile.GetTileDefinition();
-        if (!definition)
-            continue;
-        if (definition->m_floorSpriteCoords != IntVec2::INVALID)
-        {
-            AddGeometryForFloor(m_vertexes, m_indices, tile.GetBounds(), m_definition->m_spriteSheet->GetSpriteUVs(definition->m_floorSpriteCoords));
-        }
-        if (definition->m_wallSpriteCoords != IntVec2::INVALID)
-        {
-            AddGeometryForWall(m_vertexes, m_indices, tile.GetBounds(), m_definition->m_spriteSheet->GetSpriteUVs(definition->m_wallSpriteCoords));
-        }
-        if (definition->m_ceilingSpriteCoords != IntVec2::INVALID)
-        {
-            AddGeometryForCeiling(m_vertexes, m_indices, tile.GetBounds(), m_definition->m_spriteSheet->GetSpriteUVs(definition->m_ceilingSpriteCoords));
-        }
+        AddGeometryForTile(m_vertexes, m_indices, m_tiles[tileIndex], GetTileCoords(tileIndex));
+    }
+}
+
+void Map::AddGeometryForTile(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indices, const Tile& tile, const IntVec2& tileCoords) const
+{
+    const TileDefinition* definition = tile.GetTileDefinition();
+    if (!definition)
+        return;
+    AABB3 bounds = GetTileBounds(tileCoords);
+    if (definition->m_floorSpriteCoords != IntVec2::INVALID)
+    {
+        AddGeometryForFloor(vertexes, indices, bounds, m_definition->m_spriteSheet->GetSpriteUVs(definition->m_floorSpriteCoords));
+    }
+    if (definition->m_wallSpriteCoords != IntVec2::INVALID)
+    {
+        AddGeometryForWall(vertexes, indices, bounds, m_definition->m_spriteSheet->GetSpriteUVs(definition->m_wallSpriteCoords));
+    }
+    if (definition->m_ceilingSpriteCoords != IntVec2::INVALID)
+    {
+        AddGeometryForCeiling(vertexes, indices, bounds, m_definition->m_spriteSheet->GetSpriteUVs(definition->m_ceilingSpriteCoords));
     }
 }
 
@@ -183,6 +234,64 @@ void Map::CreateBuffers()
     g_theRenderer->CopyCPUToGPU(m_indices.data(), static_cast<int>(m_indices.size()) * sizeof(unsigned int), m_indexBuffer);
 }
 
+void Map::CreateRegionStreamer()
+{
+    MapRegionStreamerConfig config;
+    config.m_regionSize         = g_gameConfigBlackboard.GetValue("mapRegionSize", config.m_regionSize);
+    config.m_loadRadius         = g_gameConfigBlackboard.GetValue("mapRegionLoadRadius", config.m_loadRadius);
+    config.m_maxResidentBytes   = static_cast<size_t>(g_gameConfigBlackboard.GetValue("mapRegionMemoryMB", 64)) * 1024u * 1024u;
+    config.m_maxUploadsPerFrame = g_gameConfigBlackboard.GetValue("mapRegionUploadsPerFrame", config.m_maxUploadsPerFrame);
+    config.m_numWorkers         = g_gameConfigBlackboard.GetValue("mapRegionWorkerThreads", config.m_numWorkers);
+    if (m_definition->IsGenerated())
+    {
+        /// Seeded by the map name, not the session seed, so the layout and the spawn infos always agree
+        unsigned long long generatorSeed = DefinitionCache::HashBytes(reinterpret_cast<const unsigned char*>(m_definition->m_name.data()), m_definition->m_name.size());
+        m_regionSource                   = new MapRegionGenerator(m_dimensions, generatorSeed);
+    }
+    else
+    {
+        MapRegionFile* regionFile = new MapRegionFile();
+        if (!regionFile->Open(m_definition->m_imagePath, *m_definition->m_mapImage, config.m_regionSize))
+            ERROR_AND_DIE(Stringf("Map::CreateRegionStreamer    Failed to open the region file of \"%s\"", m_definition->m_imagePath.c_str()))
+        m_regionSource = regionFile;
+    }
+    m_regionStreamer = new MapRegionStreamer(this, m_regionSource, m_dimensions, config);
+    m_regionStreamer->Startup();
+    if (g_gameConfigBlackboard.GetValue("mapStreamingBenchmark", false))
+    {
+        Vec2 corner(1.5f, 1.5f);
+        m_regionStreamer->RunWalkBenchmark(corner, Vec2(static_cast<float>(m_dimensions.x), static_cast<float>(m_dimensions.y)) - corner,
+                                           g_gameConfigBlackboard.GetValue("mapStreamingBenchmarkTilesPerFrame", 4.f));
+    }
+
+    /// Every spawn position has its regions before the actors are placed there
+    for (const SpawnInfo& spawnInfo : m_definition->m_spawnInfos)
+    {
+        m_regionStreamer->LoadRegionsAround(Vec2(spawnInfo.m_position.x, spawnInfo.m_position.y));
+    }
+}
+
+void Map::UpdateRegionStreaming()
+{
+    if (!m_regionStreamer)
+        return;
+    m_focusPositions.clear();
+    for (PlayerController* controller : m_game->m_localPlayerControllers)
+    {
+        Actor* actor = controller->GetActor();
+        if (actor)
+            m_focusPositions.push_back(Vec2(actor->m_position.x, actor->m_position.y));
+    }
+    m_regionStreamer->Update(m_focusPositions);
+    if (IS_DEBUG_ENABLED())
+    {
+        AABB2 space = m_game->m_screenSpace;
+        space.m_maxs.y -= 128;
+        DebugAddScreenText(Stringf("Map regions resident: %d (%.2f MB)", m_regionStreamer->GetNumResidentRegions(), static_cast<double>(m_regionStreamer->GetResidentBytes()) / (1024.0 * 1024.0)),
+                           space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+    }
+}
+
 bool Map::IsPositionInBounds(Vec3 position, const float tolerance) const
 {
     UNUSED(position)
@@ -215,10 +324,25 @@ bool Map::AreCoordsInBounds(IntVec2 coords) const
 
 Tile* Map::GetTile(int x, int y)
 {
+    if (!GetTileIsInBound(IntVec2(x, y)))
+        return nullptr;
+    if (m_regionStreamer)
+        return m_regionStreamer->GetTile(x, y);
     return &m_tiles[x + y * m_dimensions.x];
 }
 
 
+IntVec2 Map::GetTileCoords(int tileIndex) const
+{
+    return IntVec2(tileIndex % m_dimensions.x, tileIndex / m_dimensions.x);
+}
+
+AABB3 Map::GetTileBounds(const IntVec2& tileCoords) const
+{
+    Vec3 mins(static_cast<float>(tileCoords.x), static_cast<float>(tileCoords.y), 0.f);
+    return AABB3(mins, mins + Vec3(1.f, 1.f, 1.f));
+}
+
 Tile* Map::GetTile(IntVec2 coords)
 {
     return GetTile(coords.x, coords.y);
@@ -240,11 +364,25 @@ bool Map::GetTileIsSolid(const IntVec2& coords)
     {
         return true;
     }
-    return GetTile(coords)->GetTileDefinition()->m_isSolid;
+    Tile* tile = GetTile(coords);
+    return !tile || tile->IsTileSolid(); // A region that is not streamed in yet blocks raycasts like a wall.
+}
+
+const MapDefinition* Map::GetDefinition() const
+{
+    return m_definition;
+}
+
+unsigned long long Map::GetRandomSeed() const
+{
+    return m_randomSeed;
 }
 
 void Map::Update()
 {
+    UpdateRegionStreaming();
+    UpdateTimers();
+
     /// Lighting
     {
         HandleDecreaseSunDirectionX();
@@ -255,33 +393,45 @@ void Map::Update()
         HandleIncreaseSunIntensity();
         HandleDecreaseAmbientIntensity();
         HandleIncreaseAmbientIntensity();
-        AABB2 space = m_game->m_screenSpace;
-        space.m_maxs.y -= 30;
-        DebugAddScreenText(Stringf("  Sun Direction X: %0.2f [F2 / F3 to change] ", m_sunDirection.x), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
-        space.m_maxs.y -= 14;
-        DebugAddScreenText(Stringf("  Sun Direction Y:                          ", m_sunDirection.y), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
-        DebugAddScreenText(Stringf("                   %0.2f [F4 / F5 to change] ", m_sunDirection.y), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
-        space.m_maxs.y -= 14;
-        DebugAddScreenText(Stringf("    Sun Intensity: %0.2f [F6 / F7 to change] ", m_sunIntensity), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
-        space.m_maxs.y -= 14;
-        DebugAddScreenText(Stringf("Ambient Intensity: %0.2f [F8 / F9 to change] ", m_ambientIntensity), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+        if (IS_DEBUG_ENABLED())
+        {
+            AABB2 space = m_game->m_screenSpace;
+            space.m_maxs.y -= 30;
+            DebugAddScreenText(Stringf("  Sun Direction X: %0.2f [F2 / F3 to change] ", m_sunDirection.x), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+            space.m_maxs.y -= 14;
+            DebugAddScreenText(Stringf("  Sun Direction Y:                          ", m_sunDirection.y), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+            DebugAddScreenText(Stringf("                   %0.2f [F4 / F5 to change] ", m_sunDirection.y), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+            space.m_maxs.y -= 14;
+            DebugAddScreenText(Stringf("    Sun Intensity: %0.2f [F6 / F7 to change] ", m_sunIntensity), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+            space.m_maxs.y -= 14;
+            DebugAddScreenText(Stringf("Ambient Intensity: %0.2f [F8 / F9 to change] ", m_ambientIntensity), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+        }
     }
     ///
 
-    /// Actor
+    /// Actor, only the active list is updated, index based since actors could spawn or wake up during the update
     {
-        for (Actor* actor : m_actors)
+        for (int i = 0; i < static_cast<int>(m_activeActors.size()); ++i)
         {
-            if (actor)
-            {
-                actor->Update(g_theGame->m_clock->GetDeltaSeconds());
-            }
+            m_activeActors[i]->Update(g_theGame->m_simulationDeltaSeconds);
+        }
+        m_numActorsSkippedLastFrame = static_cast<int>(m_sleepingActors.size() + m_staticActors.size());
+        if (IS_DEBUG_ENABLED())
+        {
+            AABB2 space = m_game->m_screenSpace;
+            space.m_maxs.y -= 100;
+            DebugAddScreenText(Stringf("Actors active: %d sleeping: %d static: %d skipped: %d", static_cast<int>(m_activeActors.size()), static_cast<int>(m_sleepingActors.size()),
+                                       static_cast<int>(m_staticActors.size()), m_numActorsSkippedLastFrame), space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
+            space.m_maxs.y -= 14;
+            DebugAddScreenText(Stringf("Contacts: %d pairs tested: %d pairs skipped: %d", m_contactCache.GetNumContacts(), m_contactCache.m_numPairsTested, m_contactCache.m_numPairsSkipped),
+                               space, 12, 0, Rgba8::WHITE, Rgba8::WHITE);
         }
     }
     /// 
+    ColliedProjectilesSwept();
     ColliedWithActors();
     ColliedActorsWithMap();
-    CheckAndRespawnPlayer();
+    UpdateSleepingActors();
 }
 
 void Map::EndFrame()
@@ -291,34 +441,241 @@ void Map::EndFrame()
 
 void Map::ColliedWithActors()
 {
-    for (Actor* actor : m_actors)
+    m_contactCache.BeginStep();
+    BuildActorPairs(m_actorPairs);
+    RunNarrowPhase(m_actorPairs, m_bParallelNarrowPhase);
+    if (m_bVerifyNarrowPhase)
+        ResolveActorPairsSerially(m_actorPairs, m_referencePositions);
+    ApplyActorPairDisplacements(m_actorPairs);
+    if (m_bVerifyNarrowPhase)
+        VerifyNarrowPhase(m_actorPairs, m_referencePositions);
+    RaiseActorPairEvents(m_actorPairs);
+
+    m_exitedContacts.clear();
+    m_contactCache.EndStep(m_exitedContacts);
+    for (const ActorContact& exited : m_exitedContacts)
     {
-        if (actor)
+        Actor* actorA = GetActorByHandle(exited.m_actorA);
+        Actor* actorB = GetActorByHandle(exited.m_actorB);
+        if (actorA && actorB)
+        {
+            actorA->OnColliedExit(actorB);
+            actorB->OnColliedExit(actorA);
+        }
+    }
+}
+
+void Map::BuildActorPairs(std::vector<ActorPairContact>& outPairs)
+{
+    outPairs.clear();
+    int numActors = static_cast<int>(m_actors.size());
+    for (int i = 0; i < numActors; ++i)
+    {
+        Actor* actorA = m_actors[i];
+        if (!GetActorIsSimulated(actorA))
+            continue;
+        for (int j = i + 1; j < numActors; ++j)
         {
-            for (Actor* otherActor : m_actors)
+            Actor* actorB = m_actors[j];
+            if (!GetActorIsSimulated(actorB))
+                continue;
+
+            bool               bIsOrdered    = actorA->m_handle.GetData() < actorB->m_handle.GetData();
+            const Vec3&        positionLow   = bIsOrdered ? actorA->m_position : actorB->m_position;
+            const Vec3&        positionHigh  = bIsOrdered ? actorB->m_position : actorA->m_position;
+            unsigned long long pairKey       = ActorContactCache::MakePairKey(actorA->m_handle, actorB->m_handle);
+            ActorContact*      contact       = m_contactCache.FindContact(pairKey);
+            bool               bBothSleeping = actorA->m_simulationState == ActorSimulationState::SLEEPING && actorB->m_simulationState == ActorSimulationState::SLEEPING;
+
+            // Stable contacts keep touching without re-running the narrow phase, two actors at rest can not start overlapping each other
+            if (contact && (bBothSleeping || m_contactCache.IsContactStable(*contact, positionLow, positionHigh)))
             {
-                if (otherActor && actor != otherActor)
-                {
-                    ColliedActors(actor, otherActor);
-                }
+                m_contactCache.TouchContact(*contact);
+                m_contactCache.m_numPairsSkipped++;
+                continue;
             }
+            if (bBothSleeping)
+            {
+                m_contactCache.m_numPairsSkipped++;
+                continue;
+            }
+
+            ActorPairContact pair;
+            pair.m_actorA  = actorA;
+            pair.m_actorB  = actorB;
+            pair.m_pairKey = pairKey;
+            outPairs.push_back(pair);
         }
     }
+    m_contactCache.m_numPairsTested = static_cast<int>(outPairs.size());
 }
 
-void Map::ColliedActors(Actor* actorA, Actor* actorB)
+void Map::RunNarrowPhase(std::vector<ActorPairContact>& pairs, bool bParallel) const
 {
-    if (DoZCylinder3DOverlap(actorA->GetColliderZCylinder(), actorB->GetColliderZCylinder()))
+    if (bParallel)
     {
-        actorB->OnColliedEnter(actorA);
+        std::for_each(std::execution::par, pairs.begin(), pairs.end(), ComputeActorPairContact);
+    }
+    else
+    {
+        for (ActorPairContact& pair : pairs)
+        {
+            ComputeActorPairContact(pair);
+        }
+    }
+}
+
+void Map::ComputeActorPairContact(ActorPairContact& pair)
+{
+    Actor* actorA         = pair.m_actorA;
+    Actor* actorB         = pair.m_actorB;
+    pair.m_displacementA  = Vec3::ZERO;
+    pair.m_displacementB  = Vec3::ZERO;
+    pair.m_bIsOverlapping = DoZCylinder3DOverlap(actorA->GetColliderZCylinder(), actorB->GetColliderZCylinder());
+    if (!pair.m_bIsOverlapping)
+        return;
+    if (actorA->m_owner || actorB->m_owner)
+        return;
+    if (!actorA->m_definition->m_collidesWithActors || !actorB->m_definition->m_collidesWithActors)
+        return;
+
+    float A_bottom = actorA->m_position.z;
+    float A_top    = actorA->m_position.z + actorA->m_physicalHeight;
+    float B_bottom = actorB->m_position.z;
+    float B_top    = actorB->m_position.z + actorB->m_physicalHeight;
+
+    auto rangeA = FloatRange(A_bottom, A_top);
+    auto rangeB = FloatRange(B_bottom, B_top);
+    if (rangeA.IsOverlappingWith(rangeB))
+    {
+        auto posA2D = Vec2(actorA->m_position.x, actorA->m_position.y);
+        auto posB2D = Vec2(actorB->m_position.x, actorB->m_position.y);
+        PushDiscsOutOfEachOther2D(posA2D, actorA->m_physicalRadius, posB2D, actorB->m_physicalRadius);
+        pair.m_displacementA = Vec3(posA2D.x - actorA->m_position.x, posA2D.y - actorA->m_position.y, 0.f);
+        pair.m_displacementB = Vec3(posB2D.x - actorB->m_position.x, posB2D.y - actorB->m_position.y, 0.f);
+    }
+    else
+    {
+        // Calculate penetration depths
+        float overlapDown = A_top - B_bottom; // How much B intrudes from below
+        float overlapUp   = B_top - A_bottom; // How much B intrudes from above
+
+        // Choose minimal displacement direction:
+        if (overlapDown < overlapUp)
+        {
+            // Push B downward so its bottom touches A_top
+            pair.m_displacementB = Vec3(0.f, 0.f, A_top - B_bottom);
+        }
+        else
+        {
+            // Push B upward so its top touches A_bottom
+            pair.m_displacementB = Vec3(0.f, 0.f, A_bottom - actorB->m_physicalHeight - B_bottom);
+        }
+    }
+}
+
+void Map::ApplyActorPairDisplacements(std::vector<ActorPairContact>& pairs)
+{
+    /// The parallel narrow phase read the positions from before the solve, they are still exact for a pair until one
+    /// of its actors gets pushed by an earlier pair
+    m_actorCollisionStep++;
+    for (ActorPairContact& pair : pairs)
+    {
+        if (pair.m_actorA->m_lastPushedStep == m_actorCollisionStep || pair.m_actorB->m_lastPushedStep == m_actorCollisionStep)
+            ComputeActorPairContact(pair);
+        if (!pair.m_bIsOverlapping)
+            continue;
+        pair.m_actorA->m_position += pair.m_displacementA;
+        pair.m_actorB->m_position += pair.m_displacementB;
+        pair.m_actorA->m_lastPushedStep = m_actorCollisionStep;
+        pair.m_actorB->m_lastPushedStep = m_actorCollisionStep;
+    }
+}
+
+void Map::RaiseActorPairEvents(const std::vector<ActorPairContact>& pairs)
+{
+    /// After every displacement so the contacts record the final positions of the step
+    for (const ActorPairContact& pair : pairs)
+    {
+        if (!pair.m_bIsOverlapping)
+            continue;
+        Actor*        actorA      = pair.m_actorA;
+        Actor*        actorB      = pair.m_actorB;
+        bool          bIsOrdered  = actorA->m_handle.GetData() < actorB->m_handle.GetData();
+        bool          bIsNew      = false;
+        ActorContact& touched     = m_contactCache.FindOrAddContact(pair.m_pairKey, actorA->m_handle, actorB->m_handle, bIsNew);
+        touched.m_resolvedPositionA = bIsOrdered ? actorA->m_position : actorB->m_position;
+        touched.m_resolvedPositionB = bIsOrdered ? actorB->m_position : actorA->m_position;
+        m_contactCache.TouchContact(touched);
+        if (bIsNew)
+        {
+            actorA->WakeUp();
+            actorB->WakeUp();
+            actorA->OnColliedEnter(actorB);
+            actorB->OnColliedEnter(actorA);
+        }
+        else
+        {
+            actorA->OnColliedStay(actorB);
+            actorB->OnColliedStay(actorA);
+        }
+    }
+}
+
+void Map::ResolveActorPairsSerially(const std::vector<ActorPairContact>& pairs, std::vector<Vec3>& outFinalPositions)
+{
+    FrameArenaScope   frameScope(g_theGame->m_frameArena);
+    FrameVector<Vec3> startPositions((FrameAllocator<Vec3>(g_theGame->m_frameArena)));
+    startPositions.reserve(pairs.size() * 2);
+    for (const ActorPairContact& pair : pairs)
+    {
+        startPositions.push_back(pair.m_actorA->m_position);
+        startPositions.push_back(pair.m_actorB->m_position);
+    }
+
+    for (const ActorPairContact& pair : pairs)
+    {
+        ActorPairContact reference = pair;
+        ComputeActorPairContact(reference);
+        if (!reference.m_bIsOverlapping)
+            continue;
+        reference.m_actorA->m_position += reference.m_displacementA;
+        reference.m_actorB->m_position += reference.m_displacementB;
+    }
+
+    outFinalPositions.clear();
+    for (const ActorPairContact& pair : pairs)
+    {
+        outFinalPositions.push_back(pair.m_actorA->m_position);
+        outFinalPositions.push_back(pair.m_actorB->m_position);
+    }
+    /// Rewind, the start positions were all captured before the first push
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        pairs[i].m_actorA->m_position = startPositions[i * 2];
+        pairs[i].m_actorB->m_position = startPositions[i * 2 + 1];
+    }
+}
+
+void Map::VerifyNarrowPhase(const std::vector<ActorPairContact>& pairs, const std::vector<Vec3>& expectedPositions) const
+{
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        const ActorPairContact& pair    = pairs[i];
+        bool                    bIsSame = memcmp(&pair.m_actorA->m_position, &expectedPositions[i * 2], sizeof(Vec3)) == 0
+            && memcmp(&pair.m_actorB->m_position, &expectedPositions[i * 2 + 1], sizeof(Vec3)) == 0;
+        if (!bIsSame)
+        {
+            ERROR_AND_DIE(Stringf("Map::VerifyNarrowPhase    Pair %llu ended away from the serial reference", pair.m_pairKey))
+        }
     }
 }
 
 void Map::ColliedActorsWithMap()
 {
-    for (Actor* actor : m_actors)
+    for (Actor* actor : m_activeActors)
     {
-        if (actor)
+        if (GetActorIsSimulated(actor) && actor->m_definition->m_collidesWithWorld)
             ColliedActorWithMap(actor);
     }
 }
@@ -338,21 +695,161 @@ void Map::ColliedActorWithMap(Actor* actor)
     PushActorOutOfTile(actor, tileCoords + IntVec2(-1, -1));
     PushActorOutOfTile(actor, tileCoords + IntVec2(1, -1));
 
-    actor->OnColliedEnter(GetTile(tileCoords)->GetBounds());
+    if (GetTile(tileCoords))
+    {
+        AABB3 tileBounds = GetTileBounds(tileCoords);
+        actor->OnColliedEnter(tileBounds);
+    }
 }
 
 void Map::PushActorOutOfTile(Actor* actor, const IntVec2& tileCoords)
 {
-    if (GetTileIsInBound(tileCoords))
+    /// Same rule as raycasts, a tile of a region that is not streamed in yet is a wall
+    if (!GetTileIsInBound(tileCoords) || !GetTileIsSolid(tileCoords))
+        return;
+    AABB2 aabb2;
+    aabb2.m_mins = Vec2(static_cast<float>(tileCoords.x), static_cast<float>(tileCoords.y));
+    aabb2.m_maxs = aabb2.m_mins + Vec2::ONE;
+    actor->OnColliedEnter(aabb2);
+}
+
+void Map::ColliedProjectilesSwept()
+{
+    for (Actor* actor : m_actors)
+    {
+        if (actor && actor->m_owner && !actor->m_bIsDead)
+        {
+            SweepProjectile(actor);
+        }
+    }
+}
+
+bool Map::SweepProjectile(Actor* projectile)
+{
+    Vec3  displacement = projectile->m_position - projectile->m_lastPosition;
+    float distance     = displacement.GetLength();
+    if (distance <= 0.f)
+        return false;
+
+    Vec3  direction  = displacement / distance;
+    float halfHeight = projectile->m_physicalHeight * 0.5f;
+    Vec3  center     = projectile->m_lastPosition + Vec3(0.f, 0.f, halfHeight);
+
+    RaycastResult3D worldHit;
+    if (projectile->m_definition->m_collidesWithWorld)
+        worldHit = SweepZCylinderVsWorld(center, direction, distance, projectile->m_physicalRadius, halfHeight);
+
+    ActorHandle     actorHitHandle;
+    RaycastResult3D actorHit;
+    if (projectile->m_definition->m_collidesWithActors)
+        actorHit = SweepZCylinderVsActors(projectile, actorHitHandle, center, direction, distance);
+
+    if (actorHit.m_didImpact && (!worldHit.m_didImpact || actorHit.m_impactDist <= worldHit.m_impactDist))
+    {
+        Actor* target = GetActorByHandle(actorHitHandle);
+        if (!target)
+            return false;
+        projectile->m_position = center + direction * actorHit.m_impactDist - Vec3(0.f, 0.f, halfHeight);
+        projectile->UpdateColliderPosition();
+        target->OnColliedEnter(projectile);
+        return true;
+    }
+
+    if (worldHit.m_didImpact)
+    {
+        projectile->m_position = center + direction * worldHit.m_impactDist - Vec3(0.f, 0.f, halfHeight);
+        projectile->UpdateColliderPosition();
+        if (projectile->m_definition->m_dieOnCollide)
+            projectile->SetActorDead();
+        return true;
+    }
+    return false;
+}
+
+RaycastResult3D Map::SweepZCylinderVsWorld(const Vec3& center, const Vec3& direction, float distance, float radius, float halfHeight)
+{
+    RaycastResult3D result;
+    result.m_rayStartPos  = center;
+    result.m_rayFwdNormal = direction;
+    result.m_rayMaxLength = distance;
+    result.m_impactDist   = distance;
+
+    /// Walls, trace the center and both flanks of the cylinder. The center contact happens one radius before the traced
+    /// impact, the flanks already sit on the cylinder edge so their impact is the contact
+    Vec2 forwardXY = direction.GetXY();
+    if (forwardXY.GetLengthSquared() > 0.f)
+    {
+        Vec2 flank      = forwardXY.GetNormalized().GetRotated90Degrees() * radius;
+        Vec3 offsets[3] = {Vec3::ZERO, Vec3(flank.x, flank.y, 0.f), Vec3(-flank.x, -flank.y, 0.f)};
+        for (int rayIndex = 0; rayIndex < 3; rayIndex++)
+        {
+            bool            bIsCenterRay = rayIndex == 0;
+            RaycastResult3D wallHit      = RaycastWorldXY(center + offsets[rayIndex], direction, bIsCenterRay ? distance + radius : distance);
+            if (!wallHit.m_didImpact)
+                continue;
+            float contactDist = wallHit.m_impactDist;
+            if (bIsCenterRay)
+            {
+                float facing = fabsf(DotProduct3D(direction, wallHit.m_impactNormal));
+                contactDist  = facing > 0.f ? wallHit.m_impactDist - radius / facing : 0.f;
+                if (wallHit.m_impactDist - radius > distance)
+                    continue;
+            }
+            contactDist = GetClamped(contactDist, 0.f, distance);
+            if (contactDist <= result.m_impactDist)
+            {
+                result.m_didImpact    = true;
+                result.m_impactDist   = contactDist;
+                result.m_impactNormal = wallHit.m_impactNormal;
+            }
+        }
+    }
+    ///
+
+    /// Floor and ceiling, trace from the cylinder cap that faces the movement
+    if (direction.z != 0.f)
+    {
+        Vec3            capStart = center + Vec3(0.f, 0.f, direction.z > 0.f ? halfHeight : -halfHeight);
+        RaycastResult3D capHit   = RaycastWorldZ(capStart, direction, distance);
+        if (capHit.m_didImpact && capHit.m_impactDist <= result.m_impactDist)
+        {
+            result.m_didImpact    = true;
+            result.m_impactDist   = capHit.m_impactDist;
+            result.m_impactNormal = capHit.m_impactNormal;
+        }
+    }
+    ///
+
+    result.m_impactPos = center + direction * result.m_impactDist;
+    return result;
+}
+
+RaycastResult3D Map::SweepZCylinderVsActors(Actor* projectile, ActorHandle& resultActorHit, const Vec3& center, const Vec3& direction, float distance)
+{
+    RaycastResult3D result;
+    result.m_rayStartPos  = center;
+    result.m_rayFwdNormal = direction;
+    result.m_rayMaxLength = distance;
+    resultActorHit        = ActorHandle::INVALID;
+    float closestDistance = FLT_MAX;
+
+    for (Actor* testActor : m_actors)
     {
-        if (GetTile(tileCoords)->IsTileSolid())
+        if (!testActor || testActor == projectile || testActor == projectile->m_owner)
+            continue;
+        if (testActor->m_bIsDead || testActor->m_owner || !testActor->m_definition->m_collidesWithActors)
+            continue;
+        Vec3      targetCenter = testActor->m_position + Vec3(0.f, 0.f, testActor->m_physicalHeight * 0.5f);
+        ZCylinder inflated(targetCenter, testActor->m_physicalRadius + projectile->m_physicalRadius, testActor->m_physicalHeight + projectile->m_physicalHeight, true);
+        RaycastResult3D hit = RaycastVsZCylinder3D(center, direction, distance, inflated);
+        if (hit.m_didImpact && hit.m_impactDist < closestDistance)
         {
-            AABB2 aabb2;
-            aabb2.m_mins = Vec2(static_cast<float>(tileCoords.x), static_cast<float>(tileCoords.y));
-            aabb2.m_maxs = aabb2.m_mins + Vec2::ONE;
-            actor->OnColliedEnter(aabb2);
+            closestDistance = hit.m_impactDist;
+            result          = hit;
+            resultActorHit  = testActor->m_handle;
         }
     }
+    return result;
 }
 
 void Map::Render(PlayerController* toPlayer)
@@ -361,7 +858,10 @@ void Map::Render(PlayerController* toPlayer)
     g_theRenderer->BindShader(m_shader);
     g_theRenderer->BindTexture(m_texture);
     g_theRenderer->SetLightConstants(m_sunDirection, m_sunIntensity, m_ambientIntensity);
-    g_theRenderer->DrawIndexedVertexBuffer(m_vertexBuffer, m_indexBuffer, static_cast<int>(m_indices.size()));
+    if (m_regionStreamer)
+        m_regionStreamer->Render();
+    else
+        g_theRenderer->DrawIndexedVertexBuffer(m_vertexBuffer, m_indexBuffer, static_cast<int>(m_indices.size()));
     g_theRenderer->BindShader(nullptr);
     for (Actor* actor : m_actors)
     {
@@ -383,8 +883,9 @@ LightingConstants Map::GetLightConstants()
 
 RaycastResult3D Map::RaycastAll(const Vec3& start, const Vec3& direction, float distance)
 {
-    std::vector<RaycastResult3D> results;
-    std::vector<RaycastResult3D> resultImpact;
+    FrameArenaScope              frameScope(g_theGame->m_frameArena);
+    FrameVector<RaycastResult3D> results((FrameAllocator<RaycastResult3D>(g_theGame->m_frameArena)));
+    FrameVector<RaycastResult3D> resultImpact((FrameAllocator<RaycastResult3D>(g_theGame->m_frameArena)));
     resultImpact.reserve(4);
     results.reserve(4);
     RaycastResult3D result;
@@ -414,8 +915,9 @@ RaycastResult3D Map::RaycastAll(const Vec3& start, const Vec3& direction, float
 
 RaycastResult3D Map::RaycastAll(Actor* actor, ActorHandle& resultActorHit, const Vec3& start, const Vec3& direction, float distance)
 {
-    std::vector<RaycastResult3D> results;
-    std::vector<RaycastResult3D> resultImpact;
+    FrameArenaScope              frameScope(g_theGame->m_frameArena);
+    FrameVector<RaycastResult3D> results((FrameAllocator<RaycastResult3D>(g_theGame->m_frameArena)));
+    FrameVector<RaycastResult3D> resultImpact((FrameAllocator<RaycastResult3D>(g_theGame->m_frameArena)));
     resultImpact.reserve(4);
     results.reserve(4);
     RaycastResult3D result;
@@ -642,6 +1144,156 @@ RaycastResult3D Map::RaycastWorldActors(Actor* actor, ActorHandle& resultActorHi
     return closestHit.raycastResult;
 }
 
+void Map::RunRaycastBenchmark(int numRays)
+{
+    if (numRays <= 0)
+        return;
+    if (m_regionStreamer)
+        m_regionStreamer->LoadRegionsAround(Vec2(static_cast<float>(m_dimensions.x), static_cast<float>(m_dimensions.y)) * 0.5f);
+
+    /// Fixed seed instead of the map stream, the rays are the same every run and the session randomness is untouched
+    RandomStream      rayStream(0x5241594341535453ull);
+    std::vector<Vec3> starts;
+    std::vector<Vec3> directions;
+    starts.reserve(static_cast<size_t>(numRays));
+    directions.reserve(static_cast<size_t>(numRays));
+    for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+    {
+        starts.emplace_back(rayStream.RollRandomFloatInRange(0.f, static_cast<float>(m_dimensions.x)), rayStream.RollRandomFloatInRange(0.f, static_cast<float>(m_dimensions.y)),
+                            0.5f);
+        Vec2 direction = Vec2::MakeFromPolarDegrees(rayStream.RollRandomFloatInRange(0.f, 360.f));
+        directions.emplace_back(direction.x, direction.y, 0.f);
+    }
+
+    int    numHits   = 0;
+    double startTime = GetCurrentTimeSeconds();
+    for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+    {
+        if (RaycastWorldXY(starts[rayIndex], directions[rayIndex], 32.f).m_didImpact)
+            numHits++;
+    }
+    double seconds = GetCurrentTimeSeconds() - startTime;
+    printf("Map::RunRaycastBenchmark    %d rays, %d hits, %.3f ms, %.0f rays per second, %d bytes per tile\n", numRays, numHits, seconds * 1000.0,
+           seconds > 0.0 ? static_cast<double>(numRays) / seconds : 0.0, static_cast<int>(sizeof(Tile)));
+}
+
+void Map::RunTunnellingBenchmark(int numProjectiles)
+{
+    if (numProjectiles <= 0)
+        return;
+    if (m_regionStreamer)
+        m_regionStreamer->LoadRegionsAround(Vec2(static_cast<float>(m_dimensions.x), static_cast<float>(m_dimensions.y)) * 0.5f);
+    std::string            actorName  = g_gameConfigBlackboard.GetValue("mapTunnellingBenchmarkActor", "PlasmaProjectile");
+    const ActorDefinition* definition = ActorDefinition::GetByName(actorName);
+    if (!definition)
+    {
+        printf("Map::RunTunnellingBenchmark    Unknown actor definition \"%s\"\n", actorName.c_str());
+        return;
+    }
+    float radius     = definition->m_physicsRadius;
+    float halfHeight = definition->m_physicsHeight * 0.5f;
+    float stepLength = g_gameConfigBlackboard.GetValue("mapTunnellingBenchmarkStepLength", 4.f); // Tiles moved in one step.
+
+    /// One tile thick walls, a solid tile with open tiles on both sides, once per side it can be approached from
+    std::vector<IntVec2> wallTiles;
+    std::vector<IntVec2> wallNormals;
+    for (int y = 0; y < m_dimensions.y; y++)
+    {
+        for (int x = 0; x < m_dimensions.x; x++)
+        {
+            if (!GetTileIsSolid(IntVec2(x, y)))
+                continue;
+            IntVec2 axes[2] = {IntVec2(1, 0), IntVec2(0, 1)};
+            for (const IntVec2& axis : axes)
+            {
+                if (GetTileIsSolid(IntVec2(x - axis.x, y - axis.y)) || GetTileIsSolid(IntVec2(x + axis.x, y + axis.y)))
+                    continue;
+                wallTiles.emplace_back(x, y);
+                wallNormals.emplace_back(axis);
+                wallTiles.emplace_back(x, y);
+                wallNormals.emplace_back(-axis.x, -axis.y);
+            }
+        }
+    }
+    if (wallTiles.empty())
+    {
+        printf("Map::RunTunnellingBenchmark    The map has no one tile thick walls\n");
+        return;
+    }
+
+    /// Fixed seed, each projectile starts clear of the walls in front of a random wall face and aims at a random point of it
+    RandomStream      projectileStream(0x54554E4E454C5321ull);
+    std::vector<Vec3> starts;
+    std::vector<Vec3> directions;
+    starts.reserve(static_cast<size_t>(numProjectiles));
+    directions.reserve(static_cast<size_t>(numProjectiles));
+    for (int attempt = 0; attempt < numProjectiles * 4 && static_cast<int>(starts.size()) < numProjectiles; attempt++)
+    {
+        int  wallIndex  = projectileStream.RollRandomIntLessThan(static_cast<int>(wallTiles.size()));
+        auto normal     = Vec2(static_cast<float>(wallNormals[wallIndex].x), static_cast<float>(wallNormals[wallIndex].y));
+        Vec2 tangent    = normal.GetRotated90Degrees();
+        auto wallCenter = Vec2(static_cast<float>(wallTiles[wallIndex].x) + 0.5f, static_cast<float>(wallTiles[wallIndex].y) + 0.5f);
+        Vec2 start      = wallCenter + normal * (0.5f + radius + projectileStream.RollRandomFloatInRange(0.01f, 0.5f)) + tangent * projectileStream.RollRandomFloatInRange(-0.5f, 0.5f);
+        Vec2 target     = wallCenter + tangent * projectileStream.RollRandomFloatInRange(-0.5f, 0.5f);
+        if (GetDiscOverlapsSolidTile(start, radius))
+            continue;
+        Vec2 direction = (target - start).GetNormalized();
+        starts.emplace_back(start.x, start.y, 0.5f);
+        directions.emplace_back(direction.x, direction.y, 0.f);
+    }
+
+    int                  numSweeps = static_cast<int>(starts.size());
+    std::vector<float>   travelled(starts.size());
+    double               startTime = GetCurrentTimeSeconds();
+    for (int sweepIndex = 0; sweepIndex < numSweeps; sweepIndex++)
+    {
+        travelled[sweepIndex] = SweepZCylinderVsWorld(starts[sweepIndex], directions[sweepIndex], stepLength, radius, halfHeight).m_impactDist;
+    }
+    double seconds = GetCurrentTimeSeconds() - startTime;
+
+    /// Tunnelled if the path of the center passes through a solid tile, embedded if the collider ends inside one
+    constexpr float SAMPLE_SPACING = 0.01f;
+    int             numTunnelled   = 0;
+    int             numEmbedded    = 0;
+    for (int sweepIndex = 0; sweepIndex < numSweeps; sweepIndex++)
+    {
+        Vec2 start     = starts[sweepIndex].GetXY();
+        Vec2 direction = directions[sweepIndex].GetXY();
+        for (float sampleDist = 0.f; sampleDist <= travelled[sweepIndex]; sampleDist += SAMPLE_SPACING)
+        {
+            if (GetTileIsSolid(GetTileCoordsForWorldPos(start + direction * sampleDist)))
+            {
+                numTunnelled++;
+                break;
+            }
+        }
+        if (GetDiscOverlapsSolidTile(start + direction * travelled[sweepIndex], radius - 0.001f))
+            numEmbedded++;
+    }
+    printf("Map::RunTunnellingBenchmark    %d projectiles of radius %.3f moving %.2f tiles per step at %d wall faces, %d tunnelled, %d embedded, %.3f ms\n", numSweeps, radius,
+           stepLength, static_cast<int>(wallTiles.size()), numTunnelled, numEmbedded, seconds * 1000.0);
+}
+
+bool Map::GetDiscOverlapsSolidTile(const Vec2& center, float radius)
+{
+    int minX = static_cast<int>(floorf(center.x - radius));
+    int maxX = static_cast<int>(floorf(center.x + radius));
+    int minY = static_cast<int>(floorf(center.y - radius));
+    int maxY = static_cast<int>(floorf(center.y + radius));
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++)
+        {
+            if (!GetTileIsSolid(IntVec2(x, y)))
+                continue;
+            auto nearest = Vec2(GetClamped(center.x, static_cast<float>(x), static_cast<float>(x + 1)), GetClamped(center.y, static_cast<float>(y), static_cast<float>(y + 1)));
+            if ((nearest - center).GetLengthSquared() < radius * radius)
+                return true;
+        }
+    }
+    return false;
+}
+
 
 void Map::HandleDecreaseSunDirectionX()
 {
@@ -719,13 +1371,15 @@ Actor* Map::AddActorsToMap(Actor* actor)
 {
     if (!actor)
         return nullptr;
-    unsigned int newIndex = 0;
+    auto newIndex = static_cast<unsigned int>(m_actors.size());
     m_actors.push_back(nullptr);
     ++m_nextActorUID;
     ActorHandle handle(m_nextActorUID, newIndex);
     actor->m_map       = this;
     actor->m_handle    = handle;
     m_actors[newIndex] = actor;
+    actor->SetRandomSeed(RandomStream::DeriveSeed(m_randomSeed, m_nextActorUID));
+    RegisterActorSimulation(actor);
     return actor;
 }
 
@@ -740,6 +1394,8 @@ Actor* Map::SpawnActor(const SpawnInfo& spawnInfo)
     actor->m_handle    = handle;
     actor->m_map       = this;
     m_actors[newIndex] = actor;
+    actor->SetRandomSeed(RandomStream::DeriveSeed(m_randomSeed, m_nextActorUID));
+    RegisterActorSimulation(actor);
     actor->PostInitialize();
     return actor;
 }
@@ -750,28 +1406,78 @@ Actor* Map::SpawnPlayer(PlayerController* playerController)
     spawnInfo.m_actorName = "Marine";
     std::vector<Actor*> spawnPoints;
     GetActorsByName(spawnPoints, "SpawnPoint");
-    int    randomIndex   = g_rng->RollRandomIntInRange(0, static_cast<int>(spawnPoints.size()) - playerController->m_index); // Random player spawn
+    int    randomIndex   = m_randomStream.RollRandomIntInRange(0, static_cast<int>(spawnPoints.size()) - playerController->m_index); // Random player spawn
     Actor* spawnPoint    = spawnPoints[randomIndex];
     spawnInfo.m_position = spawnPoint->m_position;
     //spawnPoint->m_orientation.m_yawDegrees = -90;
     spawnInfo.m_orientation = Vec3(spawnPoint->m_orientation);
     spawnInfo.m_velocity    = spawnPoint->m_velocity;
-    Actor* playerActor      = SpawnActor(spawnInfo);
+    if (m_regionStreamer)
+        m_regionStreamer->LoadRegionsAround(Vec2(spawnInfo.m_position.x, spawnInfo.m_position.y)); // Respawns can land where the regions were evicted.
+    Actor* playerActor = SpawnActor(spawnInfo);
     playerController->m_map = this;
     return playerActor;
 }
 
-void Map::CheckAndRespawnPlayer()
+void Map::RespawnPlayer(PlayerController* playerController)
 {
-    for (PlayerController* controller : g_theGame->m_localPlayerControllers)
+    if (playerController->GetActor())
+        return;
+    Actor* playerActor = SpawnPlayer(playerController);
+    g_theWidgetSubsystem->RemoveFromPlayerViewport(playerController, "WidgetPlayerDeath");
+    printf("Map::RespawnPlayer      Player spawned at: (%f, %f, %f)\n", playerActor->m_position.x, playerActor->m_position.y, playerActor->m_position.z);
+    playerController->Possess(playerActor->m_handle);
+}
+
+void Map::SchedulePlayerRespawn(int playerIndex)
+{
+    float respawnSeconds = g_gameConfigBlackboard.GetValue("playerRespawnSeconds", 0.f);
+    m_timerWheel.Schedule(respawnSeconds, {ActorHandle::INVALID, TimerEventType::PLAYER_RESPAWN, static_cast<unsigned char>(playerIndex)});
+}
+
+void Map::UpdateTimers()
+{
+    m_expiredTimers.clear();
+    m_timerWheel.Advance(g_theGame->m_simulationDeltaSeconds, m_expiredTimers);
+    for (const TimerEvent& event : m_expiredTimers)
+    {
+        HandleTimerEvent(event);
+    }
+}
+
+void Map::HandleTimerEvent(const TimerEvent& event)
+{
+    if (event.m_type == TimerEventType::PLAYER_RESPAWN)
+    {
+        PlayerController* playerController = g_theGame->GetLocalPlayer(event.m_index);
+        if (playerController)
+            RespawnPlayer(playerController);
+        return;
+    }
+
+    Actor* actor = GetActorByHandle(event.m_actor);
+    if (!actor)
+        return; // Deleted since the timer was scheduled.
+    Weapon* weapon = event.m_index < actor->m_weapons.size() ? actor->m_weapons[event.m_index] : nullptr;
+    switch (event.m_type)
     {
-        if (!controller->GetActor())
+    case TimerEventType::ACTOR_ANIMATION_END:
+        actor->OnAnimationEnd();
+        break;
+    case TimerEventType::WEAPON_ANIMATION_END:
+        if (weapon)
+            weapon->OnAnimationEnd();
+        break;
+    case TimerEventType::CORPSE_EXPIRE:
         {
-            Actor* playerActor = SpawnPlayer(controller);
-            g_theWidgetSubsystem->RemoveFromPlayerViewport(controller, "WidgetPlayerDeath");
-            printf("Map::CheckAndRespawnPlayer      Player spawned at: (%f, %f, %f)\n", playerActor->m_position.x, playerActor->m_position.y, playerActor->m_position.z);
-            controller->Possess(playerActor->m_handle);
+            actor->OnCorpseExpired();
+            auto playerController = dynamic_cast<PlayerController*>(actor->m_controller);
+            if (playerController)
+                SchedulePlayerRespawn(playerController->GetControllerIndex());
+            break;
         }
+    default:
+        break; // The refire timer only has to expire, the weapon polls it when firing.
     }
 }
 
@@ -942,8 +1648,290 @@ void Map::DeleteDestroyedActors()
         if (actor && actor->m_handle.IsValid() && actor->m_bIsGarbage)
         {
             unsigned int index = actor->m_handle.GetIndex();
+            UnregisterActorSimulation(actor);
             delete actor;
             m_actors[index] = nullptr;
         }
     }
 }
+
+void Map::RegisterActorSimulation(Actor* actor)
+{
+    if (actor->IsStaticActor())
+    {
+        actor->m_simulationState     = ActorSimulationState::STATIONARY;
+        actor->m_simulationListIndex = static_cast<int>(m_staticActors.size());
+        m_staticActors.push_back(actor);
+        return;
+    }
+    actor->m_simulationState     = ActorSimulationState::ACTIVE;
+    actor->m_simulationListIndex = static_cast<int>(m_activeActors.size());
+    m_activeActors.push_back(actor);
+}
+
+void Map::UnregisterActorSimulation(Actor* actor)
+{
+    std::vector<Actor*>* list = &m_activeActors;
+    if (actor->m_simulationState == ActorSimulationState::SLEEPING)
+        list = &m_sleepingActors;
+    else if (actor->m_simulationState == ActorSimulationState::STATIONARY)
+        list = &m_staticActors;
+
+    int index = actor->m_simulationListIndex;
+    if (index < 0 || index >= static_cast<int>(list->size()) || (*list)[index] != actor)
+        return;
+    // Swap and pop, fix the index of the actor that was moved into the hole
+    Actor* moved                 = list->back();
+    (*list)[index]               = moved;
+    moved->m_simulationListIndex = index;
+    list->pop_back();
+    actor->m_simulationListIndex = -1;
+}
+
+void Map::SetActorSimulationState(Actor* actor, ActorSimulationState newState)
+{
+    if (actor->m_simulationState == newState)
+        return;
+    UnregisterActorSimulation(actor);
+    std::vector<Actor*>* list = &m_activeActors;
+    if (newState == ActorSimulationState::SLEEPING)
+        list = &m_sleepingActors;
+    else if (newState == ActorSimulationState::STATIONARY)
+        list = &m_staticActors;
+    actor->m_simulationState     = newState;
+    actor->m_simulationListIndex = static_cast<int>(list->size());
+    list->push_back(actor);
+}
+
+void Map::WakeActor(Actor* actor)
+{
+    SetActorSimulationState(actor, ActorSimulationState::ACTIVE);
+}
+
+void Map::UpdateSleepingActors()
+{
+    for (int i = static_cast<int>(m_activeActors.size()) - 1; i >= 0; --i)
+    {
+        Actor* actor = m_activeActors[i];
+        if (actor->CanSleep())
+        {
+            actor->m_velocity = Vec3::ZERO;
+            SetActorSimulationState(actor, ActorSimulationState::SLEEPING);
+        }
+    }
+}
+
+bool Map::GetActorIsSimulated(const Actor* actor) const
+{
+    return actor && !actor->m_bIsDead && actor->m_simulationState != ActorSimulationState::STATIONARY;
+}
+
+void Map::ClearActors()
+{
+    for (Actor* actor : m_actors)
+    {
+        delete actor;
+    }
+    m_actors.clear();
+    m_timerWheel.Clear();
+    m_activeActors.clear();
+    m_sleepingActors.clear();
+    m_staticActors.clear();
+    m_actorPairs.clear();
+    m_exitedContacts.clear();
+    m_contactCache.Clear();
+}
+
+void Map::WriteSnapshot(ByteBufferWriter& writer) const
+{
+    writer.Write(m_randomSeed);
+    writer.Write(m_randomStream.GetCounter());
+    writer.Write(m_nextActorUID);
+    WriteVec3(writer, m_sunDirection);
+    writer.Write(m_sunIntensity);
+    writer.Write(m_ambientIntensity);
+    writer.Write(g_theGame->m_simulationTotalSeconds);
+
+    /// Definition table, each actor only stores an index into it
+    std::vector<const ActorDefinition*> definitions;
+    std::vector<unsigned short>         definitionIndices(m_actors.size(), SNAPSHOT_EMPTY_SLOT);
+    for (size_t i = 0; i < m_actors.size(); ++i)
+    {
+        if (!m_actors[i])
+            continue;
+        auto it = std::find(definitions.begin(), definitions.end(), m_actors[i]->m_definition);
+        if (it == definitions.end())
+        {
+            definitions.push_back(m_actors[i]->m_definition);
+            it = definitions.end() - 1;
+        }
+        definitionIndices[i] = static_cast<unsigned short>(it - definitions.begin());
+    }
+    writer.Write(static_cast<unsigned short>(definitions.size()));
+    for (const ActorDefinition* definition : definitions)
+    {
+        writer.WriteString(definition->m_name);
+    }
+
+    /// Actor slots, empty ones keep their place so every handle index stays the same
+    writer.Write(static_cast<unsigned int>(m_actors.size()));
+    for (size_t i = 0; i < m_actors.size(); ++i)
+    {
+        writer.Write(definitionIndices[i]);
+        if (!m_actors[i])
+            continue;
+        writer.Write(m_actors[i]->m_handle.GetData());
+        m_actors[i]->WriteSnapshot(writer);
+    }
+    m_contactCache.WriteSnapshot(writer);
+
+    /// Local players
+    writer.Write(static_cast<unsigned char>(g_theGame->m_localPlayerControllers.size()));
+    for (const PlayerController* controller : g_theGame->m_localPlayerControllers)
+    {
+        writer.Write(controller->m_index);
+        writer.Write(controller->m_actorHandle.GetData());
+        writer.Write(controller->m_bCameraMode);
+        WriteVec3(writer, controller->m_position);
+        WriteEulerAngles(writer, controller->m_orientation);
+    }
+}
+
+bool Map::ReadSnapshot(ByteBufferReader& reader, MapSnapshotData& outData)
+{
+    outData.m_randomSeed       = reader.Read<unsigned long long>();
+    outData.m_randomCounter    = reader.Read<unsigned long long>();
+    outData.m_nextActorUID     = reader.Read<unsigned int>();
+    outData.m_sunDirection     = ReadVec3(reader);
+    outData.m_sunIntensity     = reader.Read<float>();
+    outData.m_ambientIntensity = reader.Read<float>();
+    outData.m_totalSeconds     = reader.Read<float>();
+
+    outData.m_definitionNames.resize(reader.Read<unsigned short>());
+    for (std::string& definitionName : outData.m_definitionNames)
+    {
+        reader.ReadString(definitionName);
+        if (!ActorDefinition::GetByName(definitionName))
+        {
+            printf("Map::ReadSnapshot    Unknown actor definition \"%s\"\n", definitionName.c_str());
+            return false;
+        }
+    }
+
+    unsigned int numSlots = reader.Read<unsigned int>();
+    if (!reader.IsValid() || numSlots > MAX_ACTOR_UID)
+        return false;
+    outData.m_slots.resize(numSlots);
+    for (MapSnapshotData::ActorSlot& slot : outData.m_slots)
+    {
+        slot.m_definitionIndex = reader.Read<unsigned short>();
+        if (slot.m_definitionIndex == SNAPSHOT_EMPTY_SLOT)
+            continue;
+        if (slot.m_definitionIndex >= outData.m_definitionNames.size())
+            return false;
+        slot.m_handleData = reader.Read<unsigned int>();
+        Actor::ReadSnapshot(reader, slot.m_state);
+        if (!reader.IsValid())
+            return false;
+    }
+
+    outData.m_contactCache.ReadSnapshot(reader);
+
+    outData.m_players.resize(reader.Read<unsigned char>());
+    for (MapSnapshotData::Player& player : outData.m_players)
+    {
+        player.m_playerIndex = reader.Read<int>();
+        player.m_actorHandle = ActorHandle(reader.Read<unsigned int>());
+        player.m_bCameraMode = reader.Read<bool>();
+        player.m_position    = ReadVec3(reader);
+        player.m_orientation = ReadEulerAngles(reader);
+    }
+    return reader.IsValid();
+}
+
+void Map::ApplySnapshot(const MapSnapshotData& data)
+{
+    ClearActors();
+    m_randomSeed = data.m_randomSeed;
+    m_randomStream.SetSeed(data.m_randomSeed);
+    m_randomStream.SetCounter(data.m_randomCounter);
+    m_nextActorUID                      = data.m_nextActorUID;
+    m_sunDirection                      = data.m_sunDirection;
+    m_sunIntensity                      = data.m_sunIntensity;
+    m_ambientIntensity                  = data.m_ambientIntensity;
+    g_theGame->m_simulationTotalSeconds = data.m_totalSeconds;
+
+    /// Create every actor first, the handles they reference may point to later slots
+    unsigned int numSlots = static_cast<unsigned int>(data.m_slots.size());
+    m_actors.resize(numSlots, nullptr);
+    for (unsigned int i = 0; i < numSlots; ++i)
+    {
+        const MapSnapshotData::ActorSlot& slot = data.m_slots[i];
+        if (slot.m_definitionIndex == SNAPSHOT_EMPTY_SLOT)
+            continue;
+        SpawnInfo spawnInfo;
+        spawnInfo.m_actorName = data.m_definitionNames[slot.m_definitionIndex];
+        auto actor            = new Actor(spawnInfo);
+        actor->m_map          = this;
+        actor->m_handle       = ActorHandle(slot.m_handleData);
+        m_actors[i]           = actor;
+        RegisterActorSimulation(actor);
+        actor->PostInitialize(false);
+        actor->RestoreSnapshot(slot.m_state);
+    }
+    m_contactCache = data.m_contactCache;
+
+    /// Relink actor references
+    for (unsigned int i = 0; i < numSlots; ++i)
+    {
+        Actor* actor = m_actors[i];
+        if (!actor)
+            continue;
+        const ActorSnapshot& state = data.m_slots[i].m_state;
+        if (state.m_ownerHandleData != 0)
+            actor->m_owner = GetActorByHandle(ActorHandle(state.m_ownerHandleData));
+        if (actor->m_aiController && state.m_targetHandleData != 0)
+            actor->m_aiController->SetTargetActorHandle(ActorHandle(state.m_targetHandleData));
+    }
+
+    /// Local players possess their actors again
+    for (const MapSnapshotData::Player& player : data.m_players)
+    {
+        PlayerController* controller = g_theGame->GetLocalPlayer(player.m_playerIndex);
+        if (!controller)
+            continue;
+        ActorHandle actorHandle = player.m_actorHandle;
+        if (GetActorByHandle(actorHandle))
+        {
+            controller->Possess(actorHandle);
+        }
+        else
+        {
+            controller->m_actorHandle = actorHandle;
+            SchedulePlayerRespawn(player.m_playerIndex); // The pending respawn was dropped with the old timers.
+        }
+        controller->m_bCameraMode = player.m_bCameraMode;
+        controller->m_position    = player.m_position;
+        controller->m_orientation = player.m_orientation;
+    }
+}
+
+void Map::CaptureDefinitionBindings(std::vector<ActorDefinitionBinding>& outBindings) const
+{
+    outBindings.clear();
+    outBindings.resize(m_actors.size());
+    for (int i = 0; i < static_cast<int>(m_actors.size()); ++i)
+    {
+        if (m_actors[i])
+            outBindings[i] = m_actors[i]->CaptureDefinitionBinding();
+    }
+}
+
+void Map::RebindDefinitions(const std::vector<ActorDefinitionBinding>& bindings)
+{
+    for (int i = 0; i < static_cast<int>(m_actors.size()) && i < static_cast<int>(bindings.size()); ++i)
+    {
+        if (m_actors[i])
+            m_actors[i]->RebindDefinitions(bindings[i]);
+    }
+}
@@ -2,11 +2,14 @@
 #include <vector>
 
 #include "Actor.hpp"
+#include "ActorContactCache.hpp"
 #include "Tile.hpp"
+#include "TimerWheel.hpp"
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/RaycastUtils.hpp"
 #include "Game/Definition/MapDefinition.hpp"
+#include "Game/Framework/RandomStream.hpp"
 
 
 struct ActorHandle;
@@ -23,6 +26,13 @@ class AABB2;
 class AABB3;
 struct Vertex_PCU;
 struct LightingConstants;
+class ByteBufferWriter;
+class ByteBufferReader;
+enum class ActorSimulationState;
+struct ActorDefinitionBinding;
+class MapRegionSource;
+class MapRegionStreamer;
+struct MapSnapshotData;
 
 class Map
 {
@@ -36,10 +46,15 @@ public:
 
     void CreateTiles();
     void CreateGeometry();
+    /// Floor, wall and ceiling quads of one tile. Only reads the map definition, streaming workers call it concurrently.
+    void AddGeometryForTile(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indices, const Tile& tile, const IntVec2& tileCoords) const;
     void AddGeometryForWall(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indices, const AABB3& bounds, const AABB2& UVs) const;
     void AddGeometryForFloor(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indices, const AABB3& bounds, const AABB2& UVs) const;
     void AddGeometryForCeiling(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indices, const AABB3& bounds, const AABB2& UVs) const;
     void CreateBuffers();
+    /// Streamed maps keep only the regions around the players instead of every tile and the whole geometry.
+    void CreateRegionStreamer();
+    void UpdateRegionStreaming(); // Stream the regions around every player actor in.
 
     bool    IsPositionInBounds(Vec3 position, float tolerance = 0.f) const;
     IntVec2 GetTileCoordsForWorldPos(const Vec2& worldCoords);
@@ -51,14 +66,50 @@ public:
     Tile*   GetTile(const Vec2& worldCoords);
     bool    GetTileIsInBound(const IntVec2& coords);
     bool    GetTileIsSolid(const IntVec2& coords);
+    /// Tiles only store their definition, the coordinates and bounds follow from the row major index.
+    IntVec2 GetTileCoords(int tileIndex) const;
+    AABB3   GetTileBounds(const IntVec2& tileCoords) const;
+
+    const MapDefinition* GetDefinition() const;
+    unsigned long long   GetRandomSeed() const;
 
     void Update();
     void EndFrame();
+    /// Test every unordered pair of simulated actors once, resolve the overlapping ones and raise enter, stay and exit
+    /// events through the contact cache. Pairs that did not move since their last resolution are not re-tested.
     void ColliedWithActors();
-    void ColliedActors(Actor* actorA, Actor* actorB);
+    /// Broad phase, fill the contact buffer with the pairs that need a narrow phase test this step.
+    void BuildActorPairs(std::vector<ActorPairContact>& outPairs);
+    /// Run the narrow phase over the contact buffer, in parallel or serially as a reference.
+    void RunNarrowPhase(std::vector<ActorPairContact>& pairs, bool bParallel) const;
+    /// Narrow phase of a single pair, only reads the actors and writes the pair entry. Projectiles never push since
+    /// their hits are handled by the enter event.
+    static void ComputeActorPairContact(ActorPairContact& pair);
+    /// Apply the push out displacements in buffer order with the same result as resolving the pairs one after another.
+    /// A pair whose actors were already pushed this step is recomputed against their new positions.
+    void ApplyActorPairDisplacements(std::vector<ActorPairContact>& pairs);
+    /// Update the contact cache and raise the enter and stay events in buffer order.
+    void RaiseActorPairEvents(const std::vector<ActorPairContact>& pairs);
+    /// Serial reference of the solve, resolve the pairs one after another on a copy of the buffer, keep the final
+    /// actor positions and rewind the actors to where they were.
+    void ResolveActorPairsSerially(const std::vector<ActorPairContact>& pairs, std::vector<Vec3>& outFinalPositions);
+    /// Die if any actor of the buffer did not end up bit-identical to the serial reference.
+    void VerifyNarrowPhase(const std::vector<ActorPairContact>& pairs, const std::vector<Vec3>& expectedPositions) const;
     void ColliedActorsWithMap();
     void ColliedActorWithMap(Actor* actor);
     void PushActorOutOfTile(Actor* actor, const IntVec2& tileCoords);
+    /// Continuous collision
+    void ColliedProjectilesSwept();
+    /// Sweep the projectile collider from its last position to the current one, stop it at the first tile or actor it
+    /// touches so fast projectiles can not tunnel through thin walls or targets within a single frame.
+    /// @param projectile Actor that has an owner and is still alive.
+    /// @return true if the sweep hit something and the projectile was moved back to the contact position.
+    bool SweepProjectile(Actor* projectile);
+    /// Sweep a ZCylinder centered at center against solid tiles, floor and ceiling. The walls are traced with the DDA in
+    /// RaycastWorldXY along the cylinder center and both of its XY flanks.
+    RaycastResult3D SweepZCylinderVsWorld(const Vec3& center, const Vec3& direction, float distance, float radius, float halfHeight);
+    /// Sweep the projectile collider against other actors, each target cylinder is inflated by the projectile radius and height.
+    RaycastResult3D SweepZCylinderVsActors(Actor* projectile, ActorHandle& resultActorHit, const Vec3& center, const Vec3& direction, float distance);
 
     void              Render(PlayerController* toPlayer);
     LightingConstants GetLightConstants();
@@ -69,6 +120,12 @@ public:
     RaycastResult3D RaycastWorldZ(const Vec3& start, const Vec3& direction, float distance);
     RaycastResult3D RaycastWorldActors(const Vec3& start, const Vec3& direction, float distance);
     RaycastResult3D RaycastWorldActors(Actor* actor, ActorHandle& resultActorHit, const Vec3& start, const Vec3& direction, float distance);
+    /// Cast rays from random positions in random XY directions against the tiles and report the rays per second.
+    void RunRaycastBenchmark(int numRays);
+    /// Sweep fast projectile colliders at the one tile thick walls of the map for a single step and report how many
+    /// ended up past a wall or overlapping a solid tile.
+    void RunTunnellingBenchmark(int numProjectiles);
+    bool GetDiscOverlapsSolidTile(const Vec2& center, float radius);
 
     ///
     /// Lighting
@@ -85,13 +142,38 @@ public:
     Actor* AddActorsToMap(Actor* actor);
     Actor* SpawnActor(const SpawnInfo& spawnInfo);
     Actor* SpawnPlayer(PlayerController* playerController); // Spawn a marine actor at a random spawn point and possess it with the player.
-    void   CheckAndRespawnPlayer();
+    void   RespawnPlayer(PlayerController* playerController); // Spawn and possess a new actor if the player has none.
+    void   SchedulePlayerRespawn(int playerIndex);
+    /// Advance the timer wheel by the simulation step and dispatch the expired timers to their actors.
+    void UpdateTimers();
+    void HandleTimerEvent(const TimerEvent& event);
     Actor* GetActorByHandle(ActorHandle handle) const;
     Actor* GetActorByName(const std::string& name) const;
     Actor* GetClosestVisibleEnemy(Actor* instigator); //Search the actor list to find actors meeting the provided criteria.
     void   GetActorsByName(std::vector<Actor*>& inActors, const std::string& name) const;
     Actor* DebugPossessNext(); // Have the player controller possess the next actor in the list that can be possessed
     void   DeleteDestroyedActors(); // Delete any actors marked as destroyed.
+    /// Simulation lists
+    void RegisterActorSimulation(Actor* actor); // Put a newly spawned actor into the static or active list.
+    void UnregisterActorSimulation(Actor* actor); // Remove the actor from whichever simulation list it lives in.
+    void SetActorSimulationState(Actor* actor, ActorSimulationState newState); // Move the actor between simulation lists.
+    void WakeActor(Actor* actor);
+    void UpdateSleepingActors(); // Put active actors that came to rest into the sleeping list.
+    bool GetActorIsSimulated(const Actor* actor) const; // Whether or not the actor takes part in the per-frame collision.
+    void ClearActors(); // Delete every actor and reset the simulation lists and the contact cache.
+
+    /// Snapshot
+    void WriteSnapshot(ByteBufferWriter& writer) const;
+    /// Parse the body written by WriteSnapshot without touching any map. Return false if the snapshot is truncated or
+    /// names an unknown actor definition.
+    static bool ReadSnapshot(ByteBufferReader& reader, MapSnapshotData& outData);
+    /// Replace every actor with the ones of a parsed snapshot, keeping their handles so owners, AI targets, contacts
+    /// and player possessions relink.
+    void ApplySnapshot(const MapSnapshotData& data);
+
+    /// Definition hot reload
+    void CaptureDefinitionBindings(std::vector<ActorDefinitionBinding>& outBindings) const; // Parallel to the actor list.
+    void RebindDefinitions(const std::vector<ActorDefinitionBinding>& bindings);
 
     /// 
     Game* m_game = nullptr;
@@ -99,13 +181,37 @@ public:
 protected:
     // Map
     const MapDefinition* m_definition = nullptr;
-    std::vector<Tile>    m_tiles;
+    std::vector<Tile>    m_tiles; // Every tile of a map that is not streamed.
     IntVec2              m_dimensions;
+    MapRegionSource*     m_regionSource   = nullptr;
+    MapRegionStreamer*   m_regionStreamer = nullptr; // Owns the tiles and geometry of a streamed map.
+    std::vector<Vec2>    m_focusPositions; // Scratch buffer of the player positions the regions stream around.
 
     /// Actors
     std::vector<Actor*>           m_actors;
-    static constexpr unsigned int MAX_ACTOR_UID  = 0x0000fffeu;
-    unsigned int                  m_nextActorUID = 3568;
+    std::vector<Actor*>           m_activeActors;
+    std::vector<Actor*>           m_sleepingActors;
+    std::vector<Actor*>           m_staticActors;
+    int                           m_numActorsSkippedLastFrame = 0;
+    ActorContactCache             m_contactCache;
+    std::vector<ActorContact>     m_exitedContacts; // Scratch buffer of contacts that ended in the current step.
+    std::vector<ActorPairContact> m_actorPairs; // Contact buffer of the current step.
+    bool                          m_bParallelNarrowPhase = true;
+    bool                          m_bVerifyNarrowPhase   = false;
+    bool                          m_bDrawActorColliders  = false; // Draw the collision shapes of the actors over their sprites.
+    unsigned int                  m_actorCollisionStep   = 0; // Stamped on the actors pushed during the current step.
+    std::vector<Vec3>             m_referencePositions; // Final positions of the serial reference, two per pair.
+    static constexpr unsigned int MAX_ACTOR_UID               = 0x0000fffeu;
+    unsigned int                  m_nextActorUID              = 3568;
+    /// Animation ends, corpse expiry, weapon refire and respawn delays, keyed by actor handle.
+    static constexpr float        TIMER_TICK_SECONDS          = 1.f / 120.f;
+    TimerWheel                    m_timerWheel                = TimerWheel(TIMER_TICK_SECONDS);
+    std::vector<TimerEvent>       m_expiredTimers; // Scratch buffer of the timers that expired in the current step.
+    /// 
+
+    /// Random
+    unsigned long long m_randomSeed = 0; // Root seed, every actor stream is derived from it and the actor uid.
+    RandomStream       m_randomStream; // Map level rolls such as the player spawn point.
     /// 
 
     /// Lighting
@@ -121,4 +227,6 @@ protected:
     Shader*                    m_shader       = nullptr;
     VertexBuffer*              m_vertexBuffer = nullptr;
     IndexBuffer*               m_indexBuffer  = nullptr;
+    std::vector<Vertex_PCUTBN> m_actorLitVertexes; // Scratch of Actor::Render, keeps its capacity between actors and frames.
+    std::vector<Vertex_PCU>    m_actorUnlitVertexes;
 };
@@ -0,0 +1,162 @@
+﻿#include "MapRegionSource.hpp"
+
+#include <fstream>
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Game/Definition/DefinitionCache.hpp"
+#include "Game/Definition/TileDefinition.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Framework/ByteBufferMath.hpp"
+#include "Game/Framework/RandomStream.hpp"
+
+static constexpr size_t MAP_REGION_FILE_HEADER_SIZE = 36; // Magic, version, image size, image write time, dimensions and region size.
+
+bool MapRegionFile::Open(const std::string& imagePath, const Image& image, int regionSize)
+{
+    m_path       = GetRegionFilePath(imagePath);
+    m_dimensions = image.GetDimensions();
+    m_regionSize = regionSize;
+    m_numRegions = IntVec2((m_dimensions.x + regionSize - 1) / regionSize, (m_dimensions.y + regionSize - 1) / regionSize);
+    m_bodyOffset = MAP_REGION_FILE_HEADER_SIZE;
+
+    unsigned long long imageSize      = 0;
+    long long          imageWriteTime = 0;
+    DefinitionCache::GetSourceFileStamp(imagePath.c_str(), imageSize, imageWriteTime);
+    if (ReadHeader(imageSize, imageWriteTime, regionSize))
+        return true;
+    return Cook(image, imageSize, imageWriteTime, regionSize) && ReadHeader(imageSize, imageWriteTime, regionSize);
+}
+
+bool MapRegionFile::ReadRegion(const IntVec2& regionCoords, int regionSize, std::vector<unsigned char>& outTileIndexes) const
+{
+    size_t regionBytes = static_cast<size_t>(regionSize) * static_cast<size_t>(regionSize);
+    outTileIndexes.assign(regionBytes, TILE_DEFINITION_NONE);
+    if (regionSize != m_regionSize || regionCoords.x < 0 || regionCoords.y < 0 || regionCoords.x >= m_numRegions.x || regionCoords.y >= m_numRegions.y)
+        return false;
+    std::ifstream file(m_path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    size_t regionIndex = static_cast<size_t>(regionCoords.x) + static_cast<size_t>(regionCoords.y) * static_cast<size_t>(m_numRegions.x);
+    file.seekg(static_cast<std::streamoff>(m_bodyOffset + regionIndex * regionBytes));
+    file.read(reinterpret_cast<char*>(outTileIndexes.data()), static_cast<std::streamsize>(regionBytes));
+    return static_cast<size_t>(file.gcount()) == regionBytes;
+}
+
+std::string MapRegionFile::GetRegionFilePath(const std::string& imagePath)
+{
+    return imagePath + ".regions";
+}
+
+bool MapRegionFile::ReadHeader(unsigned long long imageSize, long long imageWriteTime, int regionSize)
+{
+    std::ifstream file(m_path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    unsigned char header[MAP_REGION_FILE_HEADER_SIZE] = {};
+    file.read(reinterpret_cast<char*>(header), MAP_REGION_FILE_HEADER_SIZE);
+    if (file.gcount() != static_cast<std::streamsize>(MAP_REGION_FILE_HEADER_SIZE))
+        return false;
+    ByteBufferReader   reader(header, MAP_REGION_FILE_HEADER_SIZE);
+    unsigned int       magic            = reader.Read<unsigned int>();
+    unsigned int       version          = reader.Read<unsigned int>();
+    unsigned long long cookedSize       = reader.Read<unsigned long long>();
+    long long          cookedTime       = reader.Read<long long>();
+    IntVec2            dimensions       = ReadIntVec2(reader);
+    int                cookedRegionSize = reader.Read<int>();
+    if (magic != MAP_REGION_FILE_MAGIC || version != MAP_REGION_FILE_VERSION || cookedSize != imageSize || cookedTime != imageWriteTime || dimensions != m_dimensions ||
+        cookedRegionSize != regionSize)
+    {
+        printf("MapRegionFile::ReadHeader    \"%s\" is stale or has another region size, cooking it again\n", m_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MapRegionFile::Cook(const Image& image, unsigned long long imageSize, long long imageWriteTime, int regionSize) const
+{
+    ByteBufferWriter writer;
+    writer.Write(MAP_REGION_FILE_MAGIC);
+    writer.Write(MAP_REGION_FILE_VERSION);
+    writer.Write(imageSize);
+    writer.Write(imageWriteTime);
+    WriteIntVec2(writer, m_dimensions);
+    writer.Write(regionSize);
+
+    std::vector<unsigned char> region(static_cast<size_t>(regionSize) * static_cast<size_t>(regionSize));
+    for (int regionY = 0; regionY < m_numRegions.y; regionY++)
+    {
+        for (int regionX = 0; regionX < m_numRegions.x; regionX++)
+        {
+            for (int localY = 0; localY < regionSize; localY++)
+            {
+                for (int localX = 0; localX < regionSize; localX++)
+                {
+                    IntVec2        coords(regionX * regionSize + localX, regionY * regionSize + localY);
+                    unsigned char& tileIndex = region[localX + localY * regionSize];
+                    tileIndex                = TILE_DEFINITION_NONE;
+                    if (coords.x < m_dimensions.x && coords.y < m_dimensions.y)
+                        tileIndex = Tile::GetDefinitionIndex(TileDefinition::GetByTexelColor(image.GetTexelColor(coords)));
+                }
+            }
+            writer.WriteBytes(region.data(), region.size());
+        }
+    }
+    if (!WriteBufferToBinaryFile(writer.GetBuffer(), m_path))
+    {
+        printf("MapRegionFile::Cook    Failed to write \"%s\"\n", m_path.c_str());
+        return false;
+    }
+    printf("MapRegionFile::Cook    Cooked %d x %d regions of %d tiles to \"%s\"\n", m_numRegions.x, m_numRegions.y, regionSize, m_path.c_str());
+    return true;
+}
+
+MapRegionGenerator::MapRegionGenerator(const IntVec2& dimensions, unsigned long long seed): m_dimensions(dimensions), m_seed(seed)
+{
+    m_floorIndex  = Tile::GetDefinitionIndex(TileDefinition::GetByName("StoneFloor"));
+    m_wallIndex   = Tile::GetDefinitionIndex(TileDefinition::GetByName("BrickWall"));
+    m_pillarIndex = Tile::GetDefinitionIndex(TileDefinition::GetByName("WoodWall"));
+}
+
+bool MapRegionGenerator::ReadRegion(const IntVec2& regionCoords, int regionSize, std::vector<unsigned char>& outTileIndexes) const
+{
+    outTileIndexes.resize(static_cast<size_t>(regionSize) * static_cast<size_t>(regionSize));
+    for (int localY = 0; localY < regionSize; localY++)
+    {
+        for (int localX = 0; localX < regionSize; localX++)
+        {
+            outTileIndexes[localX + localY * regionSize] = GetTileIndex(regionCoords.x * regionSize + localX, regionCoords.y * regionSize + localY);
+        }
+    }
+    return true;
+}
+
+unsigned char MapRegionGenerator::GetTileIndex(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_dimensions.x || y >= m_dimensions.y)
+        return TILE_DEFINITION_NONE;
+    if (x == 0 || y == 0 || x == m_dimensions.x - 1 || y == m_dimensions.y - 1)
+        return m_wallIndex;
+
+    /// Room walls, with a two tile door in the middle of each
+    int  roomX  = x % ROOM_SIZE;
+    int  roomY  = y % ROOM_SIZE;
+    bool bDoorX = roomX == ROOM_SIZE / 2 - 1 || roomX == ROOM_SIZE / 2;
+    bool bDoorY = roomY == ROOM_SIZE / 2 - 1 || roomY == ROOM_SIZE / 2;
+    if (roomX == 0 && roomY == 0)
+        return m_wallIndex;
+    if (roomX == 0)
+        return bDoorY ? m_floorIndex : m_wallIndex;
+    if (roomY == 0)
+        return bDoorX ? m_floorIndex : m_wallIndex;
+
+    /// Pillars stay clear of the walls so every door remains reachable
+    bool bInner = roomX >= 3 && roomY >= 3 && roomX <= ROOM_SIZE - 4 && roomY <= ROOM_SIZE - 4;
+    if (bInner && !bDoorX && !bDoorY)
+    {
+        unsigned long long tileId = (static_cast<unsigned long long>(y) << 32) | static_cast<unsigned long long>(x);
+        if (RandomStream::DeriveSeed(m_seed, tileId) % 23 == 0)
+            return m_pillarIndex;
+    }
+    return m_floorIndex;
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+#include "Tile.hpp"
+#include "Engine/Math/IntVec2.hpp"
+
+class Image;
+
+static constexpr unsigned int MAP_REGION_FILE_MAGIC   = 0x4E47524Du; // "MRGN"
+static constexpr unsigned int MAP_REGION_FILE_VERSION = 1;
+
+/// Where the tiles of a streamed map come from. A region is regionSize x regionSize tiles in row major order, every
+/// tile stored as its index in TileDefinition::s_definitions and TILE_DEFINITION_NONE past the map edge. Several streaming workers read regions at once, so
+/// ReadRegion must be safe to call concurrently.
+class MapRegionSource
+{
+public:
+    virtual ~MapRegionSource() = default;
+
+    virtual bool ReadRegion(const IntVec2& regionCoords, int regionSize, std::vector<unsigned char>& outTileIndexes) const = 0;
+};
+
+/// Tile indexes of a map image cooked next to it as "<image>.regions", one byte per tile with every region stored as
+/// one contiguous block, so loading a region is a single seek and read instead of keeping the image resident.
+/// Layout: magic, version, image size and write time, map dimensions, region size, then the region blocks.
+class MapRegionFile : public MapRegionSource
+{
+public:
+    /// Open the region file of the image, cooking it first from the image when it is missing, stale or was cooked
+    /// with another region size. Return false if the file can neither be read nor written.
+    bool Open(const std::string& imagePath, const Image& image, int regionSize);
+    bool ReadRegion(const IntVec2& regionCoords, int regionSize, std::vector<unsigned char>& outTileIndexes) const override;
+
+    static std::string GetRegionFilePath(const std::string& imagePath);
+
+private:
+    bool ReadHeader(unsigned long long imageSize, long long imageWriteTime, int regionSize);
+    bool Cook(const Image& image, unsigned long long imageSize, long long imageWriteTime, int regionSize) const;
+
+    std::string m_path;
+    IntVec2     m_dimensions;
+    IntVec2     m_numRegions;
+    int         m_regionSize = 0;
+    size_t      m_bodyOffset = 0;
+};
+
+/// Procedural tiles for maps far larger than any image would fit in memory. Rooms on a grid, each wall with a door in
+/// its middle and a few pillars inside, every tile is a pure function of the seed and its coordinates.
+class MapRegionGenerator : public MapRegionSource
+{
+public:
+    MapRegionGenerator(const IntVec2& dimensions, unsigned long long seed);
+
+    bool          ReadRegion(const IntVec2& regionCoords, int regionSize, std::vector<unsigned char>& outTileIndexes) const override;
+    unsigned char GetTileIndex(int x, int y) const;
+
+private:
+    static constexpr int ROOM_SIZE = 16; // Tiles between two room walls, including one wall.
+
+    IntVec2            m_dimensions;
+    unsigned long long m_seed        = 0;
+    unsigned char      m_floorIndex  = TILE_DEFINITION_NONE;
+    unsigned char      m_wallIndex   = TILE_DEFINITION_NONE;
+    unsigned char      m_pillarIndex = TILE_DEFINITION_NONE;
+};
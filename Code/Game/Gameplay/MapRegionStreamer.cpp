@@ -0,0 +1,371 @@
+﻿#include "MapRegionStreamer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "Map.hpp"
+#include "MapRegionSource.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Renderer/IndexBuffer.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Definition/TileDefinition.hpp"
+
+MapRegionStreamer::MapRegionStreamer(const Map* map, const MapRegionSource* source, const IntVec2& dimensions, const MapRegionStreamerConfig& config): m_map(map), m_source(source),
+    m_config(config), m_dimensions(dimensions)
+{
+    m_config.m_regionSize         = std::max(4, m_config.m_regionSize);
+    m_config.m_loadRadius         = std::max(0, m_config.m_loadRadius);
+    m_config.m_maxUploadsPerFrame = std::max(1, m_config.m_maxUploadsPerFrame);
+    m_numRegions                  = IntVec2((m_dimensions.x + m_config.m_regionSize - 1) / m_config.m_regionSize, (m_dimensions.y + m_config.m_regionSize - 1) / m_config.m_regionSize);
+    m_regions.resize(static_cast<size_t>(m_numRegions.x) * static_cast<size_t>(m_numRegions.y), nullptr);
+}
+
+void MapRegionStreamer::Startup()
+{
+    int numWorkers = m_config.m_numWorkers;
+    if (numWorkers <= 0)
+        numWorkers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    m_bIsStopping = false;
+    for (int i = 0; i < numWorkers; i++)
+    {
+        m_workers.emplace_back(&MapRegionStreamer::WorkerThreadMain, this);
+    }
+    printf("MapRegionStreamer::Startup    Streaming %d x %d tiles in %d x %d regions of %d tiles on %d workers, load radius %d, memory cap %.1f MB\n", m_dimensions.x, m_dimensions.y,
+           m_numRegions.x, m_numRegions.y, m_config.m_regionSize, numWorkers, m_config.m_loadRadius, static_cast<double>(m_config.m_maxResidentBytes) / (1024.0 * 1024.0));
+}
+
+void MapRegionStreamer::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bIsStopping = true;
+    }
+    m_workCondition.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    m_workQueue.clear();
+    m_builtQueue.clear();
+    m_nextWork = 0;
+    for (MapRegion*& region : m_regions)
+    {
+        if (!region)
+            continue;
+        POINTER_SAFE_DELETE(region->m_vertexBuffer)
+        POINTER_SAFE_DELETE(region->m_indexBuffer)
+        POINTER_SAFE_DELETE(region)
+    }
+    m_residentRegions.clear();
+    printf("MapRegionStreamer::Shutdown    %d regions loaded, %d evicted, %.3f ms of building, peak %.2f MB resident\n", m_numLoads, m_numEvictions, m_totalBuildSeconds * 1000.0,
+           static_cast<double>(m_peakResidentBytes) / (1024.0 * 1024.0));
+    m_residentBytes     = 0;
+    m_numLoadingRegions = 0;
+}
+
+void MapRegionStreamer::Update(const std::vector<Vec2>& focusPositions)
+{
+    m_frame++;
+    ProcessBuiltRegions(m_config.m_maxUploadsPerFrame);
+    for (const Vec2& focusPosition : focusPositions)
+    {
+        RequestRegionsAround(GetRegionCoordsForPosition(focusPosition));
+    }
+    EvictOverBudget();
+}
+
+void MapRegionStreamer::LoadRegionsAround(const Vec2& position)
+{
+    IntVec2 centerRegion = GetRegionCoordsForPosition(position);
+    RequestRegionsAround(centerRegion);
+    while (true)
+    {
+        bool bAllResident = true;
+        for (int y = centerRegion.y - m_config.m_loadRadius; y <= centerRegion.y + m_config.m_loadRadius && bAllResident; y++)
+        {
+            for (int x = centerRegion.x - m_config.m_loadRadius; x <= centerRegion.x + m_config.m_loadRadius; x++)
+            {
+                MapRegion* region = GetRegion(IntVec2(x, y));
+                if (region && region->m_state != MapRegionState::RESIDENT)
+                {
+                    bAllResident = false;
+                    break;
+                }
+            }
+        }
+        if (bAllResident)
+            return;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_builtCondition.wait(lock, [this]() { return !m_builtQueue.empty(); });
+        }
+        ProcessBuiltRegions(static_cast<int>(m_regions.size()));
+    }
+}
+
+void MapRegionStreamer::EvictAllRegions()
+{
+    while (!m_residentRegions.empty())
+    {
+        EvictRegion(m_residentRegions.back());
+    }
+}
+
+Tile* MapRegionStreamer::GetTile(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= m_dimensions.x || y >= m_dimensions.y)
+        return nullptr;
+    int        regionSize = m_config.m_regionSize;
+    MapRegion* region     = m_regions[static_cast<size_t>(x / regionSize) + static_cast<size_t>(y / regionSize) * static_cast<size_t>(m_numRegions.x)];
+    if (!region || region->m_state != MapRegionState::RESIDENT)
+        return nullptr;
+    return &region->m_tiles[(x % regionSize) + (y % regionSize) * regionSize];
+}
+
+void MapRegionStreamer::Render() const
+{
+    for (const MapRegion* region : m_residentRegions)
+    {
+        if (region->m_numIndices > 0)
+            g_theRenderer->DrawIndexedVertexBuffer(region->m_vertexBuffer, region->m_indexBuffer, region->m_numIndices);
+    }
+}
+
+int MapRegionStreamer::GetNumResidentRegions() const
+{
+    return static_cast<int>(m_residentRegions.size());
+}
+
+size_t MapRegionStreamer::GetResidentBytes() const
+{
+    return m_residentBytes;
+}
+
+void MapRegionStreamer::RunWalkBenchmark(const Vec2& start, const Vec2& end, float tilesPerFrame)
+{
+    static constexpr double FRAME_SECONDS = 1.0 / 60.0;
+
+    EvictAllRegions();
+    m_peakResidentBytes = m_residentBytes;
+
+    int    numLoadsBefore     = m_numLoads;
+    int    numEvictionsBefore = m_numEvictions;
+    double buildSecondsBefore = m_totalBuildSeconds;
+    int    numFrames          = std::max(1, static_cast<int>(ceilf((end - start).GetLength() / std::max(tilesPerFrame, 0.01f))));
+    int    numStalledFrames   = 0;
+    double totalUpdateSeconds = 0.0;
+    double maxUpdateSeconds   = 0.0;
+    double benchmarkStartTime = GetCurrentTimeSeconds();
+    printf("MapRegionStreamer::RunWalkBenchmark    Walking %d frames from (%.1f, %.1f) to (%.1f, %.1f) at %.2f tiles per frame\n", numFrames, start.x, start.y, end.x, end.y, tilesPerFrame);
+
+    std::vector<Vec2> focusPositions(1);
+    for (int frame = 0; frame <= numFrames; frame++)
+    {
+        double frameStartTime = GetCurrentTimeSeconds();
+        focusPositions[0]     = start + (end - start) * (static_cast<float>(frame) / static_cast<float>(numFrames));
+        Update(focusPositions);
+        double updateSeconds = GetCurrentTimeSeconds() - frameStartTime;
+        totalUpdateSeconds += updateSeconds;
+        maxUpdateSeconds = std::max(maxUpdateSeconds, updateSeconds);
+        if (!GetTile(static_cast<int>(floorf(focusPositions[0].x)), static_cast<int>(floorf(focusPositions[0].y))))
+            numStalledFrames++;
+
+        double remainingSeconds = FRAME_SECONDS - (GetCurrentTimeSeconds() - frameStartTime);
+        if (remainingSeconds > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(remainingSeconds));
+    }
+
+    int numLoads = m_numLoads - numLoadsBefore;
+    printf("MapRegionStreamer::RunWalkBenchmark    %.2f s, %d of %d frames stalled, update avg %.3f ms max %.3f ms\n", GetCurrentTimeSeconds() - benchmarkStartTime, numStalledFrames,
+           numFrames + 1, totalUpdateSeconds * 1000.0 / static_cast<double>(numFrames + 1), maxUpdateSeconds * 1000.0);
+    printf("MapRegionStreamer::RunWalkBenchmark    %d regions loaded (%.3f ms build avg), %d evicted, peak %.2f MB resident, a full map of tiles alone would be %.2f MB\n", numLoads,
+           numLoads > 0 ? (m_totalBuildSeconds - buildSecondsBefore) * 1000.0 / static_cast<double>(numLoads) : 0.0, m_numEvictions - numEvictionsBefore,
+           static_cast<double>(m_peakResidentBytes) / (1024.0 * 1024.0), static_cast<double>(m_dimensions.x) * static_cast<double>(m_dimensions.y) * sizeof(Tile) / (1024.0 * 1024.0));
+    EvictAllRegions();
+}
+
+MapRegion* MapRegionStreamer::GetRegion(const IntVec2& regionCoords) const
+{
+    if (regionCoords.x < 0 || regionCoords.y < 0 || regionCoords.x >= m_numRegions.x || regionCoords.y >= m_numRegions.y)
+        return nullptr;
+    return m_regions[static_cast<size_t>(regionCoords.x) + static_cast<size_t>(regionCoords.y) * static_cast<size_t>(m_numRegions.x)];
+}
+
+IntVec2 MapRegionStreamer::GetRegionCoordsForPosition(const Vec2& position) const
+{
+    float regionSize = static_cast<float>(m_config.m_regionSize);
+    return IntVec2(static_cast<int>(floorf(position.x / regionSize)), static_cast<int>(floorf(position.y / regionSize)));
+}
+
+void MapRegionStreamer::RequestRegionsAround(const IntVec2& centerRegion)
+{
+    /// Ring by ring so the workers build the regions nearest to the focus first
+    for (int ring = 0; ring <= m_config.m_loadRadius; ring++)
+    {
+        for (int y = centerRegion.y - ring; y <= centerRegion.y + ring; y++)
+        {
+            for (int x = centerRegion.x - ring; x <= centerRegion.x + ring; x++)
+            {
+                if (std::max(abs(x - centerRegion.x), abs(y - centerRegion.y)) != ring)
+                    continue;
+                IntVec2 regionCoords(x, y);
+                if (x < 0 || y < 0 || x >= m_numRegions.x || y >= m_numRegions.y)
+                    continue;
+                MapRegion* region = GetRegion(regionCoords);
+                if (region)
+                    region->m_lastUsedFrame = m_frame;
+                else
+                    RequestRegion(regionCoords);
+            }
+        }
+    }
+}
+
+void MapRegionStreamer::RequestRegion(const IntVec2& regionCoords)
+{
+    MapRegion* region       = new MapRegion();
+    region->m_regionCoords  = regionCoords;
+    region->m_lastUsedFrame = m_frame;
+    m_regions[static_cast<size_t>(regionCoords.x) + static_cast<size_t>(regionCoords.y) * static_cast<size_t>(m_numRegions.x)] = region;
+    m_numLoadingRegions++;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workQueue.push_back(region);
+    }
+    m_workCondition.notify_one();
+}
+
+void MapRegionStreamer::ProcessBuiltRegions(int maxUploads)
+{
+    std::vector<MapRegion*> built;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t numUploads = std::min(m_builtQueue.size(), static_cast<size_t>(maxUploads));
+        built.assign(m_builtQueue.begin(), m_builtQueue.begin() + numUploads);
+        m_builtQueue.erase(m_builtQueue.begin(), m_builtQueue.begin() + numUploads);
+    }
+    for (MapRegion* region : built)
+    {
+        UploadRegion(region);
+    }
+}
+
+void MapRegionStreamer::UploadRegion(MapRegion* region)
+{
+    if (!region->m_indices.empty())
+    {
+        region->m_vertexBuffer = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PCUTBN), sizeof(Vertex_PCUTBN));
+        g_theRenderer->CopyCPUToGPU(region->m_vertexes.data(), static_cast<int>(region->m_vertexes.size()) * sizeof(Vertex_PCUTBN), region->m_vertexBuffer);
+        region->m_indexBuffer = g_theRenderer->CreateIndexBuffer(sizeof(unsigned int));
+        region->m_indexBuffer->Resize(static_cast<int>(region->m_indices.size()) * sizeof(unsigned int));
+        g_theRenderer->CopyCPUToGPU(region->m_indices.data(), static_cast<int>(region->m_indices.size()) * sizeof(unsigned int), region->m_indexBuffer);
+    }
+    region->m_numIndices    = static_cast<int>(region->m_indices.size());
+    region->m_residentBytes = region->m_tiles.capacity() * sizeof(Tile) + region->m_vertexes.size() * sizeof(Vertex_PCUTBN) + region->m_indices.size() * sizeof(unsigned int);
+    std::vector<Vertex_PCUTBN>().swap(region->m_vertexes); // The GPU copy is all the renderer needs.
+    std::vector<unsigned int>().swap(region->m_indices);
+    region->m_state = MapRegionState::RESIDENT;
+
+    m_residentRegions.push_back(region);
+    m_numLoadingRegions--;
+    m_numLoads++;
+    m_totalBuildSeconds += region->m_buildSeconds;
+    m_residentBytes += region->m_residentBytes;
+    m_peakResidentBytes = std::max(m_peakResidentBytes, m_residentBytes);
+}
+
+void MapRegionStreamer::EvictRegion(MapRegion* region)
+{
+    auto resident = std::find(m_residentRegions.begin(), m_residentRegions.end(), region);
+    if (resident == m_residentRegions.end())
+        return;
+    *resident = m_residentRegions.back();
+    m_residentRegions.pop_back();
+    m_residentBytes -= region->m_residentBytes;
+    m_numEvictions++;
+    m_regions[static_cast<size_t>(region->m_regionCoords.x) + static_cast<size_t>(region->m_regionCoords.y) * static_cast<size_t>(m_numRegions.x)] = nullptr;
+    POINTER_SAFE_DELETE(region->m_vertexBuffer)
+    POINTER_SAFE_DELETE(region->m_indexBuffer)
+    POINTER_SAFE_DELETE(region)
+}
+
+void MapRegionStreamer::EvictOverBudget()
+{
+    while (m_residentBytes > m_config.m_maxResidentBytes)
+    {
+        /// Least recently used region outside the load radius of every focus, the ones in use are never evicted
+        MapRegion* oldest = nullptr;
+        for (MapRegion* region : m_residentRegions)
+        {
+            if (region->m_lastUsedFrame != m_frame && (!oldest || region->m_lastUsedFrame < oldest->m_lastUsedFrame))
+                oldest = region;
+        }
+        if (!oldest)
+            return;
+        EvictRegion(oldest);
+    }
+}
+
+void MapRegionStreamer::BuildRegion(MapRegion* region) const
+{
+    double                     startTime  = GetCurrentTimeSeconds();
+    int                        regionSize = m_config.m_regionSize;
+    size_t                     numTiles   = static_cast<size_t>(regionSize) * static_cast<size_t>(regionSize);
+    std::vector<unsigned char> tileIndexes;
+    if (!m_source->ReadRegion(region->m_regionCoords, regionSize, tileIndexes) || tileIndexes.size() != numTiles)
+    {
+        printf("MapRegionStreamer::BuildRegion    Failed to read region (%d, %d), it stays empty\n", region->m_regionCoords.x, region->m_regionCoords.y);
+        tileIndexes.assign(numTiles, TILE_DEFINITION_NONE);
+    }
+
+    region->m_tiles.resize(numTiles);
+    for (int localY = 0; localY < regionSize; localY++)
+    {
+        for (int localX = 0; localX < regionSize; localX++)
+        {
+            int   localIndex = localX + localY * regionSize;
+            Tile& tile       = region->m_tiles[localIndex];
+            tile             = Tile(tileIndexes[localIndex]);
+            m_map->AddGeometryForTile(region->m_vertexes, region->m_indices, tile,
+                                      IntVec2(region->m_regionCoords.x * regionSize + localX, region->m_regionCoords.y * regionSize + localY));
+        }
+    }
+    region->m_buildSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+void MapRegionStreamer::WorkerThreadMain()
+{
+    while (true)
+    {
+        MapRegion* region = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCondition.wait(lock, [this]() { return m_bIsStopping || m_nextWork < m_workQueue.size(); });
+            if (m_bIsStopping)
+                return;
+            region = m_workQueue[m_nextWork++];
+            if (m_nextWork == m_workQueue.size())
+            {
+                m_workQueue.clear();
+                m_nextWork = 0;
+            }
+        }
+
+        BuildRegion(region);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_builtQueue.push_back(region);
+        }
+        m_builtCondition.notify_one();
+    }
+}
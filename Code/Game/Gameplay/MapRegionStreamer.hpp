@@ -0,0 +1,112 @@
+﻿#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Tile.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+class Map;
+class MapRegionSource;
+class VertexBuffer;
+class IndexBuffer;
+struct Vertex_PCUTBN;
+
+struct MapRegionStreamerConfig
+{
+    int    m_regionSize         = 32; // Tiles along one side of a region.
+    int    m_loadRadius         = 3; // Regions kept loaded around every focus, in regions.
+    size_t m_maxResidentBytes   = 64u * 1024u * 1024u; // Regions outside every load radius are evicted above this, least recently used first.
+    int    m_maxUploadsPerFrame = 4; // Finished regions uploaded per Update, the rest wait for the next frames.
+    int    m_numWorkers         = 2;
+};
+
+enum class MapRegionState : unsigned char
+{
+    LOADING, // Queued or being built by a worker, only the worker touches the tiles and geometry.
+    RESIDENT, // Uploaded, the tiles are visible to the map.
+};
+
+/// Tiles and geometry of one square block of the map.
+struct MapRegion
+{
+    IntVec2                    m_regionCoords;
+    MapRegionState             m_state         = MapRegionState::LOADING;
+    std::vector<Tile>          m_tiles; // Row major, regionSize x regionSize, tiles past the map edge have no definition.
+    std::vector<Vertex_PCUTBN> m_vertexes; // Built by the worker, freed once uploaded.
+    std::vector<unsigned int>  m_indices;
+    VertexBuffer*              m_vertexBuffer  = nullptr;
+    IndexBuffer*               m_indexBuffer   = nullptr;
+    int                        m_numIndices    = 0;
+    size_t                     m_residentBytes = 0; // Tiles plus the GPU buffers.
+    int                        m_lastUsedFrame = 0; // Last frame the region was inside the load radius of a focus.
+    double                     m_buildSeconds  = 0.0;
+};
+
+/// Streams the tiles and geometry of a large map in fixed size regions around a set of focus positions, usually the
+/// player actors. Workers read the tile indexes from the region source and build the tiles and geometry, the main
+/// thread only uploads the finished geometry since the renderer is not thread safe. Regions outside every load
+/// radius stay cached until the resident memory goes over the cap.
+class MapRegionStreamer
+{
+public:
+    MapRegionStreamer(const Map* map, const MapRegionSource* source, const IntVec2& dimensions, const MapRegionStreamerConfig& config);
+
+    void Startup();
+    void Shutdown(); // Join the workers and free every region.
+
+    /// Request the regions around every focus nearest first, upload the finished ones and evict above the memory cap.
+    void Update(const std::vector<Vec2>& focusPositions);
+    /// Block until every region within the load radius of the position is resident, used before spawning there.
+    void LoadRegionsAround(const Vec2& position);
+    void EvictAllRegions(); // Free every resident region, the ones still loading are kept.
+
+    Tile* GetTile(int x, int y); // Null if the region of the tile is not resident.
+    void  Render() const; // Draw every resident region with the shader and texture bound by the map.
+
+    int    GetNumResidentRegions() const;
+    size_t GetResidentBytes() const;
+    /// Walk a focus from start to end at a fixed speed with a 60 Hz frame pace and report the frames where the tile
+    /// under the focus was not resident yet, the cost of Update and the resident memory high water mark.
+    void RunWalkBenchmark(const Vec2& start, const Vec2& end, float tilesPerFrame);
+
+private:
+    MapRegion* GetRegion(const IntVec2& regionCoords) const;
+    IntVec2    GetRegionCoordsForPosition(const Vec2& position) const;
+    void       RequestRegionsAround(const IntVec2& centerRegion);
+    void       RequestRegion(const IntVec2& regionCoords);
+    void       ProcessBuiltRegions(int maxUploads); // Upload the regions the workers finished, oldest first.
+    void       UploadRegion(MapRegion* region);
+    void       EvictRegion(MapRegion* region);
+    void       EvictOverBudget();
+    void       BuildRegion(MapRegion* region) const; // Worker side, read the tile indexes and build tiles and geometry.
+    void       WorkerThreadMain();
+
+    const Map*              m_map    = nullptr;
+    const MapRegionSource*  m_source = nullptr;
+    MapRegionStreamerConfig m_config;
+    IntVec2                 m_dimensions;
+    IntVec2                 m_numRegions;
+    std::vector<MapRegion*> m_regions; // Slot per region of the map, null while unloaded. Main thread only.
+    std::vector<MapRegion*> m_residentRegions;
+    int                     m_frame             = 0;
+    int                     m_numLoadingRegions = 0;
+    size_t                  m_residentBytes     = 0;
+    size_t                  m_peakResidentBytes = 0;
+    int                     m_numLoads          = 0;
+    int                     m_numEvictions      = 0;
+    double                  m_totalBuildSeconds = 0.0;
+
+    /// Shared with the workers, guarded by m_mutex
+    std::mutex              m_mutex;
+    std::condition_variable m_workCondition;
+    std::condition_variable m_builtCondition;
+    std::vector<MapRegion*> m_workQueue;
+    std::vector<MapRegion*> m_builtQueue;
+    size_t                  m_nextWork    = 0;
+    bool                    m_bIsStopping = false;
+
+    std::vector<std::thread> m_workers;
+};
@@ -0,0 +1,49 @@
+﻿#include "MapSnapshot.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Game/Definition/MapDefinition.hpp"
+#include "Game/Framework/ByteBuffer.hpp"
+#include "Game/Gameplay/Map.hpp"
+
+bool MapSnapshot::SaveToFile(const Map& map, const std::string& filePath)
+{
+    double           startTime = GetCurrentTimeSeconds();
+    ByteBufferWriter writer;
+    writer.Write(MAP_SNAPSHOT_MAGIC);
+    writer.Write(MAP_SNAPSHOT_VERSION);
+    writer.WriteString(map.GetDefinition()->m_name);
+    map.WriteSnapshot(writer);
+    if (!WriteBufferToBinaryFile(writer.GetBuffer(), filePath))
+    {
+        printf("MapSnapshot::SaveToFile    Failed to write \"%s\"\n", filePath.c_str());
+        return false;
+    }
+    printf("MapSnapshot::SaveToFile    Saved %d bytes to \"%s\" in %.3f ms\n", static_cast<int>(writer.GetSize()), filePath.c_str(), (GetCurrentTimeSeconds() - startTime) * 1000.0);
+    return true;
+}
+
+bool MapSnapshot::ParseBuffer(const std::vector<unsigned char>& buffer, std::string& outMapName, MapSnapshotData& outData)
+{
+    ByteBufferReader reader(buffer);
+    unsigned int     magic   = reader.Read<unsigned int>();
+    unsigned int     version = reader.Read<unsigned int>();
+    if (magic != MAP_SNAPSHOT_MAGIC || version != MAP_SNAPSHOT_VERSION || !reader.ReadString(outMapName))
+    {
+        printf("MapSnapshot::ParseBuffer    Not a map snapshot of version %u\n", MAP_SNAPSHOT_VERSION);
+        return false;
+    }
+    if (!Map::ReadSnapshot(reader, outData))
+    {
+        printf("MapSnapshot::ParseBuffer    Snapshot of map \"%s\" is corrupted\n", outMapName.c_str());
+        return false;
+    }
+    return true;
+}
+
+void MapSnapshot::Apply(Map& map, const MapSnapshotData& data)
+{
+    double startTime = GetCurrentTimeSeconds();
+    map.ApplySnapshot(data);
+    printf("MapSnapshot::Apply    Restored %d actor slots in %.3f ms\n", static_cast<int>(data.m_slots.size()), (GetCurrentTimeSeconds() - startTime) * 1000.0);
+}
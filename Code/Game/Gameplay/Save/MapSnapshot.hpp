@@ -0,0 +1,64 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+#include "Game/Gameplay/Actor.hpp"
+#include "Game/Gameplay/ActorContactCache.hpp"
+
+class Map;
+class ByteBufferWriter;
+class ByteBufferReader;
+
+/// Binary snapshot of a running map: the map random state, every actor slot with its physics, health, weapons,
+/// simulation state and owner and AI target handles, the contact cache and what each local player possesses.
+/// Handles are stored as raw data and the map restores them unchanged, so every cross reference relinks by handle.
+/// Layout: magic, version, map definition name, then the map body written by Map::WriteSnapshot.
+static constexpr unsigned int MAP_SNAPSHOT_MAGIC   = 0x504E5344u; // "DSNP"
+static constexpr unsigned int MAP_SNAPSHOT_VERSION = 2;
+
+static constexpr unsigned short SNAPSHOT_EMPTY_SLOT = 0xffffu; // Definition index of a free actor slot in a snapshot.
+
+/// Parsed body of a map snapshot. It is filled completely before any map is touched, so a truncated or corrupt
+/// snapshot never costs the running game its map.
+struct MapSnapshotData
+{
+    struct ActorSlot
+    {
+        unsigned short m_definitionIndex = SNAPSHOT_EMPTY_SLOT;
+        unsigned int   m_handleData      = 0;
+        ActorSnapshot  m_state;
+    };
+
+    struct Player
+    {
+        int         m_playerIndex = -1;
+        ActorHandle m_actorHandle;
+        bool        m_bCameraMode = false;
+        Vec3        m_position;
+        EulerAngles m_orientation;
+    };
+
+    unsigned long long       m_randomSeed       = 0;
+    unsigned long long       m_randomCounter    = 0;
+    unsigned int             m_nextActorUID     = 0;
+    Vec3                     m_sunDirection;
+    float                    m_sunIntensity     = 0.f;
+    float                    m_ambientIntensity = 0.f;
+    float                    m_totalSeconds     = 0.f;
+    std::vector<std::string> m_definitionNames;
+    std::vector<ActorSlot>   m_slots;
+    ActorContactCache        m_contactCache;
+    std::vector<Player>      m_players;
+};
+
+class MapSnapshot
+{
+public:
+    /// Write the snapshot of the map to the file, return false if the file could not be written.
+    static bool SaveToFile(const Map& map, const std::string& filePath);
+    /// Parse and validate the whole snapshot without touching any map, so the caller only replaces the running map
+    /// once it knows the snapshot can be applied.
+    static bool ParseBuffer(const std::vector<unsigned char>& buffer, std::string& outMapName, MapSnapshotData& outData);
+    /// Apply a parsed snapshot to a map created from the definition it names, which replaces all of its actors.
+    static void Apply(Map& map, const MapSnapshotData& data);
+};
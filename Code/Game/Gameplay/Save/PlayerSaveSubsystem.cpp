@@ -1,43 +1,231 @@
 ﻿#include "PlayerSaveSubsystem.hpp"
-std::vector<PlayerSaveData> PlayerSaveSubsystem::s_playerSavedData = {};
 
-void PlayerSaveSubsystem::ClearSaves()
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+static constexpr unsigned int PLAYER_SAVE_LOG_MAGIC   = 0x56535044u; // "DPSV"
+static constexpr unsigned int PLAYER_SAVE_LOG_VERSION = 1;
+
+PlayerSaveSubsystem::PlayerSaveSubsystem(PlayerSaveSystemConfig config): m_config(config)
 {
-    printf("PlayerSaveSubsystem::ClearSaves       Clear All player Data\n");
-    s_playerSavedData.clear();
 }
 
-PlayerSaveData* PlayerSaveSubsystem::GetPlayerSaveData(int id)
+PlayerSaveSubsystem::~PlayerSaveSubsystem()
+{
+    Shutdown();
+}
+
+void PlayerSaveSubsystem::Startup()
+{
+    printf("PlayerSaveSubsystem::Startup       Load player saves from \"%s\"\n", m_config.m_logFilePath.c_str());
+    LoadLog();
+    RequestCompaction(); // Start every session from a compact log, this also creates the file
+    m_flushThread = std::thread(&PlayerSaveSubsystem::FlushThreadMain, this);
+}
+
+void PlayerSaveSubsystem::Shutdown()
 {
-    for (PlayerSaveData& data : s_playerSavedData)
+    if (!m_flushThread.joinable())
+        return;
+    RequestCompaction();
     {
-        if (data.m_playerID == id)
-        {
-            return &data;
-        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bIsStopping = true;
     }
-    return nullptr;
+    m_condition.notify_one();
+    m_flushThread.join();
+    printf("PlayerSaveSubsystem::Shutdown       Player saves written to \"%s\"\n", m_config.m_logFilePath.c_str());
+}
+
+void PlayerSaveSubsystem::ClearSaves()
+{
+    printf("PlayerSaveSubsystem::ClearSaves       Clear All player Data\n");
+    m_index.clear();
+    RequestCompaction();
+}
+
+const PlayerSaveData* PlayerSaveSubsystem::GetPlayerSaveData(int id) const
+{
+    auto it = m_index.find(id);
+    if (it == m_index.end())
+        return nullptr;
+    return &it->second;
 }
 
 bool PlayerSaveSubsystem::CreatePlayerSaveData(PlayerSaveData newSaveData)
 {
     if (!DoesPlayerSaveDataExist(newSaveData.m_playerID))
     {
-        s_playerSavedData.push_back(newSaveData);
+        m_index[newSaveData.m_playerID] = newSaveData;
+        AppendRecord(PlayerSaveRecordType::SET, newSaveData);
         printf("PlayerSaveSubsystem::CreatePlayerSaveData       Create player data for player id: %d\n", newSaveData.m_playerID);
         return true;
     }
     return false;
 }
 
-bool PlayerSaveSubsystem::DoesPlayerSaveDataExist(int id)
+bool PlayerSaveSubsystem::DoesPlayerSaveDataExist(int id) const
+{
+    return m_index.find(id) != m_index.end();
+}
+
+void PlayerSaveSubsystem::RecordDeath(int id)
+{
+    auto it = m_index.find(id);
+    if (it == m_index.end())
+        return;
+    it->second.m_numOfDeaths++;
+    AppendRecord(PlayerSaveRecordType::DEATH, it->second);
+}
+
+void PlayerSaveSubsystem::RecordKill(int id)
+{
+    auto it = m_index.find(id);
+    if (it == m_index.end())
+        return;
+    it->second.m_numOfKilled++;
+    AppendRecord(PlayerSaveRecordType::KILL, it->second);
+}
+
+void PlayerSaveSubsystem::Flush()
 {
-    for (PlayerSaveData& data : s_playerSavedData)
     {
-        if (data.m_playerID == id)
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bFlushRequested = true;
+    }
+    m_condition.notify_one();
+}
+
+void PlayerSaveSubsystem::AppendRecord(PlayerSaveRecordType type, const PlayerSaveData& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingRecords.Write(type);
+        m_pendingRecords.Write(data.m_playerID);
+        m_pendingRecords.Write(data.m_numOfDeaths);
+        m_pendingRecords.Write(data.m_numOfKilled);
+    }
+    if (++m_numRecordsSinceCompaction >= m_config.m_compactRecordThreshold)
+        RequestCompaction();
+}
+
+void PlayerSaveSubsystem::RequestCompaction()
+{
+    /// The index already contains every pending record, so the compacted log replaces them as well
+    ByteBufferWriter compacted;
+    compacted.Write(PLAYER_SAVE_LOG_MAGIC);
+    compacted.Write(PLAYER_SAVE_LOG_VERSION);
+    for (const auto& pair : m_index)
+    {
+        compacted.Write(PlayerSaveRecordType::SET);
+        compacted.Write(pair.second.m_playerID);
+        compacted.Write(pair.second.m_numOfDeaths);
+        compacted.Write(pair.second.m_numOfKilled);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingRecords.Clear();
+        m_pendingCompaction     = compacted;
+        m_bHasPendingCompaction = true;
+        m_bFlushRequested       = true;
+    }
+    m_condition.notify_one();
+    m_numRecordsSinceCompaction = 0;
+}
+
+void PlayerSaveSubsystem::LoadLog()
+{
+    m_index.clear();
+    std::vector<unsigned char> buffer;
+    std::error_code            error;
+    std::string                tempFilePath = m_config.m_logFilePath + ".tmp";
+    if (!std::filesystem::exists(m_config.m_logFilePath, error) && std::filesystem::exists(tempFilePath, error))
+    {
+        /// A compaction written in full whose swap never happened, it holds every record
+        printf("PlayerSaveSubsystem::LoadLog       Recover the compacted log \"%s\"\n", tempFilePath.c_str());
+        std::filesystem::rename(tempFilePath, m_config.m_logFilePath, error);
+    }
+    if (!ReadBinaryFileToBuffer(buffer, m_config.m_logFilePath))
+        return;
+    ByteBufferReader reader(buffer);
+    unsigned int     magic   = reader.Read<unsigned int>();
+    unsigned int     version = reader.Read<unsigned int>();
+    if (magic != PLAYER_SAVE_LOG_MAGIC || version != PLAYER_SAVE_LOG_VERSION)
+    {
+        printf("PlayerSaveSubsystem::LoadLog       \"%s\" is not a player save log, starting empty\n", m_config.m_logFilePath.c_str());
+        return;
+    }
+    int numRecords = 0;
+    while (!reader.IsAtEnd())
+    {
+        PlayerSaveRecordType type;
+        PlayerSaveData       data;
+        reader.Read(type);
+        reader.Read(data.m_playerID);
+        reader.Read(data.m_numOfDeaths);
+        reader.Read(data.m_numOfKilled);
+        if (!reader.IsValid())
         {
-            return true;
+            printf("PlayerSaveSubsystem::LoadLog       Ignore the truncated record at the end of the log\n");
+            break;
         }
+        /// Every record carries the full stats after the change, so the last record of a player wins
+        m_index[data.m_playerID] = data;
+        ++numRecords;
     }
-    return false;
+    printf("PlayerSaveSubsystem::LoadLog       Loaded %d players from %d records\n", static_cast<int>(m_index.size()), numRecords);
+}
+
+void PlayerSaveSubsystem::FlushThreadMain()
+{
+    auto interval = std::chrono::duration<float>(m_config.m_flushIntervalSeconds);
+    while (true)
+    {
+        ByteBufferWriter records;
+        ByteBufferWriter compaction;
+        bool             bHasCompaction = false;
+        bool             bIsStopping    = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, interval, [this]() { return m_bFlushRequested || m_bIsStopping; });
+            std::swap(records, m_pendingRecords);
+            std::swap(compaction, m_pendingCompaction);
+            bHasCompaction          = m_bHasPendingCompaction;
+            bIsStopping             = m_bIsStopping;
+            m_bHasPendingCompaction = false;
+            m_bFlushRequested       = false;
+        }
+
+        /// Compaction rewrites the whole file next to the old one and swaps it in with a single replacing rename, so a
+        /// crash leaves either the old or the new log and never none
+        if (bHasCompaction)
+        {
+            if (m_logFile.is_open())
+                m_logFile.close();
+            std::string tempFilePath = m_config.m_logFilePath + ".tmp";
+            if (WriteBufferToBinaryFile(compaction.GetBuffer(), tempFilePath))
+            {
+                std::error_code error;
+                std::filesystem::rename(tempFilePath, m_config.m_logFilePath, error);
+                if (error)
+                    printf("PlayerSaveSubsystem::FlushThreadMain       Failed to replace \"%s\": %s\n", m_config.m_logFilePath.c_str(), error.message().c_str());
+            }
+        }
+        if (records.GetSize() > 0 || bHasCompaction)
+        {
+            /// The startup compaction already wrote the header, records are only ever appended after it
+            if (!m_logFile.is_open())
+                m_logFile.open(m_config.m_logFilePath, std::ios::binary | std::ios::app);
+            if (m_logFile.is_open() && records.GetSize() > 0)
+            {
+                m_logFile.write(reinterpret_cast<const char*>(records.GetBuffer().data()), static_cast<std::streamsize>(records.GetSize()));
+                m_logFile.flush();
+            }
+        }
+        if (bIsStopping)
+            break;
+    }
+    if (m_logFile.is_open())
+        m_logFile.close();
 }
@@ -1,5 +1,12 @@
 ﻿#pragma once
-#include <vector>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "Game/Framework/ByteBuffer.hpp"
 
 struct PlayerSaveData
 {
@@ -8,13 +15,62 @@ struct PlayerSaveData
     int m_numOfKilled = 0;
 };
 
-class PlayerSaveSubsystem
+struct PlayerSaveSystemConfig
 {
-    static std::vector<PlayerSaveData> s_playerSavedData;
+    std::string m_logFilePath            = "PlayerSaves.log";
+    float       m_flushIntervalSeconds   = 1.f; // Longest time an appended record waits in memory before it hits the disk.
+    int         m_compactRecordThreshold = 1024; // Number of appended records after which the log is rewritten.
+};
 
+/// Kind of a record in the save log, every record has the same fixed size.
+enum class PlayerSaveRecordType : unsigned char
+{
+    SET, // Absolute stats of a player, written on creation and by compaction.
+    DEATH, // One more death of the player.
+    KILL, // One more kill of the player.
+};
+
+/// Persistent player stats. The stats live in an in-memory index keyed by player id and every change is appended as a
+/// small record to a log file. A background thread writes the appended records to the disk, so gameplay never waits
+/// on a file. On startup the log is replayed into the index; once it grows past the threshold it is compacted into one
+/// SET record per player.
+class PlayerSaveSubsystem
+{
 public:
-    static void            ClearSaves();
-    static PlayerSaveData* GetPlayerSaveData(int id);
-    static bool            CreatePlayerSaveData(PlayerSaveData newSaveData);
-    static bool            DoesPlayerSaveDataExist(int id);
+    PlayerSaveSubsystem() = delete;
+    PlayerSaveSubsystem(PlayerSaveSystemConfig config);
+    ~PlayerSaveSubsystem();
+
+    void Startup(); // Load the log into the index and start the flush thread.
+    void Shutdown(); // Stop the flush thread, write everything and compact the log.
+
+    void                  ClearSaves(); // Forget every player and truncate the log.
+    const PlayerSaveData* GetPlayerSaveData(int id) const;
+    bool                  CreatePlayerSaveData(PlayerSaveData newSaveData);
+    bool                  DoesPlayerSaveDataExist(int id) const;
+    void                  RecordDeath(int id);
+    void                  RecordKill(int id);
+    void                  Flush(); // Wake the flush thread instead of waiting for the interval.
+
+private:
+    void AppendRecord(PlayerSaveRecordType type, const PlayerSaveData& data);
+    void RequestCompaction();
+    void LoadLog();
+    void FlushThreadMain();
+
+    PlayerSaveSystemConfig                  m_config;
+    std::unordered_map<int, PlayerSaveData> m_index; // Main thread only.
+    int                                     m_numRecordsSinceCompaction = 0;
+
+    /// Shared with the flush thread, guarded by m_mutex
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    ByteBufferWriter        m_pendingRecords;
+    ByteBufferWriter        m_pendingCompaction; // Full log content that replaces the file, empty if none requested.
+    bool                    m_bHasPendingCompaction = false;
+    bool                    m_bFlushRequested       = false;
+    bool                    m_bIsStopping           = false;
+
+    std::thread   m_flushThread;
+    std::ofstream m_logFile; // Flush thread only once started.
 };
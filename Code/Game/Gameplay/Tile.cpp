@@ -2,22 +2,25 @@
 
 #include "Game/Definition/TileDefinition.hpp"
 
-Tile::~Tile()
+Tile::Tile(unsigned char definitionIndex): m_definitionIndex(definitionIndex)
 {
 }
 
-Tile::Tile(IntVec2 tileCoords, TileDefinition* tileDefinition): m_definition(tileDefinition), m_tileCoords(tileCoords)
+void Tile::SetTileDefinition(const TileDefinition* tileDefinition)
 {
+    m_definitionIndex = GetDefinitionIndex(tileDefinition);
 }
 
-void Tile::SetTileDefinition(TileDefinition* tileDefinition)
+TileDefinition* Tile::GetTileDefinition() const
 {
-    m_definition = tileDefinition;
+    if (m_definitionIndex >= TileDefinition::s_definitions.size())
+        return nullptr;
+    return &TileDefinition::s_definitions[m_definitionIndex];
 }
 
-TileDefinition* Tile::GetTileDefinition() const
+unsigned char Tile::GetTileDefinitionIndex() const
 {
-    return m_definition;
+    return m_definitionIndex;
 }
 
 int Tile::GetTileHealth() const
@@ -27,27 +30,13 @@ int Tile::GetTileHealth() const
 
 bool Tile::IsTileSolid() const
 {
-    return m_definition->m_isSolid;
-}
-
-AABB3& Tile::GetBounds()
-{
-    return m_bounds;
-}
-
-Tile& Tile::SetBounds(AABB3 newBounds)
-{
-    m_bounds = newBounds;
-    return *this;
-}
-
-Tile& Tile::SetTileCoords(IntVec2 newCoords)
-{
-    m_tileCoords = newCoords;
-    return *this;
+    TileDefinition* definition = GetTileDefinition();
+    return definition && definition->m_isSolid;
 }
 
-IntVec2 Tile::GetTileCoords() const
+unsigned char Tile::GetDefinitionIndex(const TileDefinition* tileDefinition)
 {
-    return m_tileCoords;
+    if (!tileDefinition)
+        return TILE_DEFINITION_NONE;
+    return static_cast<unsigned char>(tileDefinition - TileDefinition::s_definitions.data());
 }
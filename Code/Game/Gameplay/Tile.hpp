@@ -1,27 +1,28 @@
 ﻿#pragma once
-#include "Engine/Math/AABB3.hpp"
-#include "Engine/Math/IntVec2.hpp"
 
 class TileDefinition;
 
+static constexpr unsigned char TILE_DEFINITION_NONE = 0xffu; // Definition index of a tile without a definition.
+
+/// Two bytes per tile, the map stores them row major. Coordinates and bounds are implied by the position of the tile
+/// in the map (Map::GetTileCoords, Map::GetTileBounds) and the definition is an index in TileDefinition::s_definitions,
+/// so a whole row of tiles shares a cache line with its neighbours during raycasts and collision.
 struct Tile
 {
-    ~Tile();
-    Tile(IntVec2 tileCoords, TileDefinition* tileDefinition);
     Tile() = default;
+    explicit Tile(unsigned char definitionIndex);
 
-    void            SetTileDefinition(TileDefinition* tileDefinition);
-    TileDefinition* GetTileDefinition() const;
+    void            SetTileDefinition(const TileDefinition* tileDefinition);
+    TileDefinition* GetTileDefinition() const; // Null if the tile has no definition.
+    unsigned char   GetTileDefinitionIndex() const;
     int             GetTileHealth() const;
     bool            IsTileSolid() const;
-    AABB3&          GetBounds();
-    Tile&           SetBounds(AABB3 newBounds);
-    Tile&           SetTileCoords(IntVec2 newCoords);
-    IntVec2         GetTileCoords() const;
+
+    static unsigned char GetDefinitionIndex(const TileDefinition* tileDefinition); // TILE_DEFINITION_NONE for null.
 
 private:
-    AABB3           m_bounds;
-    TileDefinition* m_definition = nullptr;
-    IntVec2         m_tileCoords = IntVec2::INVALID;
-    int             m_health     = 1;
+    unsigned char m_definitionIndex = TILE_DEFINITION_NONE;
+    unsigned char m_health          = 1;
 };
+
+static_assert(sizeof(Tile) == 2, "Tile is expected to stay two bytes");
@@ -0,0 +1,170 @@
+﻿#include "TimerWheel.hpp"
+
+#include <cmath>
+
+TimerWheel::TimerWheel(float tickSeconds): m_tickSeconds(tickSeconds)
+{
+    m_slots.resize(static_cast<size_t>(WHEEL_LEVELS * WHEEL_SLOTS));
+}
+
+TimerHandle TimerWheel::Schedule(float delaySeconds, const TimerEvent& event)
+{
+    constexpr unsigned long long MAX_DELAY_TICKS = (1ull << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) - 1;
+
+    unsigned long long delayTicks = 1;
+    if (delaySeconds > m_tickSeconds)
+        delayTicks = static_cast<unsigned long long>(std::ceil(static_cast<double>(delaySeconds) / static_cast<double>(m_tickSeconds)));
+    if (delayTicks > MAX_DELAY_TICKS)
+        delayTicks = MAX_DELAY_TICKS;
+
+    unsigned int nodeIndex = m_freeHead;
+    if (nodeIndex != NODE_NONE)
+    {
+        m_freeHead = m_nodes[nodeIndex].m_next;
+    }
+    else
+    {
+        nodeIndex = static_cast<unsigned int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    TimerNode& node   = m_nodes[nodeIndex];
+    node.m_event      = event;
+    node.m_expiryTick = m_currentTick + delayTicks;
+    InsertNode(nodeIndex);
+    m_numScheduled++;
+    return TimerHandle{nodeIndex, node.m_generation};
+}
+
+void TimerWheel::Cancel(TimerHandle& handle)
+{
+    if (IsScheduled(handle))
+    {
+        UnlinkNode(handle.m_index);
+        FreeNode(handle.m_index);
+    }
+    handle = TimerHandle();
+}
+
+bool TimerWheel::IsScheduled(const TimerHandle& handle) const
+{
+    if (handle.m_index >= m_nodes.size())
+        return false;
+    const TimerNode& node = m_nodes[handle.m_index];
+    return node.m_slot >= 0 && node.m_generation == handle.m_generation;
+}
+
+float TimerWheel::GetRemainingSeconds(const TimerHandle& handle) const
+{
+    if (!IsScheduled(handle))
+        return 0.f;
+    unsigned long long remainingTicks = m_nodes[handle.m_index].m_expiryTick - m_currentTick;
+    return static_cast<float>(remainingTicks) * m_tickSeconds - m_accumulatedSeconds;
+}
+
+void TimerWheel::Advance(float deltaSeconds, std::vector<TimerEvent>& outExpiredEvents)
+{
+    m_accumulatedSeconds += deltaSeconds;
+    while (m_accumulatedSeconds >= m_tickSeconds)
+    {
+        m_accumulatedSeconds -= m_tickSeconds;
+        m_currentTick++;
+
+        /// Whenever a level wraps around, the next slot of the level above moves down before the tick expires
+        for (int level = 1; level < WHEEL_LEVELS; level++)
+        {
+            if ((m_currentTick & ((1ull << (level * WHEEL_SLOT_BITS)) - 1)) != 0)
+                break;
+            CascadeSlot(level * WHEEL_SLOTS + static_cast<int>((m_currentTick >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1)));
+        }
+
+        TimerSlot& slot = m_slots[static_cast<size_t>(m_currentTick & (WHEEL_SLOTS - 1))];
+        while (slot.m_head != NODE_NONE)
+        {
+            unsigned int nodeIndex = slot.m_head;
+            outExpiredEvents.push_back(m_nodes[nodeIndex].m_event);
+            UnlinkNode(nodeIndex);
+            FreeNode(nodeIndex);
+        }
+    }
+}
+
+void TimerWheel::Clear()
+{
+    for (unsigned int nodeIndex = 0; nodeIndex < static_cast<unsigned int>(m_nodes.size()); nodeIndex++)
+    {
+        if (m_nodes[nodeIndex].m_slot >= 0)
+            FreeNode(nodeIndex);
+    }
+    for (TimerSlot& slot : m_slots)
+    {
+        slot = TimerSlot();
+    }
+}
+
+int TimerWheel::GetNumScheduled() const
+{
+    return m_numScheduled;
+}
+
+float TimerWheel::GetTickSeconds() const
+{
+    return m_tickSeconds;
+}
+
+void TimerWheel::InsertNode(unsigned int nodeIndex)
+{
+    TimerNode&         node       = m_nodes[nodeIndex];
+    unsigned long long delayTicks = node.m_expiryTick - m_currentTick;
+    int                level      = 0;
+    while (level < WHEEL_LEVELS - 1 && delayTicks >= (1ull << ((level + 1) * WHEEL_SLOT_BITS)))
+    {
+        level++;
+    }
+    int        slotIndex = level * WHEEL_SLOTS + static_cast<int>((node.m_expiryTick >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1));
+    TimerSlot& slot      = m_slots[slotIndex];
+    node.m_slot          = slotIndex;
+    node.m_previous      = slot.m_tail;
+    node.m_next          = NODE_NONE;
+    if (slot.m_tail != NODE_NONE)
+        m_nodes[slot.m_tail].m_next = nodeIndex;
+    else
+        slot.m_head = nodeIndex;
+    slot.m_tail = nodeIndex;
+}
+
+void TimerWheel::UnlinkNode(unsigned int nodeIndex)
+{
+    TimerNode& node = m_nodes[nodeIndex];
+    TimerSlot& slot = m_slots[node.m_slot];
+    if (node.m_previous != NODE_NONE)
+        m_nodes[node.m_previous].m_next = node.m_next;
+    else
+        slot.m_head = node.m_next;
+    if (node.m_next != NODE_NONE)
+        m_nodes[node.m_next].m_previous = node.m_previous;
+    else
+        slot.m_tail = node.m_previous;
+}
+
+void TimerWheel::FreeNode(unsigned int nodeIndex)
+{
+    TimerNode& node = m_nodes[nodeIndex];
+    node.m_slot     = -1;
+    node.m_generation++; // Every handle of the timer stops matching.
+    node.m_previous = NODE_NONE;
+    node.m_next     = m_freeHead;
+    m_freeHead      = nodeIndex;
+    m_numScheduled--;
+}
+
+void TimerWheel::CascadeSlot(int slot)
+{
+    unsigned int nodeIndex = m_slots[slot].m_head;
+    m_slots[slot]          = TimerSlot();
+    while (nodeIndex != NODE_NONE)
+    {
+        unsigned int nextIndex = m_nodes[nodeIndex].m_next;
+        InsertNode(nodeIndex);
+        nodeIndex = nextIndex;
+    }
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <vector>
+
+#include "Game/Framework/ActorHandle.hpp"
+
+/// What a timer does when it expires, the map dispatches on the type.
+enum class TimerEventType : unsigned char
+{
+    ACTOR_ANIMATION_END,
+    WEAPON_ANIMATION_END, // m_index is the weapon slot of the actor.
+    WEAPON_REFIRE, // m_index is the weapon slot of the actor.
+    CORPSE_EXPIRE,
+    PLAYER_RESPAWN, // m_index is the player controller index, m_actor is unused.
+};
+
+struct TimerEvent
+{
+    ActorHandle    m_actor;
+    TimerEventType m_type  = TimerEventType::ACTOR_ANIMATION_END;
+    unsigned char  m_index = 0;
+};
+
+struct TimerHandle
+{
+    unsigned int m_index      = 0xffffffffu;
+    unsigned int m_generation = 0;
+};
+
+/// Hierarchical timer wheel in fixed ticks. The first level holds the timers of the next 64 ticks in one slot per
+/// tick, every further level covers 64 times the range of the one below and cascades a slot down whenever the level
+/// below wraps around. Scheduling, cancelling and expiring a timer are O(1), advancing costs one slot per tick no
+/// matter how many timers are pending. Timers only carry the actor handle so a timer of a deleted actor simply
+/// resolves to no actor when it expires.
+class TimerWheel
+{
+public:
+    explicit TimerWheel(float tickSeconds);
+
+    /// Expire after the delay, rounded up to whole ticks and at least one tick away.
+    TimerHandle Schedule(float delaySeconds, const TimerEvent& event);
+    void        Cancel(TimerHandle& handle); // No-op for an expired or cancelled timer, the handle is reset.
+    bool        IsScheduled(const TimerHandle& handle) const;
+    float       GetRemainingSeconds(const TimerHandle& handle) const; // 0 if the timer is not scheduled.
+    /// Step the wheel tick by tick and append the expired events in expiry order, same tick in scheduling order.
+    void        Advance(float deltaSeconds, std::vector<TimerEvent>& outExpiredEvents);
+    void        Clear(); // Drop every timer, their handles are no longer scheduled.
+
+    int   GetNumScheduled() const;
+    float GetTickSeconds() const;
+
+private:
+    static constexpr int          WHEEL_LEVELS    = 4;
+    static constexpr int          WHEEL_SLOT_BITS = 6;
+    static constexpr int          WHEEL_SLOTS     = 1 << WHEEL_SLOT_BITS;
+    static constexpr unsigned int NODE_NONE       = 0xffffffffu;
+
+    struct TimerNode
+    {
+        TimerEvent         m_event;
+        unsigned long long m_expiryTick = 0;
+        unsigned int       m_generation = 0;
+        unsigned int       m_previous   = NODE_NONE; // Neighbours in the slot list, or the next free node.
+        unsigned int       m_next       = NODE_NONE;
+        int                m_slot       = -1; // Index into m_slots, -1 while free.
+    };
+
+    struct TimerSlot
+    {
+        unsigned int m_head = NODE_NONE;
+        unsigned int m_tail = NODE_NONE;
+    };
+
+    void InsertNode(unsigned int nodeIndex);
+    void UnlinkNode(unsigned int nodeIndex);
+    void FreeNode(unsigned int nodeIndex);
+    void CascadeSlot(int slot); // Re-insert every timer of a higher level slot, they land in the levels below.
+
+    float                  m_tickSeconds        = 0.f;
+    float                  m_accumulatedSeconds = 0.f;
+    unsigned long long     m_currentTick        = 0;
+    std::vector<TimerNode> m_nodes;
+    std::vector<TimerSlot> m_slots; // WHEEL_LEVELS x WHEEL_SLOTS, level major.
+    unsigned int           m_freeHead     = NODE_NONE;
+    int                    m_numScheduled = 0;
+};
@@ -1,11 +1,11 @@
 ﻿#include "Weapon.hpp"
 
+#include <algorithm>
+
 #include "Actor.hpp"
 #include "Engine/Core/Clock.hpp"
-#include "Engine/Core/Timer.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Renderer/Camera.hpp"
 #include "Engine/Renderer/DebugRenderSystem.h"
 #include "Engine/Renderer/Renderer.hpp"
@@ -17,53 +17,47 @@
 #include "Game/Definition/WeaponDefinition.hpp"
 #include "Game/Framework/Controller.hpp"
 #include "Game/Framework/PlayerController.hpp"
+#include "Game/Framework/PlayerHudCache.hpp"
+#include "Game/Framework/ResourceSubsystem.hpp"
 #include "Save/PlayerSaveSubsystem.hpp"
 
 Weapon::Weapon(WeaponDefinition* definition, Actor* owner): m_owner(owner), m_definition(definition)
 {
-    m_animationTimer = new Timer(0, g_theGame->m_clock);
-
-    /// Init hud base bound
-    if (m_definition->m_hud != nullptr)
-    {
-        Texture* baseTexture   = m_definition->m_hud->m_baseTexture;
-        IntVec2  baseDimension = baseTexture->GetDimensions();
-        float    multiplier    = g_theGame->m_screenSpace.m_maxs.x / static_cast<float>(baseDimension.x);
-        m_hudBaseBound         = AABB2(Vec2(0.0f, 0.0f), Vec2(g_theGame->m_screenSpace.m_maxs.x, static_cast<float>(baseDimension.y) * multiplier));
-    }
+    UpdateHudBaseBound();
 }
 
 Weapon::~Weapon()
 {
+    if (m_owner && m_owner->m_map)
+    {
+        m_owner->m_map->m_timerWheel.Cancel(m_animationEndTimer);
+        m_owner->m_map->m_timerWheel.Cancel(m_refireTimer);
+    }
     m_owner = nullptr;
 }
 
-void Weapon::Fire()
+bool Weapon::Fire()
 {
     int rayCount        = m_definition->m_rayCount;
     int projectileCount = m_definition->m_projectileCount;
     int meleeCount      = m_definition->m_meleeCount;
 
-    float m_currentFireTime   = g_theGame->m_clock->GetTotalSeconds();
-    float m_timeSinceLastFire = m_currentFireTime - m_lastFireTime;
-    if (m_timeSinceLastFire > m_definition->m_refireTime)
+    if (IsReadyToFire())
     {
         printf("Weapon::Fire    Weapon fired by %s\n", m_owner->m_definition->m_name.c_str());
-        m_owner->m_controller->m_state = "Attack";
-        SoundID weaponFireSound        = m_definition->GetSoundByName("Fire")->GetSoundID();
-        g_theAudio->StartSoundAt(weaponFireSound, m_owner->m_position);
+        auto player = dynamic_cast<PlayerController*>(m_owner->m_controller);
+        g_theResourceSubsystem->PlaySoundAt(m_definition->GetSoundCue(SoundCue::FIRE), m_owner->m_position, player ? SoundPriority::HIGH : SoundPriority::NORMAL);
         if (m_definition->m_hud)
         {
-            PlayAnimationByName("Attack");
+            PlayAnimation(AnimationState::ATTACK);
         }
         /// Handle player fire animation logic
-        auto player = dynamic_cast<PlayerController*>(m_owner->m_controller);
         if (player)
         {
-            player->GetActor()->PlayAnimationByName("Attack");
+            player->GetActor()->PlayAnimation(AnimationState::ATTACK);
         }
         /// End of Handle player fire animation logic.
-        m_lastFireTime = m_currentFireTime;
+        m_refireTimer = m_owner->m_map->m_timerWheel.Schedule(m_definition->m_refireTime, {m_owner->m_handle, TimerEventType::WEAPON_REFIRE, GetSlotIndex()});
         /// Fire logic here
         while (rayCount > 0)
         {
@@ -95,7 +89,7 @@ void Weapon::Fire()
             }
             if (hitActor && hitActor->m_handle.IsValid())
             {
-                float damage = g_rng->RollRandomFloatInRange(m_definition->m_rayDamage.m_min, m_definition->m_rayDamage.m_max);
+                float damage = m_randomStream.RollRandomFloatInRange(m_definition->m_rayDamage.m_min, m_definition->m_rayDamage.m_max);
                 hitActor->Damage(damage, m_owner->m_handle);
                 hitActor->AddImpulse(m_definition->m_rayImpulse * forward);
                 SpawnInfo particleSpawnInfo;
@@ -158,190 +152,194 @@ void Weapon::Fire()
             }
             if (bestTarget)
             {
-                float damage = g_rng->RollRandomFloatInRange(m_definition->m_meleeDamage.m_min, m_definition->m_meleeDamage.m_max);
+                float damage = m_randomStream.RollRandomFloatInRange(m_definition->m_meleeDamage.m_min, m_definition->m_meleeDamage.m_max);
                 bestTarget->Damage(damage, m_owner->m_handle);
                 bestTarget->AddImpulse(m_definition->m_meleeImpulse * fwd);
                 printf("Weapon::Fire    Melee: Damaged actor %s\n", bestTarget->m_definition->m_name.c_str());
             }
         }
+        return true;
     }
+    return false;
 }
 
 /// TODO: use native Vec3 internal direction methods to get random direction in a cone
 Vec3 Weapon::GetRandomDirectionInCone(Vec3 weaponOrientation, float degreeOfVariation)
 {
-    float variation   = g_rng->RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
+    float variation   = m_randomStream.RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
     auto  orientation = EulerAngles(weaponOrientation.x + variation, weaponOrientation.y + variation, weaponOrientation.z + variation);
     return Vec3(orientation);
 }
 
 EulerAngles Weapon::GetRandomDirectionInCone(EulerAngles weaponOrientation, float degreeOfVariation)
 {
-    float variationYaw   = g_rng->RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
-    float variationPitch = g_rng->RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
-    float variationRow   = g_rng->RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
+    float variationYaw   = m_randomStream.RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
+    float variationPitch = m_randomStream.RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
+    float variationRow   = m_randomStream.RollRandomFloatInRange(-degreeOfVariation, degreeOfVariation);
     auto  newDirection   = EulerAngles(weaponOrientation.m_yawDegrees + variationYaw, weaponOrientation.m_pitchDegrees + variationPitch, weaponOrientation.m_rollDegrees + variationRow);
     return newDirection;
 }
 
-void Weapon::Update(float deltaSeconds)
+void Weapon::OnAnimationEnd()
 {
-    UpdateAnimation(deltaSeconds);
+    m_currentPlayingAnimation = nullptr;
+    m_animationState          = AnimationState::IDLE;
 }
 
-void Weapon::UpdateAnimation(float deltaSeconds)
+bool Weapon::IsReadyToFire() const
 {
-    UNUSED(deltaSeconds)
-    if (!m_currentPlayingAnimation)
-        return;
-    if (m_animationTimer->GetElapsedTime() > m_currentPlayingAnimation->GetAnimationLength())
-    {
-        m_currentPlayingAnimation = nullptr;
-        m_animationTimer->Stop();
-    }
+    return !m_owner->m_map->m_timerWheel.IsScheduled(m_refireTimer);
 }
 
-Animation* Weapon::PlayAnimationByName(std::string animationName, bool force)
+Animation* Weapon::PlayAnimation(AnimationState state, bool force)
 {
-    Animation* weaponAnim = m_definition->m_hud->GetAnimationByName(animationName);
-    if (weaponAnim)
+    Hud*                         hud          = m_definition->m_hud;
+    const AnimationStateMachine& stateMachine = hud->m_animationStates;
+    if (!stateMachine.CanTransition(m_animationState, m_currentPlayingAnimation != nullptr, state, force))
+        return state == m_animationState ? m_currentPlayingAnimation : nullptr;
+    m_currentPlayingAnimation = hud->GetAnimation(stateMachine.GetAnimationId(state));
+    m_animationState          = state;
+    m_animationStartTime      = g_theGame->m_simulationTotalSeconds;
+    m_owner->m_map->m_timerWheel.Cancel(m_animationEndTimer);
+    if (m_currentPlayingAnimation)
+        m_animationEndTimer = m_owner->m_map->m_timerWheel.Schedule(m_currentPlayingAnimation->GetAnimationLength(),
+                                                                    {m_owner->m_handle, TimerEventType::WEAPON_ANIMATION_END, GetSlotIndex()});
+    return m_currentPlayingAnimation;
+}
+
+void Weapon::RebindDefinition(WeaponDefinition* definition, const std::string& animationName)
+{
+    m_definition              = definition;
+    m_currentPlayingAnimation = nullptr;
+    m_animationState          = AnimationState::IDLE;
+    if (m_definition->m_hud && !animationName.empty())
     {
-        if (weaponAnim == m_currentPlayingAnimation)
-        {
-            return weaponAnim;
-        }
-        /// We want to replace to new animation, force update it whether or not it finished
-        if (force)
-        {
-            m_currentPlayingAnimation = weaponAnim;
-            m_animationTimer->Start();
-            return weaponAnim;
-        }
-        if (m_currentPlayingAnimation)
-        {
-            bool isCurrentAnimFinished = m_animationTimer->GetElapsedTime() >= m_currentPlayingAnimation->GetAnimationLength();
-            if (isCurrentAnimFinished)
-            {
-                m_currentPlayingAnimation = weaponAnim;
-                m_animationTimer->Start();
-                return weaponAnim;
-            }
-        }
-        else
-        {
-            m_currentPlayingAnimation = weaponAnim;
-            m_animationTimer->Start();
-            return weaponAnim;
-        }
+        AnimationState animationState = GetAnimationStateByName(animationName);
+        m_currentPlayingAnimation     = m_definition->m_hud->GetAnimationByName(animationName);
+        if (m_currentPlayingAnimation && animationState != AnimationState::COUNT)
+            m_animationState = animationState;
     }
-    return nullptr;
+    UpdateHudBaseBound();
 }
 
-void Weapon::Render() const
+void Weapon::Render(PlayerHudCache& hudCache) const
 {
-    g_theRenderer->BindShader(m_definition->m_hud->m_shader);
+    Hud* hud = m_definition->m_hud;
+    if (hudCache.NeedsLayout(hud, m_hudBaseBound, m_owner->m_controller->m_screenViewport))
+        BuildHudLayout(hudCache);
+    g_theRenderer->BindShader(hud->m_shader);
     g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
-    RenderWeaponBase();
-    RenderWeaponReticle();
-    RenderWeaponAnim();
-    RenderWeaponHudText();
+    hudCache.Draw(HudLayer::BASE, hud->m_baseTexture);
+    hudCache.Draw(HudLayer::RETICLE, hud->m_reticleTexture);
+    RenderWeaponAnim(hudCache);
+    RenderWeaponHudText(hudCache);
 }
 
-void Weapon::RenderWeaponBase() const
+void Weapon::BuildHudLayout(PlayerHudCache& hudCache) const
 {
-    std::vector<Vertex_PCU> vertexes;
-    vertexes.reserve(8192);
+    Hud*  hud            = m_definition->m_hud;
+    AABB2 screenViewport = m_owner->m_controller->m_screenViewport;
+    hudCache.SetLayout(hud, m_hudBaseBound, screenViewport);
+    hudCache.m_font          = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
+    hudCache.m_viewportScale = g_theGame->m_screenSpace.GetDimensions().y / screenViewport.GetDimensions().y;
 
-    //Vec2 spriteOffSet = -Vec2(m_definition->m_hud->m_spriteSize) * m_definition->m_hud->m_spritePivot;
-    /// Hud Base TODO: Handle multiplayer
-    Texture* baseTexture = m_definition->m_hud->m_baseTexture;
+    std::vector<Vertex_PCU>& vertexes = hudCache.m_scratchVertexes;
+    /// Hud Base
+    vertexes.clear();
     AddVertsForAABB2D(vertexes, m_hudBaseBound, Rgba8::WHITE);
-    g_theRenderer->BindTexture(baseTexture);
-    g_theRenderer->DrawVertexArray(vertexes);
-}
-
-void Weapon::RenderWeaponReticle() const
-{
-    std::vector<Vertex_PCU> vertexes;
-    vertexes.reserve(1024);
-    /// Reticle
-    Texture* reticleTexture   = m_definition->m_hud->m_reticleTexture;
-    Vec2     reticleDimension = reticleTexture->GetDimensions();
-
-    Vec2 reticleSpriteOffSet = -reticleDimension * m_definition->m_hud->m_spritePivot;
-    auto reticleBound        = AABB2(Vec2(g_theGame->m_screenSpace.m_maxs / 2.0f), (Vec2(g_theGame->m_screenSpace.m_maxs / 2.0f) + Vec2(reticleDimension)));
+    hudCache.Upload(HudLayer::BASE, vertexes);
 
-    /// Change the dimension base on split screen y
-    Vec2  dim            = reticleBound.GetDimensions();
-    AABB2 screenViewport = m_owner->m_controller->m_screenViewport;
-    float multiplier     = g_theGame->m_screenSpace.GetDimensions().y / screenViewport.GetDimensions().y;
-    dim.x /= multiplier;
+    /// Reticle, the dimension changes base on split screen y
+    auto reticleBound = AABB2(Vec2(g_theGame->m_screenSpace.m_maxs / 2.0f), (Vec2(g_theGame->m_screenSpace.m_maxs / 2.0f) + hud->m_reticleDimensions));
+    Vec2 dim          = reticleBound.GetDimensions();
+    dim.x /= hudCache.m_viewportScale;
     reticleBound.SetDimensions(dim);
-    /// End of Change
-
+    vertexes.clear();
     AddVertsForAABB2D(vertexes, reticleBound, Rgba8::WHITE);
-    g_theRenderer->BindTexture(reticleTexture);
-    g_theRenderer->DrawVertexArray(vertexes);
+    hudCache.Upload(HudLayer::RETICLE, vertexes);
+
+    /// Animation bound, only the frame UVs change afterward
+    IntVec2 boundSize = hud->m_spriteSize;
+    auto    bound     = AABB2(Vec2(g_theGame->m_screenSpace.m_maxs.x / 2.0f, 0.f), Vec2(g_theGame->m_screenSpace.m_maxs.x / 2.0f, 0.f) + Vec2(boundSize));
+    dim               = bound.GetDimensions();
+    dim.x /= hudCache.m_viewportScale;
+    bound.SetDimensions(dim);
+    bound.m_mins += hud->m_spriteOffset;
+    bound.m_maxs += hud->m_spriteOffset;
+    bound.Translate(Vec2(0, m_hudBaseBound.m_maxs.y)); // Shitty hardcode
+    hudCache.m_animationBound = bound;
 }
 
-void Weapon::RenderWeaponHudText() const
+void Weapon::RenderWeaponHudText(PlayerHudCache& hudCache) const
 {
     g_theRenderer->BindTexture(nullptr);
     auto player = dynamic_cast<PlayerController*>(m_owner->m_controller);
     if (!player) return;
     if (!player->GetActor() || player->GetActor()->m_bIsDead)
         return; // Handle player death not render hud text
-    std::vector<Vertex_PCU> vertexes;
-    vertexes.reserve(1024);
-    BitmapFont* g_testFont     = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
-    AABB2       boundingBox    = m_hudBaseBound;
-    Vec2        dim            = boundingBox.GetDimensions();
-    AABB2       screenViewport = m_owner->m_controller->m_screenViewport;
-    float       multiplier     = g_theGame->m_screenSpace.GetDimensions().y / screenViewport.GetDimensions().y;
-    g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", static_cast<int>(m_owner->m_health)), boundingBox, 40.f, Rgba8::WHITE, 1 / multiplier, Vec2(0.29f, 0.5f));
-    g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", PlayerSaveSubsystem::GetPlayerSaveData(player->m_index)->m_numOfKilled), boundingBox, 40.f, Rgba8::WHITE, 1 / multiplier,
-                                       Vec2(0.05f, 0.5f));
-    g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", PlayerSaveSubsystem::GetPlayerSaveData(player->m_index)->m_numOfDeaths), boundingBox, 40.f, Rgba8::WHITE, 1 / multiplier,
-                                       Vec2(0.95f, 0.5f));
-    g_theRenderer->BindTexture(&g_testFont->GetTexture());
-    g_theRenderer->DrawVertexArray(vertexes);
+    const PlayerSaveData* saveData = g_thePlayerSaveSubsystem->GetPlayerSaveData(player->m_index);
+    int                   health   = static_cast<int>(m_owner->m_health);
+    int                   kills    = saveData ? saveData->m_numOfKilled : -1;
+    int                   deaths   = saveData ? saveData->m_numOfDeaths : -1;
+    if (hudCache.NeedsText(health, kills, deaths))
+    {
+        hudCache.SetText(health, kills, deaths);
+        std::vector<Vertex_PCU>& vertexes    = hudCache.m_scratchVertexes;
+        BitmapFont*              g_testFont  = hudCache.m_font;
+        AABB2                    boundingBox = m_hudBaseBound;
+        float                    aspect      = 1 / hudCache.m_viewportScale;
+        vertexes.clear();
+        g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", health), boundingBox, 40.f, Rgba8::WHITE, aspect, Vec2(0.29f, 0.5f));
+        if (saveData)
+        {
+            g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", kills), boundingBox, 40.f, Rgba8::WHITE, aspect, Vec2(0.05f, 0.5f));
+            g_testFont->AddVertsForTextInBox2D(vertexes, Stringf("%d", deaths), boundingBox, 40.f, Rgba8::WHITE, aspect, Vec2(0.95f, 0.5f));
+        }
+        hudCache.Upload(HudLayer::TEXT, vertexes);
+    }
+    hudCache.Draw(HudLayer::TEXT, &hudCache.m_font->GetTexture());
     g_theRenderer->BindTexture(nullptr);
 }
 
-void Weapon::RenderWeaponAnim() const
+void Weapon::RenderWeaponAnim(PlayerHudCache& hudCache) const
 {
     auto player = dynamic_cast<PlayerController*>(m_owner->m_controller);
     if (!player->GetActor() || player->GetActor()->m_bIsDead)
         return; // Handle player death not render anim
-    std::vector<Vertex_PCU> vertexes;
-    vertexes.reserve(1024);
     Animation* animation = m_currentPlayingAnimation;
     if (animation == nullptr && static_cast<int>(m_definition->m_hud->GetAnimations().size()) > 0) // We use the index 0 animation group
     {
         animation = &m_definition->m_hud->GetAnimations()[0];
     }
     const SpriteAnimDefinition* anim         = animation->GetAnimationDefinition();
-    const SpriteDefinition      spriteAtTime = anim->GetSpriteDefAtTime(m_animationTimer->GetElapsedTime());
+    const SpriteDefinition      spriteAtTime = anim->GetSpriteDefAtTime(GetAnimationElapsedSeconds());
     AABB2                       uvAtTime     = spriteAtTime.GetUVs();
 
-    Vec2 spriteOffSet = -Vec2(m_definition->m_hud->m_spriteSize) * m_definition->m_hud->m_spritePivot;
-
-    IntVec2 boundSize = m_definition->m_hud->m_spriteSize;
-    auto    bound     = AABB2(Vec2(g_theGame->m_screenSpace.m_maxs.x / 2.0f, 0.f), Vec2(g_theGame->m_screenSpace.m_maxs.x / 2.0f, 0.f) + Vec2(boundSize));
-
-    /// Change the dimension base on split screen y
-    Vec2  dim            = bound.GetDimensions();
-    AABB2 screenViewport = m_owner->m_controller->m_screenViewport;
-    float multiplier     = g_theGame->m_screenSpace.GetDimensions().y / screenViewport.GetDimensions().y;
-    dim.x /= multiplier;
-    bound.SetDimensions(dim);
-    /// End of Change
-
-    bound.m_mins += spriteOffSet;
-    bound.m_maxs += spriteOffSet;
-    bound.Translate(Vec2(0, m_hudBaseBound.m_maxs.y)); // Shitty hardcode
-    AddVertsForAABB2D(vertexes, bound, Rgba8::WHITE, uvAtTime.m_mins, uvAtTime.m_maxs);
+    std::vector<Vertex_PCU>& vertexes = hudCache.m_scratchVertexes;
+    vertexes.clear();
+    AddVertsForAABB2D(vertexes, hudCache.m_animationBound, Rgba8::WHITE, uvAtTime.m_mins, uvAtTime.m_maxs);
     AddVertsForAABB2D(vertexes, uvAtTime, Rgba8::WHITE);
     g_theRenderer->BindTexture(&spriteAtTime.GetTexture());
     g_theRenderer->DrawVertexArray(vertexes);
 }
+
+unsigned char Weapon::GetSlotIndex() const
+{
+    auto slot = std::find(m_owner->m_weapons.begin(), m_owner->m_weapons.end(), this);
+    return static_cast<unsigned char>(slot - m_owner->m_weapons.begin());
+}
+
+float Weapon::GetAnimationElapsedSeconds() const
+{
+    return g_theGame->m_simulationTotalSeconds - m_animationStartTime;
+}
+
+void Weapon::UpdateHudBaseBound()
+{
+    if (m_definition->m_hud == nullptr)
+        return;
+    Texture* baseTexture   = m_definition->m_hud->m_baseTexture;
+    IntVec2  baseDimension = baseTexture->GetDimensions();
+    float    multiplier    = g_theGame->m_screenSpace.m_maxs.x / static_cast<float>(baseDimension.x);
+    m_hudBaseBound         = AABB2(Vec2(0.0f, 0.0f), Vec2(g_theGame->m_screenSpace.m_maxs.x, static_cast<float>(baseDimension.y) * multiplier));
+}
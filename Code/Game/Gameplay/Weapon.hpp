@@ -1,10 +1,13 @@
 ﻿#pragma once
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/Vec3.hpp"
+#include "Game/Framework/AnimationState.hpp"
+#include "Game/Framework/RandomStream.hpp"
+#include "Game/Gameplay/TimerWheel.hpp"
 
-class Timer;
 class Animation;
 class Actor;
+class PlayerHudCache;
 class WeaponDefinition;
 
 class Weapon
@@ -21,7 +24,8 @@ public:
     /// Checks if the weapon is ready to fire. If so, fires each of the ray casts, projectiles,
         /// and melee attacks defined in the definition. Needs to pass along its owning actor to be
         /// ignored in all raycast and collision checks.
-    void Fire();
+        /// @return False while the weapon is still on cooldown.
+    bool Fire();
     /// This, and other utility methods, will be helpful for randomizing weapons with a cone.
     /// @param weaponOrientation 
     /// @param degreeOfVariation 
@@ -33,24 +37,34 @@ public:
     /// @return 
     EulerAngles GetRandomDirectionInCone(EulerAngles weaponOrientation, float degreeOfVariation);
 
-    void Update(float deltaSeconds);
-    void UpdateAnimation(float deltaSeconds);
+    void OnAnimationEnd(); // Called by the map timer of the playing animation.
+    bool IsReadyToFire() const; // The refire timer of the last shot expired.
 
-    Animation* PlayAnimationByName(std::string animationName, bool force = false);
+    Animation* PlayAnimation(AnimationState state, bool force = false); // Through the state machine of the hud.
+    /// Re-point the weapon after a definition hot reload, the playing animation is looked up again by name.
+    void RebindDefinition(WeaponDefinition* definition, const std::string& animationName);
 
-    void Render() const;
-    void RenderWeaponBase() const;
-    void RenderWeaponReticle() const;
-    void RenderWeaponHudText() const;
-    void RenderWeaponAnim() const;
+    void Render(PlayerHudCache& hudCache) const; // Hud of the owning player, through the geometry cached for its viewport.
+    void RenderWeaponHudText(PlayerHudCache& hudCache) const;
+    void RenderWeaponAnim(PlayerHudCache& hudCache) const;
+
+private:
+    void          BuildHudLayout(PlayerHudCache& hudCache) const; // Base, reticle and animation bound for the viewport.
+    unsigned char GetSlotIndex() const; // Index of this weapon in the owner inventory, the timers carry it.
+    float         GetAnimationElapsedSeconds() const;
+    void          UpdateHudBaseBound(); // Size the hud base to the screen width while keeping the base texture aspect.
 
 protected:
     Actor*            m_owner        = nullptr;
     WeaponDefinition* m_definition   = nullptr;
-    float             m_lastFireTime = 0.f;
 
     AABB2 m_hudBaseBound; // we calculate the bound that Seamlessly connect the weapon texture
 
-    Animation* m_currentPlayingAnimation = nullptr;
-    Timer*     m_animationTimer          = nullptr;
+    Animation*     m_currentPlayingAnimation = nullptr;
+    AnimationState m_animationState          = AnimationState::IDLE;
+    float          m_animationStartTime      = 0.f; // Simulation time the playing animation started.
+    TimerHandle    m_animationEndTimer;
+    TimerHandle    m_refireTimer;
+
+    RandomStream m_randomStream; // Spread and damage rolls, seeded from the owner stream and the inventory slot.
 };
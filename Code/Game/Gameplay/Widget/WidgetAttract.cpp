@@ -15,7 +15,6 @@ WidgetAttract::WidgetAttract()
 {
     m_name = "WidgetAttract";
     g_theEventSystem->SubscribeEventCallbackFunction("GameStateChangeEvent", OnStateChange);
-    m_lowerInfoStringVertex.reserve(1024);
     SoundID         mainMenuSoundID    = g_theAudio->CreateOrGetSound(g_gameConfigBlackboard.GetValue("mainMenuMusic", ""));
     SoundPlaybackID mainMenuPlaybackID = g_theAudio->StartSound(mainMenuSoundID, true, 0.5f);
     g_theResourceSubsystem->CachedSoundPlaybackID(mainMenuPlaybackID, mainMenuSoundID);
@@ -33,22 +32,14 @@ void WidgetAttract::Draw() const
     g_theRenderer->BindTexture(nullptr);
     DebugDrawRing(Vec2(800, 400), m_currentIconCircleThickness, m_currentIconCircleThickness / 10, Rgba8::WHITE);
 
-    /// Add Lower Info String
-    BitmapFont* g_testFont = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
-    g_theRenderer->BindTexture(&g_testFont->GetTexture());
-    g_theRenderer->DrawVertexArray(m_lowerInfoStringVertex);
+    /// Lower Info String, built once since the text never changes
+    DrawGeometry();
 }
 
 void WidgetAttract::Update()
 {
     Widget::Update();
 
-    /// Graphic Lower Info String Drawing
-    BitmapFont* g_testFont  = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
-    AABB2       boundingBox = g_theGame->m_screenSpace;
-    m_lowerInfoStringVertex.clear();
-    g_testFont->AddVertsForTextInBox2D(m_lowerInfoStringVertex, m_lowerInfoString, boundingBox, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.f));
-
     m_counter++;
     m_currentIconCircleThickness = FluctuateValue(m_iconCircleRadius, 50.f, 0.02f, static_cast<float>(m_counter));
 
@@ -100,6 +91,14 @@ void WidgetAttract::UpdateKeyInput()
     }
 }
 
+const Texture* WidgetAttract::BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const
+{
+    BitmapFont* g_testFont  = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
+    AABB2       boundingBox = g_theGame->m_screenSpace;
+    g_testFont->AddVertsForTextInBox2D(outVertexes, m_lowerInfoString, boundingBox, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.f));
+    return &g_testFont->GetTexture();
+}
+
 float WidgetAttract::FluctuateValue(float value, float amplitude, float frequency, float deltaTime)
 {
     return value + amplitude * sinf(frequency * deltaTime);
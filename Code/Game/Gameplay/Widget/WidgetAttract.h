@@ -14,6 +14,8 @@ public:
     STATIC bool OnStateChange(EventArgs& args);
 
 protected:
+    const Texture* BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const override;
+
     void UpdateKeyInput();
 
 private:
@@ -23,8 +25,6 @@ private:
     float m_currentIconCircleThickness = 0.f;
     int   m_counter                    = 0;
 
-    std::vector<Vertex_PCU> m_lowerInfoStringVertex;
-
     std::string m_lowerInfoString = "Press SPACE to join with mouse and keyboard\n"
         "Press START to koin with controller\n"
         "Press ESCAPE or BACK to exit\n";
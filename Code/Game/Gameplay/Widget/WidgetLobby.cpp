@@ -25,73 +25,85 @@ void WidgetLobby::Draw() const
 {
     Widget::Draw();
     g_theRenderer->ClearScreen(g_theApp->m_backgroundColor);
-    g_theRenderer->BindTexture(nullptr);
+    DrawGeometry();
+}
+
+const Texture* WidgetLobby::BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const
+{
+    BitmapFont* g_testFont = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
     if (g_theGame->m_localPlayerControllers.size() == 1)
     {
-        PlayerController*       controller = g_theGame->m_localPlayerControllers[0];
-        std::vector<Vertex_PCU> textVerts;
-        textVerts.reserve(4096);
+        PlayerController* controller = g_theGame->m_localPlayerControllers[0];
         /// Render One Player
-        AABB2       bound      = g_theGame->m_screenSpace;
-        BitmapFont* g_testFont = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
-        textVerts.clear();
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Player %d", controller->GetControllerIndex()), bound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("%s", to_string(controller->GetInputDeviceType())), bound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        AABB2 bound = g_theGame->m_screenSpace;
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Player %d", controller->GetControllerIndex()), bound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("%s", to_string(controller->GetInputDeviceType())), bound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
 
         std::vector<std::string> mappingTexts = GetPlayerActionNamesByDeviceType(controller->GetInputDeviceType());
         bound.m_maxs.y -= 400.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to start game", mappingTexts[0].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to start game", mappingTexts[0].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         bound.m_maxs.y -= 60.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to leave game", mappingTexts[1].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to leave game", mappingTexts[1].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         bound.m_maxs.y -= 60.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to join game", mappingTexts[2].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
-
-        g_theRenderer->BindTexture(&g_testFont->GetTexture());
-        g_theRenderer->DrawVertexArray(textVerts);
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to join game", mappingTexts[2].c_str()), bound, 20.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
     }
     else if (g_theGame->m_localPlayerControllers.size() == 2)
     {
         /// Render Two Player
-        AABB2                   bound = g_theGame->m_screenSpace;
-        std::vector<Vertex_PCU> textVerts;
-        textVerts.reserve(4096);
+        AABB2             bound                   = g_theGame->m_screenSpace;
         auto              bottomBound             = AABB2(Vec2(0.f, 0.f), Vec2(bound.m_maxs.x, bound.m_maxs.y / 2.f));
         auto              topBound                = AABB2(Vec2(0.f, bound.m_maxs.y / 2.f), Vec2(bound.m_maxs.x, bound.m_maxs.y));
-        BitmapFont*       g_testFont              = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
         PlayerController* topDisplayController    = g_theGame->GetLocalPlayer(1);
         PlayerController* bottomDisplayController = g_theGame->GetLocalPlayer(2);
         std::string       startGameMappingText, leaveGameMappingText, joinPlayerMappingText;
 
         /// Handle top
         std::vector<std::string> mappingTextsTop = GetPlayerActionNamesByDeviceType(topDisplayController->GetInputDeviceType());
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Player %d", topDisplayController->GetControllerIndex()), topBound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Player %d", topDisplayController->GetControllerIndex()), topBound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
         topBound.m_maxs.y -= 50.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("%s", to_string(topDisplayController->GetInputDeviceType())), topBound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("%s", to_string(topDisplayController->GetInputDeviceType())), topBound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         topBound.m_maxs.y -= 200.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to start game", mappingTextsTop[0].c_str()), topBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to start game", mappingTextsTop[0].c_str()), topBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         topBound.m_maxs.y -= 60.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to leave game", mappingTextsTop[1].c_str()), topBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to leave game", mappingTextsTop[1].c_str()), topBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
 
         /// Handle bottom
         std::vector<std::string> mappingTextsBottom = GetPlayerActionNamesByDeviceType(bottomDisplayController->GetInputDeviceType());
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Player %d", bottomDisplayController->GetControllerIndex()), bottomBound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Player %d", bottomDisplayController->GetControllerIndex()), bottomBound, 55.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.6f));
         bottomBound.m_maxs.y -= 50.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("%s", to_string(bottomDisplayController->GetInputDeviceType())), bottomBound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("%s", to_string(bottomDisplayController->GetInputDeviceType())), bottomBound, 25.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         bottomBound.m_maxs.y -= 200.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to start game", mappingTextsBottom[0].c_str()), bottomBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to start game", mappingTextsBottom[0].c_str()), bottomBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
         bottomBound.m_maxs.y -= 60.f;
-        g_testFont->AddVertsForTextInBox2D(textVerts, Stringf("Press %s to leave game", mappingTextsBottom[1].c_str()), bottomBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
-
-        /// Common
-        g_theRenderer->BindTexture(&g_testFont->GetTexture());
-        g_theRenderer->DrawVertexArray(textVerts);
+        g_testFont->AddVertsForTextInBox2D(outVertexes, Stringf("Press %s to leave game", mappingTextsBottom[1].c_str()), bottomBound, 15.f, Rgba8::WHITE, 1, Vec2(0.5f, 0.5f));
     }
+    return &g_testFont->GetTexture();
 }
 
 void WidgetLobby::Update()
 {
     Widget::Update();
     UpdateKeyInput();
+    UpdateDisplayedPlayers();
+}
+
+void WidgetLobby::UpdateDisplayedPlayers()
+{
+    /// The text only changes when a player joins, leaves or the players swap devices, compared in place every frame
+    const std::vector<PlayerController*>& controllers = g_theGame->m_localPlayerControllers;
+    bool                                  bChanged    = controllers.size() != m_displayedPlayers.size();
+    for (size_t i = 0; i < controllers.size() && !bChanged; ++i)
+    {
+        bChanged = m_displayedPlayers[i].first != controllers[i]->GetControllerIndex() || m_displayedPlayers[i].second != controllers[i]->GetInputDeviceType();
+    }
+    if (!bChanged)
+        return;
+    m_displayedPlayers.clear();
+    for (PlayerController* controller : controllers)
+    {
+        m_displayedPlayers.emplace_back(controller->GetControllerIndex(), controller->GetInputDeviceType());
+    }
+    MarkDirty();
 }
 
 
@@ -220,7 +232,7 @@ void WidgetLobby::HandleGameStartProcess()
     {
         PlayerSaveData save = {};
         save.m_playerID     = controller->m_index;
-        PlayerSaveSubsystem::CreatePlayerSaveData(save);
+        g_thePlayerSaveSubsystem->CreatePlayerSaveData(save);
     }
     g_theGame->EnterState(GameState::PLAYING);
 }
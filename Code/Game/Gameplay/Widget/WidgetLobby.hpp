@@ -13,11 +13,16 @@ public:
     /// Setter
 
 protected:
+    const Texture* BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const override;
+
     void UpdateKeyInput();
+    void UpdateDisplayedPlayers(); // Dirty the geometry when the players it shows changed.
     void RemoveAllLocalPlayerControllers();
     void HandleLocalPlayerViewportData();
     void HandleGameStartProcess();
 
 private:
     std::vector<std::string> GetPlayerActionNamesByDeviceType(DeviceType deviceType) const;
+
+    std::vector<std::pair<int, DeviceType>> m_displayedPlayers; // Controller index and device of every player shown.
 };
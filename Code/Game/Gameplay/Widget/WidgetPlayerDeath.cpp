@@ -16,10 +16,13 @@ void WidgetPlayerDeath::Draw() const
     g_theRenderer->SetBlendMode(BlendMode::ALPHA);
     g_theRenderer->BindTexture(nullptr);
     g_theRenderer->BindShader(nullptr);
-    std::vector<Vertex_PCU> vertices;
-    vertices.reserve(256);
-    AddVertsForAABB2D(vertices, g_theGame->m_screenSpace, Rgba8(0, 0, 0, 140));
-    g_theRenderer->DrawVertexArray(vertices);
+    DrawGeometry();
+}
+
+const Texture* WidgetPlayerDeath::BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const
+{
+    AddVertsForAABB2D(outVertexes, g_theGame->m_screenSpace, Rgba8(0, 0, 0, 140));
+    return nullptr;
 }
 
 void WidgetPlayerDeath::Update()
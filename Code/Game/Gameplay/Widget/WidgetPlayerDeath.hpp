@@ -9,4 +9,7 @@ public:
 
     void Draw() const override;
     void Update() override;
+
+protected:
+    const Texture* BuildGeometry(std::vector<Vertex_PCU>& outVertexes) const override;
 };